@@ -0,0 +1,16 @@
+@echo off
+
+REM f_base microbenchmarks, no GLFW/OpenGL. Run from the repo root: build\bench.exe [-csv] [-reps N] [-file path] [filter]
+set compiler_and_entry=cl ..\source\bench\bench_f_base.c
+
+set cl_default_flags=/nologo /FC /Zi /O2 /MD
+
+set external_include= /I"..\source\f_base" 
+
+set linker_flags= user32.lib ^
+									winmm.lib
+
+if not exist build mkdir build
+pushd build
+%compiler_and_entry% %cl_default_flags% %external_include% %linker_flags% /Fe"bench.exe"
+popd
@@ -0,0 +1,462 @@
+// NOTE(fz): Microbenchmarks for f_base. Built by bench.bat into build/bench.exe.
+//   bench.exe [-csv] [-reps N] [-file path] [filter]
+// Every benchmark runs a warmup, then N timed repetitions of `ops` operations each,
+// and reports ns/op and cycles/op for the fastest and the median repetition.
+// -csv switches the output to one comma separated line per benchmark, for scripts and diffs.
+
+#define ENABLE_ASSERT 1
+#include "f_includes.h"
+
+//~ Harness
+
+#define BENCH_WARMUP_SECONDS 0.05
+#define BENCH_DEFAULT_REPS   25
+#define BENCH_MAX_REPS       256
+
+typedef void bench_func(void* context, u64 ops);
+
+typedef struct Bench_State {
+  b32 csv;
+  u32 repetitions;
+  String filter;
+  String file_path;
+} Bench_State;
+
+global Bench_State GBench;
+
+// NOTE(fz): Benchmarks fold their results in here so the optimizer can't throw the work away.
+global volatile u64 BenchSink;
+
+internal b32 _bench_matches_filter(String name) {
+  b32 result = (GBench.filter.size == 0);
+  for (u64 i = 0; !result && i + GBench.filter.size <= name.size; i += 1) {
+    result = strings_match(string_new(GBench.filter.size, name.str + i), GBench.filter);
+  }
+  return result;
+}
+
+internal int _bench_compare_f64(const void* a, const void* b) {
+  f64 x = *(f64*)a;
+  f64 y = *(f64*)b;
+  return (x > y) - (x < y);
+}
+
+internal void bench_run(String name, bench_func* func, void* context, u64 ops) {
+  if (!_bench_matches_filter(name)) return;
+  
+  f64 ticks_per_ns = (f64)os_get_ticks_per_second()/1e9;
+  u64 warmup_end   = os_get_ticks() + (u64)(BENCH_WARMUP_SECONDS*os_get_ticks_per_second());
+  while (os_get_ticks() < warmup_end) {
+    func(context, ops);
+  }
+  
+  f64 ns[BENCH_MAX_REPS];
+  f64 cycles[BENCH_MAX_REPS];
+  for (u32 rep = 0; rep < GBench.repetitions; rep += 1) {
+    u64 start_cycles = os_get_cpu_cycles();
+    u64 start_ticks  = os_get_ticks();
+    func(context, ops);
+    u64 end_ticks    = os_get_ticks();
+    u64 end_cycles   = os_get_cpu_cycles();
+    ns[rep]     = (f64)(end_ticks - start_ticks)/ticks_per_ns/(f64)ops;
+    cycles[rep] = (f64)(end_cycles - start_cycles)/(f64)ops;
+  }
+  qsort(ns,     GBench.repetitions, sizeof(f64), _bench_compare_f64);
+  qsort(cycles, GBench.repetitions, sizeof(f64), _bench_compare_f64);
+  u32 median = GBench.repetitions/2;
+  
+  if (GBench.csv) {
+    printf("%.*s,%llu,%u,%.4f,%.4f,%.2f,%.2f\n", (s32)name.size, name.str, (unsigned long long)ops, GBench.repetitions,
+           ns[0], ns[median], cycles[0], cycles[median]);
+  } else {
+    printf("%-40.*s %12.3f ns/op %10.2f cyc/op   median %12.3f ns/op %10.2f cyc/op\n", (s32)name.size, name.str,
+           ns[0], cycles[0], ns[median], cycles[median]);
+  }
+}
+
+//~ Memory
+
+internal void bench_arena_push_64(void* context, u64 ops) {
+  Arena* arena = (Arena*)context;
+  Arena_Temp temp = arena_temp_begin(arena);
+  for (u64 i = 0; i < ops; i += 1) {
+    u8* data = (u8*)arena_push(arena, 64);
+    BenchSink += (u64)data[0];
+  }
+  arena_temp_end(&temp);
+}
+
+internal void bench_arena_push_no_zero_64(void* context, u64 ops) {
+  Arena* arena = (Arena*)context;
+  Arena_Temp temp = arena_temp_begin(arena);
+  for (u64 i = 0; i < ops; i += 1) {
+    u8* data = (u8*)arena_push_no_zero(arena, 64);
+    BenchSink += (u64)data;
+  }
+  arena_temp_end(&temp);
+}
+
+internal void bench_malloc_64(void* context, u64 ops) {
+  void** pointers = (void**)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    pointers[i] = calloc(1, 64);
+  }
+  for (u64 i = 0; i < ops; i += 1) {
+    BenchSink += (u64)((u8*)pointers[i])[0];
+    free(pointers[i]);
+  }
+}
+
+internal void bench_arena_push_4k(void* context, u64 ops) {
+  Arena* arena = (Arena*)context;
+  Arena_Temp temp = arena_temp_begin(arena);
+  for (u64 i = 0; i < ops; i += 1) {
+    u8* data = (u8*)arena_push(arena, Kilobytes(4));
+    BenchSink += (u64)data[0];
+  }
+  arena_temp_end(&temp);
+}
+
+internal void bench_malloc_4k(void* context, u64 ops) {
+  void** pointers = (void**)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    pointers[i] = calloc(1, Kilobytes(4));
+  }
+  for (u64 i = 0; i < ops; i += 1) {
+    BenchSink += (u64)((u8*)pointers[i])[0];
+    free(pointers[i]);
+  }
+}
+
+//~ Strings
+
+typedef struct Bench_Strings {
+  Arena* arena;
+  String a;
+  String b;
+  String numbers[8];
+  String line;
+} Bench_Strings;
+
+internal void bench_strings_match(void* context, u64 ops) {
+  Bench_Strings* strings = (Bench_Strings*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    BenchSink += strings_match(strings->a, strings->b);
+  }
+}
+
+internal void bench_cast_string_to_f32(void* context, u64 ops) {
+  Bench_Strings* strings = (Bench_Strings*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    f32 value;
+    cast_string_to_f32(strings->numbers[i & 7], &value);
+    BenchSink += (u64)value;
+  }
+}
+
+internal void bench_cast_string_to_s32(void* context, u64 ops) {
+  for (u64 i = 0; i < ops; i += 1) {
+    s32 value;
+    cast_string_to_s32(StringLiteral("1234567"), &value);
+    BenchSink += (u64)value;
+  }
+}
+
+internal void bench_string_split(void* context, u64 ops) {
+  Bench_Strings* strings = (Bench_Strings*)context;
+  Arena_Temp temp = arena_temp_begin(strings->arena);
+  for (u64 i = 0; i < ops; i += 1) {
+    String_List list = string_split(strings->arena, strings->line, StringLiteral(" "));
+    BenchSink += list.node_count;
+  }
+  arena_temp_end(&temp);
+}
+
+//~ Math
+
+#define BENCH_POINTS 65536
+
+typedef struct Bench_Math {
+  Matrix4 a;
+  Matrix4 b;
+  Matrix4 view;
+  Matrix4 projection;
+  Matrix4 inverse_view_projection;
+  Vector3* points;
+  Vector3* points_out;
+  f32* angles;
+  Vector3* triangles;
+  u64 triangle_count;
+  Vector3_SoA centers;
+  Vector3_SoA extents;
+  u32* visible;
+  Frustum frustum;
+} Bench_Math;
+
+internal void bench_matrix4_mul(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  Matrix4 result = math->a;
+  for (u64 i = 0; i < ops; i += 1) {
+    result = matrix4_mul(result, math->b);
+  }
+  BenchSink += (u64)result.m0;
+}
+
+internal void bench_matrix4_inverse(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    math->a.m12 += 0.001f;
+    sum += matrix4_inverse(math->a).m12;
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_matrix4_inverse_affine(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    math->a.m12 += 0.001f;
+    sum += matrix4_inverse_affine(math->a).m12;
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_vector3_unproject(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    sum += vector3_unproject(math->points[i & (BENCH_POINTS - 1)], math->projection, math->view).x;
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_vector3_unproject_inverse(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    sum += vector3_unproject_inverse(math->points[i & (BENCH_POINTS - 1)], math->inverse_view_projection).x;
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_mul_vector3_matrix4(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    math->points_out[i] = mul_vector3_matrix4(math->points[i], math->a);
+  }
+}
+
+internal void bench_transform_vector3_array(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  transform_vector3_array(math->a, math->points, math->points_out, ops, TransformMode_Point);
+}
+
+internal void bench_transform_vector3_array_parallel(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  transform_vector3_array_parallel(math->a, math->points, math->points_out, ops, TransformMode_Point);
+}
+
+internal void bench_vector3_normalize(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    math->points_out[i] = vector3_normalize(math->points[i]);
+  }
+}
+
+internal void bench_vector3_normalize_fast(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    math->points_out[i] = vector3_normalize_fast(math->points[i]);
+  }
+}
+
+internal void bench_sincos_libm(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    sum += sinf(math->angles[i]) + cosf(math->angles[i]);
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_f32_fast_sincos(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32 sum = 0.0f;
+  for (u64 i = 0; i < ops; i += 1) {
+    f32 s, c;
+    f32_fast_sincos(math->angles[i], &s, &c);
+    sum += s + c;
+  }
+  BenchSink += (u64)sum;
+}
+
+internal void bench_f32x4_fast_sincos(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  f32x4 sum = f32x4_zero();
+  for (u64 i = 0; i + 4 <= ops; i += 4) {
+    f32x4 s, c;
+    f32x4_fast_sincos(f32x4_load(math->angles + i), &s, &c);
+    sum = f32x4_add(sum, f32x4_add(s, c));
+  }
+  BenchSink += (u64)f32x4_hsum(sum);
+}
+
+internal void bench_frustum_cull_aabbs(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  BenchSink += frustum_cull_aabbs(&math->frustum, math->centers, math->extents, ops, math->visible);
+}
+
+internal void bench_intersect_ray_with_triangle_list(void* context, u64 ops) {
+  Bench_Math* math = (Bench_Math*)context;
+  Ray ray = ray(vector3(0.0f, 0.0f, 5.0f), vector3(0.0f, 0.0f, -1.0f));
+  Ray_Hit hit = intersect_ray_with_triangle_list(ray, math->triangles, NULL, ops);
+  BenchSink += hit.index;
+}
+
+//~ Files
+
+internal void bench_file_load(void* context, u64 ops) {
+  Arena* arena = (Arena*)context;
+  for (u64 i = 0; i < ops; i += 1) {
+    Arena_Temp temp = arena_temp_begin(arena);
+    OS_File file = os_file_load_entire_file(arena, GBench.file_path);
+    BenchSink += file.size;
+    arena_temp_end(&temp);
+  }
+}
+
+//~ Main
+
+internal f32 _bench_random(u32* state) {
+  *state = *state*1664525u + 1013904223u;
+  f32 result = (f32)(*state >> 8)/(f32)(1 << 24);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  os_init();
+  Thread_Context main_thread_context;
+  thread_context_init_and_attach(&main_thread_context);
+  
+  GBench.repetitions = BENCH_DEFAULT_REPS;
+  GBench.file_path   = StringLiteral("resources\\crate.obj");
+  for (s32 i = 1; i < argc; i += 1) {
+    String arg = string_new(strlen(argv[i]), (u8*)argv[i]);
+    if (strings_match(arg, StringLiteral("-csv"))) {
+      GBench.csv = 1;
+    } else if (strings_match(arg, StringLiteral("-reps")) && i + 1 < argc) {
+      s32 reps = 0;
+      i += 1;
+      cast_string_to_s32(string_new(strlen(argv[i]), (u8*)argv[i]), &reps);
+      GBench.repetitions = Max(1, Min(reps, BENCH_MAX_REPS));
+    } else if (strings_match(arg, StringLiteral("-file")) && i + 1 < argc) {
+      i += 1;
+      GBench.file_path = string_new(strlen(argv[i]), (u8*)argv[i]);
+    } else {
+      GBench.filter = arg;
+    }
+  }
+  
+  if (GBench.csv) {
+    printf("name,ops,repetitions,min_ns_per_op,median_ns_per_op,min_cycles_per_op,median_cycles_per_op\n");
+  }
+  
+  Arena* arena = arena_init();
+  
+  //- Memory
+  {
+    u64 count = 4096;
+    void** pointers = ArenaPush(arena, void*, count);
+    Arena* bench_arena = arena_init();
+    bench_run(StringLiteral("memory/arena_push_64"),         bench_arena_push_64,         bench_arena, count);
+    bench_run(StringLiteral("memory/arena_push_no_zero_64"), bench_arena_push_no_zero_64, bench_arena, count);
+    bench_run(StringLiteral("memory/calloc_free_64"),        bench_malloc_64,             pointers,    count);
+    bench_run(StringLiteral("memory/arena_push_4k"),         bench_arena_push_4k,         bench_arena, 1024);
+    bench_run(StringLiteral("memory/calloc_free_4k"),        bench_malloc_4k,             pointers,    1024);
+    arena_free(bench_arena);
+  }
+  
+  //- Strings
+  {
+    Bench_Strings strings = { 0 };
+    strings.arena = arena_init();
+    strings.a = StringLiteral("some/fairly/long/resource/path.obj");
+    strings.b = StringLiteral("some/fairly/long/resource/path.obj");
+    char* numbers[8] = { "0.5", "12.25", "3.14159", "100", "0.000123", "98765.4", "1.0", "42.4242" };
+    for (u32 i = 0; i < 8; i += 1) {
+      strings.numbers[i] = string_new(strlen(numbers[i]), (u8*)numbers[i]);
+    }
+    strings.line = StringLiteral("v 0.123456 -1.500000 2.750000 f 1/1/1 2/2/2 3/3/3");
+    bench_run(StringLiteral("string/strings_match"),      bench_strings_match,      &strings, 4096);
+    bench_run(StringLiteral("string/cast_string_to_f32"), bench_cast_string_to_f32, &strings, 4096);
+    bench_run(StringLiteral("string/cast_string_to_s32"), bench_cast_string_to_s32, &strings, 4096);
+    bench_run(StringLiteral("string/string_split"),       bench_string_split,       &strings, 1024);
+    arena_free(strings.arena);
+  }
+  
+  //- Math
+  {
+    u32 seed = 1;
+    Bench_Math math = { 0 };
+    math.a = matrix4_mul(matrix4_rotate_xyz(vector3(0.3f, 0.2f, 0.1f)), matrix4_translate(1.0f, 2.0f, 3.0f));
+    math.b = matrix4_rotate_xyz(vector3(0.001f, 0.002f, 0.003f));
+    math.view       = matrix4_look_at(vector3(1.0f, 2.0f, 5.0f), vector3(0.0f, 0.0f, 0.0f), vector3(0.0f, 1.0f, 0.0f));
+    math.projection = matrix4_perspective(Radians(45.0f), 1280.0f, 720.0f, 0.1f, 100.0f);
+    math.inverse_view_projection = matrix4_inverse(matrix4_mul(math.view, math.projection));
+    math.frustum = frustum_from_matrix4(matrix4_mul(math.view, math.projection));
+    
+    math.points     = ArenaPush(arena, Vector3, BENCH_POINTS);
+    math.points_out = ArenaPush(arena, Vector3, BENCH_POINTS);
+    math.angles     = ArenaPush(arena, f32,     BENCH_POINTS);
+    for (u32 i = 0; i < BENCH_POINTS; i += 1) {
+      math.points[i] = vector3(_bench_random(&seed)*2.0f - 1.0f, _bench_random(&seed)*2.0f - 1.0f, _bench_random(&seed));
+      math.angles[i] = _bench_random(&seed)*20.0f - 10.0f;
+    }
+    
+    math.triangle_count = 16384;
+    math.triangles = ArenaPush(arena, Vector3, math.triangle_count*3);
+    for (u64 i = 0; i < math.triangle_count*3; i += 1) {
+      math.triangles[i] = vector3(_bench_random(&seed)*4.0f - 2.0f, _bench_random(&seed)*4.0f - 2.0f, _bench_random(&seed)*4.0f - 2.0f);
+    }
+    
+    f32* bounds = ArenaPush(arena, f32, BENCH_POINTS*6);
+    math.centers = (Vector3_SoA){ bounds, bounds + BENCH_POINTS, bounds + BENCH_POINTS*2 };
+    math.extents = (Vector3_SoA){ bounds + BENCH_POINTS*3, bounds + BENCH_POINTS*4, bounds + BENCH_POINTS*5 };
+    math.visible = ArenaPush(arena, u32, BENCH_POINTS);
+    for (u32 i = 0; i < BENCH_POINTS; i += 1) {
+      math.centers.x[i] = _bench_random(&seed)*100.0f - 50.0f;
+      math.centers.y[i] = _bench_random(&seed)*100.0f - 50.0f;
+      math.centers.z[i] = _bench_random(&seed)*100.0f - 50.0f;
+      math.extents.x[i] = math.extents.y[i] = math.extents.z[i] = _bench_random(&seed);
+    }
+    
+    bench_run(StringLiteral("math/matrix4_mul"),                 bench_matrix4_mul,                 &math, 4096);
+    bench_run(StringLiteral("math/matrix4_inverse"),             bench_matrix4_inverse,             &math, 4096);
+    bench_run(StringLiteral("math/matrix4_inverse_affine"),      bench_matrix4_inverse_affine,      &math, 4096);
+    bench_run(StringLiteral("math/vector3_unproject"),           bench_vector3_unproject,           &math, 4096);
+    bench_run(StringLiteral("math/vector3_unproject_inverse"),   bench_vector3_unproject_inverse,   &math, 4096);
+    bench_run(StringLiteral("math/mul_vector3_matrix4"),         bench_mul_vector3_matrix4,         &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/transform_vector3_array"),     bench_transform_vector3_array,     &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/transform_vector3_array_par"), bench_transform_vector3_array_parallel, &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/vector3_normalize"),           bench_vector3_normalize,           &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/vector3_normalize_fast"),      bench_vector3_normalize_fast,      &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/sincos_libm"),                 bench_sincos_libm,                 &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/f32_fast_sincos"),             bench_f32_fast_sincos,             &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/f32x4_fast_sincos"),           bench_f32x4_fast_sincos,           &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/frustum_cull_aabbs"),          bench_frustum_cull_aabbs,          &math, BENCH_POINTS);
+    bench_run(StringLiteral("math/intersect_ray_triangle_list"), bench_intersect_ray_with_triangle_list, &math, math.triangle_count);
+  }
+  
+  //- Files
+  if (os_file_exists(GBench.file_path)) {
+    Arena* file_arena = arena_init();
+    bench_run(StringLiteral("file/load_entire_file"), bench_file_load, file_arena, 16);
+    arena_free(file_arena);
+  } else if (!GBench.csv) {
+    printf("Skipping file benchmarks, %.*s not found (pass -file <path>)\n", (s32)GBench.file_path.size, GBench.file_path.str);
+  }
+  
+  arena_free(arena);
+  return 0;
+}
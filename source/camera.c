@@ -1,7 +1,7 @@
 internal Camera camera_init() {
   AssertNoReentry();
   
-	Camera camera;
+	Camera camera = { 0 };
 	camera.position = vector3(0.0f, 0.0f, 3.0f);
 	camera.front    = vector3(0.0f, 0.0f, 0.0f);
 	camera.up       = vector3(0.0f, 0.0f, 0.0f);
@@ -10,6 +10,13 @@ internal Camera camera_init() {
 	camera.yaw      = -90.0f;
   camera.mode     = CameraMode_Select;
   
+  camera.fovy            = Radians(CAMERA_FOVY);
+  camera.viewport_width  = 1.0f;
+  camera.viewport_height = 1.0f;
+  camera.near_plane      = CAMERA_NEAR_PLANE;
+  camera.far_plane       = CAMERA_FAR_PLANE;
+  camera.dirty           = CameraDirty_All;
+  
   _camera_update(&camera);
   return camera;
 }
@@ -60,6 +67,7 @@ internal void camera_update(Camera* camera, f32 delta_time) {
     if (input_is_key_down(KeyboardKey_E)) {
       camera->position.y += camera_speed;
     }
+    camera->dirty |= CameraDirty_View | CameraDirty_ViewProjection | CameraDirty_Inverse | CameraDirty_Frustum;
     
     f32 x_offset = InputState.mouse_current.screen_space_x  - InputState.mouse_previous.screen_space_x;
     f32 y_offset = InputState.mouse_previous.screen_space_y - InputState.mouse_current.screen_space_y;
@@ -78,11 +86,71 @@ internal void camera_update(Camera* camera, f32 delta_time) {
 }
 
 internal void _camera_update(Camera* camera) {
-  Vector3 front = vector3(cos(Radians(camera->yaw)) * cos(Radians(camera->pitch)),sin(Radians(camera->pitch)),sin(Radians(camera->yaw)) * cos(Radians(camera->pitch)));
-  
+  f32 sin_yaw, cos_yaw, sin_pitch, cos_pitch;
+  f32_fast_sincos(Radians(camera->yaw),   &sin_yaw,   &cos_yaw);
+  f32_fast_sincos(Radians(camera->pitch), &sin_pitch, &cos_pitch);
+  Vector3 front = vector3(cos_yaw * cos_pitch, sin_pitch, sin_yaw * cos_pitch);
+
   camera->front = vector3_normalize(front);
   Vector3 right = vector3_cross(camera->front, WORLD_UP);
   camera->right = vector3_normalize(right);
   Vector3 up    = vector3_cross(camera->right, camera->front);
   camera->up    = vector3_normalize(up);
-}
\ No newline at end of file
+  
+  camera->dirty |= CameraDirty_View | CameraDirty_ViewProjection | CameraDirty_Inverse | CameraDirty_Frustum;
+}
+
+internal void camera_set_perspective(Camera* camera, f32 fovy, f32 viewport_width, f32 viewport_height, f32 near_plane, f32 far_plane) {
+  if (camera->fovy            != fovy            ||
+      camera->viewport_width  != viewport_width  ||
+      camera->viewport_height != viewport_height ||
+      camera->near_plane      != near_plane      ||
+      camera->far_plane       != far_plane) {
+    camera->fovy            = fovy;
+    camera->viewport_width  = viewport_width;
+    camera->viewport_height = viewport_height;
+    camera->near_plane      = near_plane;
+    camera->far_plane       = far_plane;
+    camera->dirty |= CameraDirty_Projection | CameraDirty_ViewProjection | CameraDirty_Inverse | CameraDirty_Frustum;
+  }
+}
+
+internal Matrix4 camera_get_view(Camera* camera) {
+  if (camera->dirty & CameraDirty_View) {
+    camera->view   = matrix4_look_at(camera->position, vector3_add(camera->position, camera->front), camera->up);
+    camera->dirty &= ~CameraDirty_View;
+  }
+  return camera->view;
+}
+
+internal Matrix4 camera_get_projection(Camera* camera) {
+  if (camera->dirty & CameraDirty_Projection) {
+    camera->projection = matrix4_perspective(camera->fovy, camera->viewport_width, camera->viewport_height, camera->near_plane, camera->far_plane);
+    camera->dirty     &= ~CameraDirty_Projection;
+  }
+  return camera->projection;
+}
+
+internal Matrix4 camera_get_view_projection(Camera* camera) {
+  if (camera->dirty & CameraDirty_ViewProjection) {
+    camera->view_projection = matrix4_mul(camera_get_view(camera), camera_get_projection(camera));
+    camera->dirty          &= ~CameraDirty_ViewProjection;
+  }
+  return camera->view_projection;
+}
+
+internal Matrix4 camera_get_inverse_view_projection(Camera* camera) {
+  if (camera->dirty & CameraDirty_Inverse) {
+    camera->inverse_view_projection = matrix4_inverse(camera_get_view_projection(camera));
+    camera->dirty                  &= ~CameraDirty_Inverse;
+  }
+  return camera->inverse_view_projection;
+}
+
+internal Frustum camera_get_frustum(Camera* camera) {
+  if (camera->dirty & CameraDirty_Frustum) {
+    camera->frustum = frustum_from_matrix4(camera_get_view_projection(camera));
+    camera->dirty  &= ~CameraDirty_Frustum;
+  }
+  return camera->frustum;
+}
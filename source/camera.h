@@ -8,6 +8,9 @@
 #define CAMERA_SENSITIVITY  0.2f
 #define WORLD_UP            vector3(0.0f, 1.0f, 0.0f)
 #define CAMERA_SPEED        8.0f
+#define CAMERA_FOVY         45.0f
+#define CAMERA_NEAR_PLANE   0.1f
+#define CAMERA_FAR_PLANE    100.0f
 
 typedef enum Camera_Mode {
 	CameraMode_Select,
@@ -25,6 +28,17 @@ typedef enum Camera_Movement {
 	CameraMovement_Down
 } Camera_Movement;
 
+// NOTE(fz): Set when something the matrix depends on changes, cleared when the matrix is rebuilt by its getter.
+typedef enum Camera_Dirty {
+  CameraDirty_View           = (1 << 0),
+  CameraDirty_Projection     = (1 << 1),
+  CameraDirty_ViewProjection = (1 << 2),
+  CameraDirty_Inverse        = (1 << 3),
+  CameraDirty_Frustum        = (1 << 4),
+  
+  CameraDirty_All = CameraDirty_View | CameraDirty_Projection | CameraDirty_ViewProjection | CameraDirty_Inverse | CameraDirty_Frustum
+} Camera_Dirty;
+
 typedef struct Camera {
 	Vector3 position;
 	Vector3 front;
@@ -34,6 +48,21 @@ typedef struct Camera {
 	f32 pitch;
   
   Camera_Mode mode;
+  
+  // Projection parameters
+  f32 fovy; // Radians
+  f32 viewport_width;
+  f32 viewport_height;
+  f32 near_plane;
+  f32 far_plane;
+  
+  // Cached matrices
+  u32 dirty;
+  Matrix4 view;
+  Matrix4 projection;
+  Matrix4 view_projection;
+  Matrix4 inverse_view_projection;
+  Frustum frustum;
 } Camera;
 
 internal Camera camera_init();
@@ -42,4 +71,11 @@ internal void camera_update(Camera* camera, f32 delta_time);
 internal void camera_mouse_callback(Camera* camera, f64 x_pos, f64 y_pos);
 internal void _camera_update(Camera* camera);
 
+internal void camera_set_perspective(Camera* camera, f32 fovy, f32 viewport_width, f32 viewport_height, f32 near_plane, f32 far_plane);
+internal Matrix4 camera_get_view(Camera* camera);
+internal Matrix4 camera_get_projection(Camera* camera);
+internal Matrix4 camera_get_view_projection(Camera* camera);
+internal Matrix4 camera_get_inverse_view_projection(Camera* camera);
+internal Frustum camera_get_frustum(Camera* camera); /* World space */
+
 #endif //CAMERA_H
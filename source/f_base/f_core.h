@@ -26,6 +26,12 @@
   ARCH_64BIT
 
   ARCH_LITTLE_ENDIAN
+
+  SIMD_SSE
+  SIMD_AVX
+  SIMD_FMA
+  SIMD_F16C
+  SIMD_NEON
 */
 
 // Clang OS/Arch Cracking
@@ -175,6 +181,44 @@
 # define OS_MAC 0
 #endif
 
+// SIMD Cracking
+// NOTE(fz): SSE2 is baseline on x64. AVX/FMA are only picked up when the compiler is told it can use them
+// (/arch:AVX2 on MSVC, -mavx2 -mfma on clang/gcc). Define SIMD_DISABLE to force the scalar path.
+#if !defined(SIMD_DISABLE)
+# if ARCH_X64 || ARCH_X86
+#  if ARCH_X64 || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SIMD_SSE 1
+#  endif
+#  if SIMD_SSE && defined(__AVX__)
+#   define SIMD_AVX 1
+#  endif
+#  if SIMD_AVX && (defined(__FMA__) || (COMPILER_MSVC && defined(__AVX2__)))
+#   define SIMD_FMA 1
+#  endif
+#  if SIMD_AVX && (defined(__F16C__) || (COMPILER_MSVC && defined(__AVX2__)))
+#   define SIMD_F16C 1
+#  endif
+# elif ARCH_ARM64 || defined(__ARM_NEON)
+#  define SIMD_NEON 1
+# endif
+#endif
+
+#if !defined(SIMD_SSE)
+# define SIMD_SSE 0
+#endif
+#if !defined(SIMD_AVX)
+# define SIMD_AVX 0
+#endif
+#if !defined(SIMD_FMA)
+# define SIMD_FMA 0
+#endif
+#if !defined(SIMD_F16C)
+# define SIMD_F16C 0
+#endif
+#if !defined(SIMD_NEON)
+# define SIMD_NEON 0
+#endif
+
 #if COMPILER_MSVC
 # define thread_static __declspec(thread)
 #elif COMPILER_CLANG || COMPILER_GCC
@@ -12,21 +12,25 @@
 
 //~ Headers
 #include "f_core.h"
+#include "f_simd.h"
 #include "f_math.h"
 #include "f_memory.h"
 #include "f_string.h"
 #include "f_thread_context.h"
 #include "f_os/f_os.h"
+#include "f_parallel.h"
 
 //~ Extern
 #define STB_SPRINTF_IMPLEMENTATION
 #include "external/stb_sprintf.h"
 
 //~ Source
+#include "f_simd.c"
 #include "f_math.c"
 #include "f_memory.c"
 #include "f_string.c"
 #include "f_thread_context.c"
 #include "f_os/f_os.c"
+#include "f_parallel.c"
 
 #endif // F_INCLUDES_H
\ No newline at end of file
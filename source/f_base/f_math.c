@@ -1,3 +1,39 @@
+//////////////////////////////////////////////
+// SIMD helpers
+
+internal f32x4 _f32x4_from_vector3(Vector3 v, f32 w) {
+	f32x4 result = f32x4_set(v.x, v.y, v.z, w);
+	return result;
+}
+
+internal Vector3 _vector3_from_f32x4(f32x4 v) {
+	f32 lanes[4];
+	f32x4_store(lanes, v);
+	Vector3 result = { lanes[0], lanes[1], lanes[2] };
+	return result;
+}
+
+/* m*v, rows of m dotted with v */
+internal f32x4 _mul_f32x4_matrix4(f32x4 v, Matrix4* m) {
+	f32x4 r0 = f32x4_mul(f32x4_load(m->data[0]), v);
+	f32x4 r1 = f32x4_mul(f32x4_load(m->data[1]), v);
+	f32x4 r2 = f32x4_mul(f32x4_load(m->data[2]), v);
+	f32x4 r3 = f32x4_mul(f32x4_load(m->data[3]), v);
+	f32x4_transpose(&r0, &r1, &r2, &r3);
+	f32x4 result = f32x4_add(f32x4_add(r0, r1), f32x4_add(r2, r3));
+	return result;
+}
+
+/* Normalizes all 4 lanes, zero length is treated as length 1 */
+internal f32x4 _f32x4_normalize_or_keep(f32x4 v) {
+	f32 length = sqrtf(f32x4_hsum(f32x4_mul(v, v)));
+	if (length == 0.0f) {
+		length = 1.0f;
+	}
+	f32x4 result = f32x4_mul(v, f32x4_splat(1.0f/length));
+	return result;
+}
+
 internal f32 f32_clamp(f32 value, f32 min, f32 max) {
 	f32 result = (value < min)? min : value;
 	if (result > max) {
@@ -102,12 +138,8 @@ internal Vector3 vector3_div(Vector3 a, Vector3 b) {
 }
 
 internal Vector4 mul_vector4_matrix4(Vector4 v, Matrix4 m) {
-	Vector4 result = { 
-		m.m0*v.x + m.m4*v.y + m.m8 *v.z + m.m12*v.w,
-		m.m1*v.x + m.m5*v.y + m.m9 *v.z + m.m13*v.w,
-		m.m2*v.x + m.m6*v.y + m.m10*v.z + m.m14*v.w,
-		m.m3*v.x + m.m7*v.y + m.m11*v.z + m.m15*v.w
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, _mul_f32x4_matrix4(f32x4_load(v.data), &m));
 	return result;
 }
 
@@ -140,22 +172,16 @@ internal Vector3 vector3_scale_xyz(Vector3 v, f32 scale_x, f32 scale_y, f32 scal
 
 internal Vector3 vector3_normalize(Vector3 v) {
 	Vector3 result = v;
-	f32 length = sqrtf(v.x*v.x + v.y*v.y + v.z*v.z);
-	if (length != 0.0f) {
-		f32 ilength = 1.0f/length;
-		result.x *= ilength;
-		result.y *= ilength;
-		result.z *= ilength;
+	f32x4 xyz    = _f32x4_from_vector3(v, 0.0f);
+	f32x4 length = f32x4_sqrt(f32x4_dot(xyz, xyz));
+	if (f32x4_first(length) != 0.0f) {
+		result = _vector3_from_f32x4(f32x4_div(xyz, length));
 	}
 	return result;
 }
 
 internal Vector3 mul_vector3_matrix4(Vector3 v, Matrix4 m) {
-	Vector3 result = {
-		m.m0*v.x + m.m4*v.y + m.m8* v.z + m.m12,
-		m.m1*v.x + m.m5*v.y + m.m9* v.z + m.m13,
-		m.m2*v.x + m.m6*v.y + m.m10*v.z + m.m14
-	};
+	Vector3 result = _vector3_from_f32x4(_mul_f32x4_matrix4(_f32x4_from_vector3(v, 1.0f), &m));
 	return result;
 }
 
@@ -219,84 +245,17 @@ internal Vector3 vector3_lerp(Vector3 a, Vector3 b, f32 t) {
 }
 
 internal Vector3 vector3_unproject(Vector3 source, Matrix4 projection, Matrix4 view) {
-  Vector3 result = { 0 };
-  
-  // Calculate unprojected matrix (multiply view matrix by projection matrix) and invert it
-  Matrix4 matViewProj = {      // MatrixMultiply(view, projection);
-    view.m0*projection.m0 + view.m1*projection.m4 + view.m2*projection.m8 + view.m3*projection.m12,
-    view.m0*projection.m1 + view.m1*projection.m5 + view.m2*projection.m9 + view.m3*projection.m13,
-    view.m0*projection.m2 + view.m1*projection.m6 + view.m2*projection.m10 + view.m3*projection.m14,
-    view.m0*projection.m3 + view.m1*projection.m7 + view.m2*projection.m11 + view.m3*projection.m15,
-    view.m4*projection.m0 + view.m5*projection.m4 + view.m6*projection.m8 + view.m7*projection.m12,
-    view.m4*projection.m1 + view.m5*projection.m5 + view.m6*projection.m9 + view.m7*projection.m13,
-    view.m4*projection.m2 + view.m5*projection.m6 + view.m6*projection.m10 + view.m7*projection.m14,
-    view.m4*projection.m3 + view.m5*projection.m7 + view.m6*projection.m11 + view.m7*projection.m15,
-    view.m8*projection.m0 + view.m9*projection.m4 + view.m10*projection.m8 + view.m11*projection.m12,
-    view.m8*projection.m1 + view.m9*projection.m5 + view.m10*projection.m9 + view.m11*projection.m13,
-    view.m8*projection.m2 + view.m9*projection.m6 + view.m10*projection.m10 + view.m11*projection.m14,
-    view.m8*projection.m3 + view.m9*projection.m7 + view.m10*projection.m11 + view.m11*projection.m15,
-    view.m12*projection.m0 + view.m13*projection.m4 + view.m14*projection.m8 + view.m15*projection.m12,
-    view.m12*projection.m1 + view.m13*projection.m5 + view.m14*projection.m9 + view.m15*projection.m13,
-    view.m12*projection.m2 + view.m13*projection.m6 + view.m14*projection.m10 + view.m15*projection.m14,
-    view.m12*projection.m3 + view.m13*projection.m7 + view.m14*projection.m11 + view.m15*projection.m15 };
-  
-  // Calculate inverted matrix -> MatrixInvert(matViewProj);
-  // Cache the matrix values (speed optimization)
-  f32 a00 = matViewProj.m0, a01 = matViewProj.m1, a02 = matViewProj.m2, a03 = matViewProj.m3;
-  f32 a10 = matViewProj.m4, a11 = matViewProj.m5, a12 = matViewProj.m6, a13 = matViewProj.m7;
-  f32 a20 = matViewProj.m8, a21 = matViewProj.m9, a22 = matViewProj.m10, a23 = matViewProj.m11;
-  f32 a30 = matViewProj.m12, a31 = matViewProj.m13, a32 = matViewProj.m14, a33 = matViewProj.m15;
-  
-  f32 b00 = a00*a11 - a01*a10;
-  f32 b01 = a00*a12 - a02*a10;
-  f32 b02 = a00*a13 - a03*a10;
-  f32 b03 = a01*a12 - a02*a11;
-  f32 b04 = a01*a13 - a03*a11;
-  f32 b05 = a02*a13 - a03*a12;
-  f32 b06 = a20*a31 - a21*a30;
-  f32 b07 = a20*a32 - a22*a30;
-  f32 b08 = a20*a33 - a23*a30;
-  f32 b09 = a21*a32 - a22*a31;
-  f32 b10 = a21*a33 - a23*a31;
-  f32 b11 = a22*a33 - a23*a32;
-  
-  // Calculate the invert determinant (inlined to avoid double-caching)
-  f32 invDet = 1.0f/(b00*b11 - b01*b10 + b02*b09 + b03*b08 - b04*b07 + b05*b06);
-  
-  Matrix4 matViewProjInv = {
-    (a11*b11 - a12*b10 + a13*b09)*invDet,
-    (-a01*b11 + a02*b10 - a03*b09)*invDet,
-    (a31*b05 - a32*b04 + a33*b03)*invDet,
-    (-a21*b05 + a22*b04 - a23*b03)*invDet,
-    (-a10*b11 + a12*b08 - a13*b07)*invDet,
-    (a00*b11 - a02*b08 + a03*b07)*invDet,
-    (-a30*b05 + a32*b02 - a33*b01)*invDet,
-    (a20*b05 - a22*b02 + a23*b01)*invDet,
-    (a10*b10 - a11*b08 + a13*b06)*invDet,
-    (-a00*b10 + a01*b08 - a03*b06)*invDet,
-    (a30*b04 - a31*b02 + a33*b00)*invDet,
-    (-a20*b04 + a21*b02 - a23*b00)*invDet,
-    (-a10*b09 + a11*b07 - a12*b06)*invDet,
-    (a00*b09 - a01*b07 + a02*b06)*invDet,
-    (-a30*b03 + a31*b01 - a32*b00)*invDet,
-    (a20*b03 - a21*b01 + a22*b00)*invDet };
-  
-  // Create quaternion from source point
-  Quaternion quat = { source.x, source.y, source.z, 1.0f };
-  
-  // Multiply quat point by unprojecte matrix
-  Quaternion qtransformed = {     // QuaternionTransform(quat, matViewProjInv)
-    matViewProjInv.m0*quat.x + matViewProjInv.m4*quat.y + matViewProjInv.m8*quat.z + matViewProjInv.m12*quat.w,
-    matViewProjInv.m1*quat.x + matViewProjInv.m5*quat.y + matViewProjInv.m9*quat.z + matViewProjInv.m13*quat.w,
-    matViewProjInv.m2*quat.x + matViewProjInv.m6*quat.y + matViewProjInv.m10*quat.z + matViewProjInv.m14*quat.w,
-    matViewProjInv.m3*quat.x + matViewProjInv.m7*quat.y + matViewProjInv.m11*quat.z + matViewProjInv.m15*quat.w };
-  
-  // Normalized world points in vectors
-  result.x = qtransformed.x/qtransformed.w;
-  result.y = qtransformed.y/qtransformed.w;
-  result.z = qtransformed.z/qtransformed.w;
-  
-  return result;
+	Matrix4 view_projection = matrix4_mul(view, projection);
+	Vector3 result = vector3_unproject_inverse(source, matrix4_inverse(view_projection));
+	return result;
+}
+
+internal Vector3 vector3_unproject_inverse(Vector3 source, Matrix4 inverse_view_projection) {
+	f32x4 transformed = _mul_f32x4_matrix4(_f32x4_from_vector3(source, 1.0f), &inverse_view_projection);
+	
+	// Normalized world points in vectors
+	Vector3 result = _vector3_from_f32x4(f32x4_div(transformed, F32x4Shuffle(transformed, 3, 3, 3, 3)));
+	return result;
 }
 
 internal f32 vector3_dot(Vector3 a, Vector3 b) {
@@ -333,85 +292,60 @@ internal Vector4 vector4_from_vector3(Vector3 v) {
 }
 
 internal Vector4 vector4_add(Vector4 a, Vector4 b) {
-	Vector4 result = {
-		a.x + b.x,
-		a.y + b.y,
-		a.z + b.z,
-		a.w + b.w
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, f32x4_add(f32x4_load(a.data), f32x4_load(b.data)));
 	return result;
 }
 
 internal Vector4 vector4_sub(Vector4 a, Vector4 b) {
-	Vector4 result = {
-		a.x - b.x,
-		a.y - b.y,
-		a.z - b.z,
-		a.w - b.w
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, f32x4_sub(f32x4_load(a.data), f32x4_load(b.data)));
 	return result;
 }
 
 internal Vector4 vector4_mul(Vector4 a, Vector4 b) {
-	Vector4 result = {
-		a.x * b.x,
-		a.y * b.y,
-		a.z * b.z,
-		a.w * b.w
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, f32x4_mul(f32x4_load(a.data), f32x4_load(b.data)));
 	return result;
 }
 
 internal Vector4 vector4_div(Vector4 a, Vector4 b) {
-	Vector4 result = {
-		a.x / b.x,
-		a.y / b.y,
-		a.z / b.z,
-		a.w / b.w
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, f32x4_div(f32x4_load(a.data), f32x4_load(b.data)));
 	return result;
 }
 
 internal Vector4 vector4_scale(Vector4 v, f32 scalar) {
-	Vector4 result = {
-		v.x*scalar,
-		v.y*scalar,
-		v.z*scalar,
-		v.w*scalar
-	};
+	Vector4 result = { 0 };
+	f32x4_store(result.data, f32x4_mul(f32x4_load(v.data), f32x4_splat(scalar)));
 	return result;
 }
 
 internal Vector4 vector4_normalize(Vector4 v) {
 	Vector4 result = v;
-	f32 length = sqrtf((v.x*v.x) + (v.y*v.y) + (v.z*v.z) + (v.w*v.w));
-	if (length > 0) {
-    f32 ilength = 1.0f/length;
-    result.x = v.x*ilength;
-    result.y = v.y*ilength;
-    result.z = v.z*ilength;
-    result.w = v.w*ilength;
+	f32x4 xyzw   = f32x4_load(v.data);
+	f32x4 length = f32x4_sqrt(f32x4_dot(xyzw, xyzw));
+	if (f32x4_first(length) > 0) {
+		f32x4_store(result.data, f32x4_div(xyzw, length));
 	}
 	return result;
 }
 
 internal Vector4 vector4_lerp(Vector4 a, Vector4 b, f32 t) {
-	Vector4 result = {
-		a.x + t*(b.x - a.x),
-		a.y + t*(b.y - a.y),
-		a.z + t*(b.z - a.z),
-		a.w + t*(b.w - a.w)
-	};
+	Vector4 result = { 0 };
+	f32x4 start = f32x4_load(a.data);
+	f32x4_store(result.data, f32x4_madd(f32x4_splat(t), f32x4_sub(f32x4_load(b.data), start), start));
 	return result;
 }
 
 internal f32 vector4_dot(Vector4 a, Vector4 b) {
-	f32 result = (a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w);
+	f32 result = f32x4_hsum(f32x4_mul(f32x4_load(a.data), f32x4_load(b.data)));
 	return result;
 }
 
 internal f32 vector4_length(Vector4 v) {
-	f32 result = sqrtf((v.x*v.x) + (v.y*v.y) + (v.z*v.z) + (v.w*v.w));
+	f32x4 xyzw = f32x4_load(v.data);
+	f32 result = sqrtf(f32x4_hsum(f32x4_mul(xyzw, xyzw)));
 	return result;
 }
 
@@ -430,64 +364,56 @@ internal f32 vector4_distance(Vector4 a, Vector4 b) {
 
 internal Matrix4 matrix4_add(Matrix4 left, Matrix4 right) {
 	Matrix4 result = { 0 };
-	result.m0  = left.m0  + right.m0;
-	result.m1  = left.m1  + right.m1;
-	result.m2  = left.m2  + right.m2;
-	result.m3  = left.m3  + right.m3;
-	result.m4  = left.m4  + right.m4;
-	result.m5  = left.m5  + right.m5;
-	result.m6  = left.m6  + right.m6;
-	result.m7  = left.m7  + right.m7;
-	result.m8  = left.m8  + right.m8;
-	result.m9  = left.m9  + right.m9;
-	result.m10 = left.m10 + right.m10;
-	result.m11 = left.m11 + right.m11;
-	result.m12 = left.m12 + right.m12;
-	result.m13 = left.m13 + right.m13;
-	result.m14 = left.m14 + right.m14;
-	result.m15 = left.m15 + right.m15;
+	for (u32 i = 0; i < 4; i += 1) {
+		f32x4_store(result.data[i], f32x4_add(f32x4_load(left.data[i]), f32x4_load(right.data[i])));
+	}
 	return result;
 }
 
 internal Matrix4 matrix4_sub(Matrix4 left, Matrix4 right) {
 	Matrix4 result = { 0 };
-	result.m0  = left.m0  - right.m0;
-	result.m1  = left.m1  - right.m1;
-	result.m2  = left.m2  - right.m2;
-	result.m3  = left.m3  - right.m3;
-	result.m4  = left.m4  - right.m4;
-	result.m5  = left.m5  - right.m5;
-	result.m6  = left.m6  - right.m6;
-	result.m7  = left.m7  - right.m7;
-	result.m8  = left.m8  - right.m8;
-	result.m9  = left.m9  - right.m9;
-	result.m10 = left.m10 - right.m10;
-	result.m11 = left.m11 - right.m11;
-	result.m12 = left.m12 - right.m12;
-	result.m13 = left.m13 - right.m13;
-	result.m14 = left.m14 - right.m14;
-	result.m15 = left.m15 - right.m15;
+	for (u32 i = 0; i < 4; i += 1) {
+		f32x4_store(result.data[i], f32x4_sub(f32x4_load(left.data[i]), f32x4_load(right.data[i])));
+	}
 	return result;
 }
 
 internal Matrix4 matrix4_mul(Matrix4 left, Matrix4 right) {
+	// NOTE(fz): Each row of the result is left's rows weighted by the matching row of right:
+	// result.data[i] = right[i][0]*left.data[0] + right[i][1]*left.data[1] + right[i][2]*left.data[2] + right[i][3]*left.data[3]
 	Matrix4 result = { 0 };
-	result.m0  = left.m0 *right.m0 + left.m1 *right.m4 + left.m2 *right.m8  + left.m3 *right.m12;
-	result.m1  = left.m0 *right.m1 + left.m1 *right.m5 + left.m2 *right.m9  + left.m3 *right.m13;
-	result.m2  = left.m0 *right.m2 + left.m1 *right.m6 + left.m2 *right.m10 + left.m3 *right.m14;
-	result.m3  = left.m0 *right.m3 + left.m1 *right.m7 + left.m2 *right.m11 + left.m3 *right.m15;
-	result.m4  = left.m4 *right.m0 + left.m5 *right.m4 + left.m6 *right.m8  + left.m7 *right.m12;
-	result.m5  = left.m4 *right.m1 + left.m5 *right.m5 + left.m6 *right.m9  + left.m7 *right.m13;
-	result.m6  = left.m4 *right.m2 + left.m5 *right.m6 + left.m6 *right.m10 + left.m7 *right.m14;
-	result.m7  = left.m4 *right.m3 + left.m5 *right.m7 + left.m6 *right.m11 + left.m7 *right.m15;
-	result.m8  = left.m8 *right.m0 + left.m9 *right.m4 + left.m10*right.m8  + left.m11*right.m12;
-	result.m9  = left.m8 *right.m1 + left.m9 *right.m5 + left.m10*right.m9  + left.m11*right.m13;
-	result.m10 = left.m8 *right.m2 + left.m9 *right.m6 + left.m10*right.m10 + left.m11*right.m14;
-	result.m11 = left.m8 *right.m3 + left.m9 *right.m7 + left.m10*right.m11 + left.m11*right.m15;
-	result.m12 = left.m12*right.m0 + left.m13*right.m4 + left.m14*right.m8  + left.m15*right.m12;
-	result.m13 = left.m12*right.m1 + left.m13*right.m5 + left.m14*right.m9  + left.m15*right.m13;
-	result.m14 = left.m12*right.m2 + left.m13*right.m6 + left.m14*right.m10 + left.m15*right.m14;
-	result.m15 = left.m12*right.m3 + left.m13*right.m7 + left.m14*right.m11 + left.m15*right.m15;
+#if SIMD_AVX
+	// Two result rows per iteration. Every left row is duplicated in both halves of the register.
+	f32x4 l0 = f32x4_load(left.data[0]);
+	f32x4 l1 = f32x4_load(left.data[1]);
+	f32x4 l2 = f32x4_load(left.data[2]);
+	f32x4 l3 = f32x4_load(left.data[3]);
+	f32x8 ll0 = f32x8_from_f32x4(l0, l0);
+	f32x8 ll1 = f32x8_from_f32x4(l1, l1);
+	f32x8 ll2 = f32x8_from_f32x4(l2, l2);
+	f32x8 ll3 = f32x8_from_f32x4(l3, l3);
+	for (u32 i = 0; i < 4; i += 2) {
+		f32x8 r   = f32x8_load(&right.data[i][0]);
+		f32x8 row = f32x8_mul(F32x8Shuffle(r, 0, 0, 0, 0), ll0);
+		row = f32x8_madd(F32x8Shuffle(r, 1, 1, 1, 1), ll1, row);
+		row = f32x8_madd(F32x8Shuffle(r, 2, 2, 2, 2), ll2, row);
+		row = f32x8_madd(F32x8Shuffle(r, 3, 3, 3, 3), ll3, row);
+		f32x8_store(&result.data[i][0], row);
+	}
+#else
+	f32x4 l0 = f32x4_load(left.data[0]);
+	f32x4 l1 = f32x4_load(left.data[1]);
+	f32x4 l2 = f32x4_load(left.data[2]);
+	f32x4 l3 = f32x4_load(left.data[3]);
+	for (u32 i = 0; i < 4; i += 1) {
+		f32x4 r   = f32x4_load(right.data[i]);
+		f32x4 row = f32x4_mul(F32x4Shuffle(r, 0, 0, 0, 0), l0);
+		row = f32x4_madd(F32x4Shuffle(r, 1, 1, 1, 1), l1, row);
+		row = f32x4_madd(F32x4Shuffle(r, 2, 2, 2, 2), l2, row);
+		row = f32x4_madd(F32x4Shuffle(r, 3, 3, 3, 3), l3, row);
+		f32x4_store(result.data[i], row);
+	}
+#endif
 	return result;
 }
 
@@ -656,22 +582,108 @@ internal Matrix4 matrix4_rotate_zyx(Vector3 radians) {
 
 internal Matrix4 matrix4_transpose(Matrix4 m) {
 	Matrix4 result = { 0 };
-	result.m0  = m.m0;
-	result.m1  = m.m4;
-	result.m2  = m.m8;
-	result.m3  = m.m12;
-	result.m4  = m.m1;
-	result.m5  = m.m5;
-	result.m6  = m.m9;
-	result.m7  = m.m13;
-	result.m8  = m.m2;
-	result.m9  = m.m6;
-	result.m10 = m.m10;
-	result.m11 = m.m14;
-	result.m12 = m.m3;
-	result.m13 = m.m7;
-	result.m14 = m.m11;
-	result.m15 = m.m15;
+	f32x4 r0 = f32x4_load(m.data[0]);
+	f32x4 r1 = f32x4_load(m.data[1]);
+	f32x4 r2 = f32x4_load(m.data[2]);
+	f32x4 r3 = f32x4_load(m.data[3]);
+	f32x4_transpose(&r0, &r1, &r2, &r3);
+	f32x4_store(result.data[0], r0);
+	f32x4_store(result.data[1], r1);
+	f32x4_store(result.data[2], r2);
+	f32x4_store(result.data[3], r3);
+	return result;
+}
+
+internal Matrix4 matrix4_inverse(Matrix4 m) {
+	Matrix4 result = { 0 };
+	
+	// Cache the matrix values (speed optimization)
+	f32 a00 = m.m0,  a01 = m.m1,  a02 = m.m2,  a03 = m.m3;
+	f32 a10 = m.m4,  a11 = m.m5,  a12 = m.m6,  a13 = m.m7;
+	f32 a20 = m.m8,  a21 = m.m9,  a22 = m.m10, a23 = m.m11;
+	f32 a30 = m.m12, a31 = m.m13, a32 = m.m14, a33 = m.m15;
+	
+	f32 b00 = a00*a11 - a01*a10;
+	f32 b01 = a00*a12 - a02*a10;
+	f32 b02 = a00*a13 - a03*a10;
+	f32 b03 = a01*a12 - a02*a11;
+	f32 b04 = a01*a13 - a03*a11;
+	f32 b05 = a02*a13 - a03*a12;
+	f32 b06 = a20*a31 - a21*a30;
+	f32 b07 = a20*a32 - a22*a30;
+	f32 b08 = a20*a33 - a23*a30;
+	f32 b09 = a21*a32 - a22*a31;
+	f32 b10 = a21*a33 - a23*a31;
+	f32 b11 = a22*a33 - a23*a32;
+	
+	f32 det = b00*b11 - b01*b10 + b02*b09 + b03*b08 - b04*b07 + b05*b06;
+	if (det == 0.0f) {
+		return result;
+	}
+	f32 inv_det = 1.0f/det;
+	
+	result.m0  = ( a11*b11 - a12*b10 + a13*b09)*inv_det;
+	result.m1  = (-a01*b11 + a02*b10 - a03*b09)*inv_det;
+	result.m2  = ( a31*b05 - a32*b04 + a33*b03)*inv_det;
+	result.m3  = (-a21*b05 + a22*b04 - a23*b03)*inv_det;
+	result.m4  = (-a10*b11 + a12*b08 - a13*b07)*inv_det;
+	result.m5  = ( a00*b11 - a02*b08 + a03*b07)*inv_det;
+	result.m6  = (-a30*b05 + a32*b02 - a33*b01)*inv_det;
+	result.m7  = ( a20*b05 - a22*b02 + a23*b01)*inv_det;
+	result.m8  = ( a10*b10 - a11*b08 + a13*b06)*inv_det;
+	result.m9  = (-a00*b10 + a01*b08 - a03*b06)*inv_det;
+	result.m10 = ( a30*b04 - a31*b02 + a33*b00)*inv_det;
+	result.m11 = (-a20*b04 + a21*b02 - a23*b00)*inv_det;
+	result.m12 = (-a10*b09 + a11*b07 - a12*b06)*inv_det;
+	result.m13 = ( a00*b09 - a01*b07 + a02*b06)*inv_det;
+	result.m14 = (-a30*b03 + a31*b01 - a32*b00)*inv_det;
+	result.m15 = ( a20*b03 - a21*b01 + a22*b00)*inv_det;
+	
+	return result;
+}
+
+internal Matrix4 matrix4_inverse_affine(Matrix4 m) {
+	Matrix4 result = matrix4(1.0f);
+	
+	// Inverse of the upper 3x3 through its cofactors, then translation becomes -(A^-1 * t)
+	f32 c00 = m.m5*m.m10 - m.m9*m.m6;
+	f32 c01 = m.m9*m.m2  - m.m1*m.m10;
+	f32 c02 = m.m1*m.m6  - m.m5*m.m2;
+	f32 det = m.m0*c00 + m.m4*c01 + m.m8*c02;
+	if (det == 0.0f) {
+		return matrix4(0.0f);
+	}
+	f32 inv_det = 1.0f/det;
+	
+	result.m0  = c00*inv_det;
+	result.m1  = c01*inv_det;
+	result.m2  = c02*inv_det;
+	result.m4  = (m.m8*m.m6  - m.m4*m.m10)*inv_det;
+	result.m5  = (m.m0*m.m10 - m.m8*m.m2)*inv_det;
+	result.m6  = (m.m4*m.m2  - m.m0*m.m6)*inv_det;
+	result.m8  = (m.m4*m.m9  - m.m8*m.m5)*inv_det;
+	result.m9  = (m.m8*m.m1  - m.m0*m.m9)*inv_det;
+	result.m10 = (m.m0*m.m5  - m.m4*m.m1)*inv_det;
+	
+	result.m12 = -(result.m0*m.m12 + result.m4*m.m13 + result.m8 *m.m14);
+	result.m13 = -(result.m1*m.m12 + result.m5*m.m13 + result.m9 *m.m14);
+	result.m14 = -(result.m2*m.m12 + result.m6*m.m13 + result.m10*m.m14);
+	
+	return result;
+}
+
+internal Matrix4 matrix4_inverse_rigid(Matrix4 m) {
+	Matrix4 result = matrix4(1.0f);
+	
+	// Rotation part is orthonormal, so its inverse is the transpose
+	result.m0 = m.m0; result.m4 = m.m1; result.m8  = m.m2;
+	result.m1 = m.m4; result.m5 = m.m5; result.m9  = m.m6;
+	result.m2 = m.m8; result.m6 = m.m9; result.m10 = m.m10;
+	
+	result.m12 = -(result.m0*m.m12 + result.m4*m.m13 + result.m8 *m.m14);
+	result.m13 = -(result.m1*m.m12 + result.m5*m.m13 + result.m9 *m.m14);
+	result.m14 = -(result.m2*m.m12 + result.m6*m.m13 + result.m10*m.m14);
+	
 	return result;
 }
 
@@ -898,123 +910,97 @@ internal Transform transform_from_matrix4(Matrix4 mat) {
 }
 
 internal Quaternion quaternion_add(Quaternion q1, Quaternion q2) {
-	Quaternion result = {q1.x + q2.x, q1.y + q2.y, q1.z + q2.z, q1.w + q2.w};
+	Quaternion result = { 0 };
+	f32x4_store(result.data, f32x4_add(f32x4_load(q1.data), f32x4_load(q2.data)));
 	return result;
 }
 
 internal Quaternion quaternion_add_value(Quaternion q, f32 value) {
-	Quaternion result = {q.x + value, q.y + value, q.z + value, q.w + value};
+	Quaternion result = { 0 };
+	f32x4_store(result.data, f32x4_add(f32x4_load(q.data), f32x4_splat(value)));
 	return result;
 }
 
 internal Quaternion quaternion_subtract(Quaternion q1, Quaternion q2) {
-	Quaternion result = {q1.x - q2.x, q1.y - q2.y, q1.z - q2.z, q1.w - q2.w};
+	Quaternion result = { 0 };
+	f32x4_store(result.data, f32x4_sub(f32x4_load(q1.data), f32x4_load(q2.data)));
 	return result;
 }
 
 internal Quaternion quaternion_subtract_value(Quaternion q, f32 value) {
-	Quaternion result = {q.x - value, q.y - value, q.z - value, q.w - value};
+	Quaternion result = { 0 };
+	f32x4_store(result.data, f32x4_sub(f32x4_load(q.data), f32x4_splat(value)));
 	return result;
 }
 
 internal f32 quaternion_length(Quaternion q) {
-	f32 result = sqrtf(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
+	f32x4 xyzw = f32x4_load(q.data);
+	f32 result = sqrtf(f32x4_hsum(f32x4_mul(xyzw, xyzw)));
 	return result;
 }
 
 internal Quaternion quaternion_normalize(Quaternion q) {
 	Quaternion result = { 0 };
-
-	f32 length = sqrtf(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
-	if (length == 0.0f) {
-		length = 1.0f;
-	}
-	f32 ilength = 1.0f/length;
-
-	result.x = q.x*ilength;
-	result.y = q.y*ilength;
-	result.z = q.z*ilength;
-	result.w = q.w*ilength;
-
+	f32x4_store(result.data, _f32x4_normalize_or_keep(f32x4_load(q.data)));
 	return result;
 }
 
 internal Quaternion quaternion_invert(Quaternion q) {
 	Quaternion result = q;
-	f32 lengthSq = q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w;
-
-	if (lengthSq != 0.0f) {
-		f32 invLength = 1.0f/lengthSq;
-		result.x *= -invLength;
-		result.y *= -invLength;
-		result.z *= -invLength;
-		result.w *= invLength;
+	f32x4 xyzw      = f32x4_load(q.data);
+	f32x4 length_sq = f32x4_dot(xyzw, xyzw);
+
+	if (f32x4_first(length_sq) != 0.0f) {
+		f32x4 conjugate = f32x4_mul(xyzw, f32x4_set(-1.0f, -1.0f, -1.0f, 1.0f));
+		f32x4_store(result.data, f32x4_div(conjugate, length_sq));
 	}
 	return result;
 }
 
 internal Quaternion quaternion_multiply(Quaternion q1, Quaternion q2) {
 	Quaternion result = { 0 };
-	f32 qax = q1.x, qay = q1.y, qaz = q1.z, qaw = q1.w;
-	f32 qbx = q2.x, qby = q2.y, qbz = q2.z, qbw = q2.w;
+	f32x4 a = f32x4_load(q1.data);
+	f32x4 b = f32x4_load(q2.data);
 
-	result.x = qax*qbw + qaw*qbx + qay*qbz - qaz*qby;
-	result.y = qay*qbw + qaw*qby + qaz*qbx - qax*qbz;
-	result.z = qaz*qbw + qaw*qbz + qax*qby - qay*qbx;
-	result.w = qaw*qbw - qax*qbx - qay*qby - qaz*qbz;
+	// x = ax*bw + aw*bx + ay*bz - az*by
+	// y = ay*bw + aw*by + az*bx - ax*bz
+	// z = az*bw + aw*bz + ax*by - ay*bx
+	// w = aw*bw - ax*bx - ay*by - az*bz
+	f32x4 t0 = f32x4_mul(a, F32x4Shuffle(b, 3, 3, 3, 3));
+	f32x4 t1 = f32x4_mul(F32x4Shuffle(a, 3, 3, 3, 0), F32x4Shuffle(b, 0, 1, 2, 0));
+	f32x4 t2 = f32x4_mul(F32x4Shuffle(a, 1, 2, 0, 1), F32x4Shuffle(b, 2, 0, 1, 1));
+	f32x4 t3 = f32x4_mul(F32x4Shuffle(a, 2, 0, 1, 2), F32x4Shuffle(b, 1, 2, 0, 2));
+
+	f32x4 sum = f32x4_madd(f32x4_add(t1, t2), f32x4_set(1.0f, 1.0f, 1.0f, -1.0f), t0);
+	f32x4_store(result.data, f32x4_sub(sum, t3));
 
 	return result;
 }
 
 internal Quaternion quaternion_scale(Quaternion q, f32 scalar) {
 	Quaternion result = { 0 };
-
-	result.x = q.x*scalar;
-	result.y = q.y*scalar;
-	result.z = q.z*scalar;
-	result.w = q.w*scalar;
-
+	f32x4_store(result.data, f32x4_mul(f32x4_load(q.data), f32x4_splat(scalar)));
 	return result;
 }
 
 internal Quaternion quaternion_divide(Quaternion q1, Quaternion q2) {
-	Quaternion result = { q1.x/q2.x, q1.y/q2.y, q1.z/q2.z, q1.w/q2.w };
+	Quaternion result = { 0 };
+	f32x4_store(result.data, f32x4_div(f32x4_load(q1.data), f32x4_load(q2.data)));
 	return result;
 }
 
 internal Quaternion quaternion_lerp(Quaternion q1, Quaternion q2, f32 amount) {
 	Quaternion result = { 0 };
-
-	result.x = q1.x + amount*(q2.x - q1.x);
-	result.y = q1.y + amount*(q2.y - q1.y);
-	result.z = q1.z + amount*(q2.z - q1.z);
-	result.w = q1.w + amount*(q2.w - q1.w);
-
+	f32x4 start = f32x4_load(q1.data);
+	f32x4_store(result.data, f32x4_madd(f32x4_splat(amount), f32x4_sub(f32x4_load(q2.data), start), start));
 	return result;
 }
 
 internal Quaternion quaternion_nlerp(Quaternion q1, Quaternion q2, f32 amount) {
 	Quaternion result = { 0 };
-
-	// QuaternionLerp(q1, q2, amount)
-	result.x = q1.x + amount*(q2.x - q1.x);
-	result.y = q1.y + amount*(q2.y - q1.y);
-	result.z = q1.z + amount*(q2.z - q1.z);
-	result.w = q1.w + amount*(q2.w - q1.w);
-
-	// QuaternionNormalize(q);
-	Quaternion q = result;
-	f32 length = sqrtf(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
-	if (length == 0.0f) {
-		length = 1.0f;
-	}
-	f32 ilength = 1.0f/length;
-
-	result.x = q.x*ilength;
-	result.y = q.y*ilength;
-	result.z = q.z*ilength;
-	result.w = q.w*ilength;
-
+	f32x4 start = f32x4_load(q1.data);
+	f32x4 lerp  = f32x4_madd(f32x4_splat(amount), f32x4_sub(f32x4_load(q2.data), start), start);
+	f32x4_store(result.data, _f32x4_normalize_or_keep(lerp));
 	return result;
 }
 
@@ -1281,12 +1267,7 @@ internal void euler_from_quaternion(Quaternion q, f32* pitch, f32* yaw, f32* rol
 
 internal Quaternion quaternion_mul_matric4(Quaternion q, Matrix4 mat) {
 	Quaternion result = { 0 };
-
-	result.x = mat.m0*q.x + mat.m4*q.y + mat.m8*q.z + mat.m12*q.w;
-	result.y = mat.m1*q.x + mat.m5*q.y + mat.m9*q.z + mat.m13*q.w;
-	result.z = mat.m2*q.x + mat.m6*q.y + mat.m10*q.z + mat.m14*q.w;
-	result.w = mat.m3*q.x + mat.m7*q.y + mat.m11*q.z + mat.m15*q.w;
-
+	f32x4_store(result.data, _mul_f32x4_matrix4(f32x4_load(q.data), &mat));
 	return result;
 }
 
@@ -1351,3 +1332,1353 @@ internal Vector3 intersect_ray_with_plane(Ray ray, Vector3 point1, Vector3 point
   
 	return result;
 }
+
+//////////////////////////////////////////////
+// Wide types
+
+internal Vector3x4 vector3x4_splat(Vector3 v) {
+	Vector3x4 result;
+	result.x = f32x4_splat(v.x);
+	result.y = f32x4_splat(v.y);
+	result.z = f32x4_splat(v.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_load(Vector3* ptr) {
+	Vector3x4 result;
+	f32x4_load_xyz4(ptr->data, &result.x, &result.y, &result.z);
+	return result;
+}
+
+internal void vector3x4_store(Vector3* ptr, Vector3x4 v) {
+	f32x4_store_xyz4(ptr->data, v.x, v.y, v.z);
+}
+
+internal Vector3x4 vector3x4_load_soa(Vector3_SoA soa, u64 index) {
+	Vector3x4 result;
+	result.x = f32x4_load(soa.x + index);
+	result.y = f32x4_load(soa.y + index);
+	result.z = f32x4_load(soa.z + index);
+	return result;
+}
+
+internal void vector3x4_store_soa(Vector3_SoA soa, u64 index, Vector3x4 v) {
+	f32x4_store(soa.x + index, v.x);
+	f32x4_store(soa.y + index, v.y);
+	f32x4_store(soa.z + index, v.z);
+}
+
+internal Vector3 vector3x4_get(Vector3x4 v, u32 lane) {
+	Assert(lane < 4);
+	f32 x[4], y[4], z[4];
+	f32x4_store(x, v.x);
+	f32x4_store(y, v.y);
+	f32x4_store(z, v.z);
+	Vector3 result = { x[lane], y[lane], z[lane] };
+	return result;
+}
+
+internal Vector3x4 vector3x4_add(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_add(a.x, b.x);
+	result.y = f32x4_add(a.y, b.y);
+	result.z = f32x4_add(a.z, b.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_sub(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_sub(a.x, b.x);
+	result.y = f32x4_sub(a.y, b.y);
+	result.z = f32x4_sub(a.z, b.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_mul(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_mul(a.x, b.x);
+	result.y = f32x4_mul(a.y, b.y);
+	result.z = f32x4_mul(a.z, b.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_scale(Vector3x4 v, f32x4 scalar) {
+	Vector3x4 result;
+	result.x = f32x4_mul(v.x, scalar);
+	result.y = f32x4_mul(v.y, scalar);
+	result.z = f32x4_mul(v.z, scalar);
+	return result;
+}
+
+internal Vector3x4 vector3x4_min(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_min(a.x, b.x);
+	result.y = f32x4_min(a.y, b.y);
+	result.z = f32x4_min(a.z, b.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_max(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_max(a.x, b.x);
+	result.y = f32x4_max(a.y, b.y);
+	result.z = f32x4_max(a.z, b.z);
+	return result;
+}
+
+internal f32x4 vector3x4_dot(Vector3x4 a, Vector3x4 b) {
+	f32x4 result = f32x4_madd(a.x, b.x, f32x4_madd(a.y, b.y, f32x4_mul(a.z, b.z)));
+	return result;
+}
+
+internal Vector3x4 vector3x4_cross(Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_sub(f32x4_mul(a.y, b.z), f32x4_mul(a.z, b.y));
+	result.y = f32x4_sub(f32x4_mul(a.z, b.x), f32x4_mul(a.x, b.z));
+	result.z = f32x4_sub(f32x4_mul(a.x, b.y), f32x4_mul(a.y, b.x));
+	return result;
+}
+
+internal f32x4 vector3x4_length(Vector3x4 v) {
+	f32x4 result = f32x4_sqrt(vector3x4_dot(v, v));
+	return result;
+}
+
+internal Vector3x4 vector3x4_normalize(Vector3x4 v) {
+	f32x4 length = vector3x4_length(v);
+	f32x4 inverse_length = f32x4_div(f32x4_splat(1.0f), length);
+	Vector3x4 result = vector3x4_select(f32x4_cmp_gt(length, f32x4_zero()), vector3x4_scale(v, inverse_length), v);
+	return result;
+}
+
+internal Vector3x4 vector3x4_normalize_fast(Vector3x4 v) {
+	f32x4 length_squared = vector3x4_dot(v, v);
+	Vector3x4 result = vector3x4_select(f32x4_cmp_gt(length_squared, f32x4_zero()), vector3x4_scale(v, f32x4_fast_rsqrt(length_squared)), v);
+	return result;
+}
+
+internal Vector3x4 vector3x4_lerp(Vector3x4 a, Vector3x4 b, f32x4 t) {
+	Vector3x4 result;
+	result.x = f32x4_madd(t, f32x4_sub(b.x, a.x), a.x);
+	result.y = f32x4_madd(t, f32x4_sub(b.y, a.y), a.y);
+	result.z = f32x4_madd(t, f32x4_sub(b.z, a.z), a.z);
+	return result;
+}
+
+internal Vector3x4 vector3x4_select(f32x4 mask, Vector3x4 a, Vector3x4 b) {
+	Vector3x4 result;
+	result.x = f32x4_select(mask, a.x, b.x);
+	result.y = f32x4_select(mask, a.y, b.y);
+	result.z = f32x4_select(mask, a.z, b.z);
+	return result;
+}
+
+/* Row r of the matrix lives at m->m[r*4 .. r*4 + 3] */
+internal Vector3x4 mul_vector3x4_matrix4x4(Vector3x4 v, Matrix4x4* m) {
+	f32x4* e = m->m;
+	Vector3x4 result;
+	result.x = f32x4_madd(e[0], v.x, f32x4_madd(e[1], v.y, f32x4_madd(e[2],  v.z, e[3])));
+	result.y = f32x4_madd(e[4], v.x, f32x4_madd(e[5], v.y, f32x4_madd(e[6],  v.z, e[7])));
+	result.z = f32x4_madd(e[8], v.x, f32x4_madd(e[9], v.y, f32x4_madd(e[10], v.z, e[11])));
+	return result;
+}
+
+internal Vector4x4 vector4x4_splat(Vector4 v) {
+	Vector4x4 result;
+	result.x = f32x4_splat(v.x);
+	result.y = f32x4_splat(v.y);
+	result.z = f32x4_splat(v.z);
+	result.w = f32x4_splat(v.w);
+	return result;
+}
+
+internal Vector4x4 vector4x4_load(Vector4* ptr) {
+	Vector4x4 result;
+	result.x = f32x4_load(ptr[0].data);
+	result.y = f32x4_load(ptr[1].data);
+	result.z = f32x4_load(ptr[2].data);
+	result.w = f32x4_load(ptr[3].data);
+	f32x4_transpose(&result.x, &result.y, &result.z, &result.w);
+	return result;
+}
+
+internal void vector4x4_store(Vector4* ptr, Vector4x4 v) {
+	f32x4_transpose(&v.x, &v.y, &v.z, &v.w);
+	f32x4_store(ptr[0].data, v.x);
+	f32x4_store(ptr[1].data, v.y);
+	f32x4_store(ptr[2].data, v.z);
+	f32x4_store(ptr[3].data, v.w);
+}
+
+internal Vector4 vector4x4_get(Vector4x4 v, u32 lane) {
+	Assert(lane < 4);
+	f32 x[4], y[4], z[4], w[4];
+	f32x4_store(x, v.x);
+	f32x4_store(y, v.y);
+	f32x4_store(z, v.z);
+	f32x4_store(w, v.w);
+	Vector4 result = { x[lane], y[lane], z[lane], w[lane] };
+	return result;
+}
+
+internal Vector4x4 vector4x4_add(Vector4x4 a, Vector4x4 b) {
+	Vector4x4 result;
+	result.x = f32x4_add(a.x, b.x);
+	result.y = f32x4_add(a.y, b.y);
+	result.z = f32x4_add(a.z, b.z);
+	result.w = f32x4_add(a.w, b.w);
+	return result;
+}
+
+internal Vector4x4 vector4x4_sub(Vector4x4 a, Vector4x4 b) {
+	Vector4x4 result;
+	result.x = f32x4_sub(a.x, b.x);
+	result.y = f32x4_sub(a.y, b.y);
+	result.z = f32x4_sub(a.z, b.z);
+	result.w = f32x4_sub(a.w, b.w);
+	return result;
+}
+
+internal Vector4x4 vector4x4_mul(Vector4x4 a, Vector4x4 b) {
+	Vector4x4 result;
+	result.x = f32x4_mul(a.x, b.x);
+	result.y = f32x4_mul(a.y, b.y);
+	result.z = f32x4_mul(a.z, b.z);
+	result.w = f32x4_mul(a.w, b.w);
+	return result;
+}
+
+internal Vector4x4 vector4x4_scale(Vector4x4 v, f32x4 scalar) {
+	Vector4x4 result;
+	result.x = f32x4_mul(v.x, scalar);
+	result.y = f32x4_mul(v.y, scalar);
+	result.z = f32x4_mul(v.z, scalar);
+	result.w = f32x4_mul(v.w, scalar);
+	return result;
+}
+
+internal f32x4 vector4x4_dot(Vector4x4 a, Vector4x4 b) {
+	f32x4 result = f32x4_madd(a.x, b.x, f32x4_madd(a.y, b.y, f32x4_madd(a.z, b.z, f32x4_mul(a.w, b.w))));
+	return result;
+}
+
+internal Vector4x4 vector4x4_normalize(Vector4x4 v) {
+	f32x4 length = f32x4_sqrt(vector4x4_dot(v, v));
+	f32x4 inverse_length = f32x4_div(f32x4_splat(1.0f), length);
+	Vector4x4 result = vector4x4_select(f32x4_cmp_gt(length, f32x4_zero()), vector4x4_scale(v, inverse_length), v);
+	return result;
+}
+
+internal Vector4x4 vector4x4_select(f32x4 mask, Vector4x4 a, Vector4x4 b) {
+	Vector4x4 result;
+	result.x = f32x4_select(mask, a.x, b.x);
+	result.y = f32x4_select(mask, a.y, b.y);
+	result.z = f32x4_select(mask, a.z, b.z);
+	result.w = f32x4_select(mask, a.w, b.w);
+	return result;
+}
+
+internal Vector4x4 mul_vector4x4_matrix4x4(Vector4x4 v, Matrix4x4* m) {
+	f32x4* e = m->m;
+	Vector4x4 result;
+	result.x = f32x4_madd(e[0],  v.x, f32x4_madd(e[1],  v.y, f32x4_madd(e[2],  v.z, f32x4_mul(e[3],  v.w))));
+	result.y = f32x4_madd(e[4],  v.x, f32x4_madd(e[5],  v.y, f32x4_madd(e[6],  v.z, f32x4_mul(e[7],  v.w))));
+	result.z = f32x4_madd(e[8],  v.x, f32x4_madd(e[9],  v.y, f32x4_madd(e[10], v.z, f32x4_mul(e[11], v.w))));
+	result.w = f32x4_madd(e[12], v.x, f32x4_madd(e[13], v.y, f32x4_madd(e[14], v.z, f32x4_mul(e[15], v.w))));
+	return result;
+}
+
+internal Matrix4x4 matrix4x4_from_matrix4(Matrix4 m) {
+	Matrix4x4 result;
+	f32* elements = &m.data[0][0];
+	for (u32 i = 0; i < 16; i += 1) {
+		result.m[i] = f32x4_splat(elements[i]);
+	}
+	return result;
+}
+
+internal Vector3x8 vector3x8_splat(Vector3 v) {
+	Vector3x8 result;
+	result.x = f32x8_splat(v.x);
+	result.y = f32x8_splat(v.y);
+	result.z = f32x8_splat(v.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_load(Vector3* ptr) {
+	Vector3x8 result;
+	f32x8_load_xyz8(ptr->data, &result.x, &result.y, &result.z);
+	return result;
+}
+
+internal void vector3x8_store(Vector3* ptr, Vector3x8 v) {
+	f32x8_store_xyz8(ptr->data, v.x, v.y, v.z);
+}
+
+internal Vector3x8 vector3x8_load_soa(Vector3_SoA soa, u64 index) {
+	Vector3x8 result;
+	result.x = f32x8_load(soa.x + index);
+	result.y = f32x8_load(soa.y + index);
+	result.z = f32x8_load(soa.z + index);
+	return result;
+}
+
+internal void vector3x8_store_soa(Vector3_SoA soa, u64 index, Vector3x8 v) {
+	f32x8_store(soa.x + index, v.x);
+	f32x8_store(soa.y + index, v.y);
+	f32x8_store(soa.z + index, v.z);
+}
+
+internal Vector3 vector3x8_get(Vector3x8 v, u32 lane) {
+	Assert(lane < 8);
+	f32 x[8], y[8], z[8];
+	f32x8_store(x, v.x);
+	f32x8_store(y, v.y);
+	f32x8_store(z, v.z);
+	Vector3 result = { x[lane], y[lane], z[lane] };
+	return result;
+}
+
+internal Vector3x8 vector3x8_add(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_add(a.x, b.x);
+	result.y = f32x8_add(a.y, b.y);
+	result.z = f32x8_add(a.z, b.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_sub(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_sub(a.x, b.x);
+	result.y = f32x8_sub(a.y, b.y);
+	result.z = f32x8_sub(a.z, b.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_mul(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_mul(a.x, b.x);
+	result.y = f32x8_mul(a.y, b.y);
+	result.z = f32x8_mul(a.z, b.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_scale(Vector3x8 v, f32x8 scalar) {
+	Vector3x8 result;
+	result.x = f32x8_mul(v.x, scalar);
+	result.y = f32x8_mul(v.y, scalar);
+	result.z = f32x8_mul(v.z, scalar);
+	return result;
+}
+
+internal Vector3x8 vector3x8_min(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_min(a.x, b.x);
+	result.y = f32x8_min(a.y, b.y);
+	result.z = f32x8_min(a.z, b.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_max(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_max(a.x, b.x);
+	result.y = f32x8_max(a.y, b.y);
+	result.z = f32x8_max(a.z, b.z);
+	return result;
+}
+
+internal f32x8 vector3x8_dot(Vector3x8 a, Vector3x8 b) {
+	f32x8 result = f32x8_madd(a.x, b.x, f32x8_madd(a.y, b.y, f32x8_mul(a.z, b.z)));
+	return result;
+}
+
+internal Vector3x8 vector3x8_cross(Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_sub(f32x8_mul(a.y, b.z), f32x8_mul(a.z, b.y));
+	result.y = f32x8_sub(f32x8_mul(a.z, b.x), f32x8_mul(a.x, b.z));
+	result.z = f32x8_sub(f32x8_mul(a.x, b.y), f32x8_mul(a.y, b.x));
+	return result;
+}
+
+internal f32x8 vector3x8_length(Vector3x8 v) {
+	f32x8 result = f32x8_sqrt(vector3x8_dot(v, v));
+	return result;
+}
+
+internal Vector3x8 vector3x8_normalize(Vector3x8 v) {
+	f32x8 length = vector3x8_length(v);
+	f32x8 inverse_length = f32x8_div(f32x8_splat(1.0f), length);
+	Vector3x8 result = vector3x8_select(f32x8_cmp_gt(length, f32x8_zero()), vector3x8_scale(v, inverse_length), v);
+	return result;
+}
+
+internal Vector3x8 vector3x8_normalize_fast(Vector3x8 v) {
+	f32x8 length_squared = vector3x8_dot(v, v);
+	Vector3x8 result = vector3x8_select(f32x8_cmp_gt(length_squared, f32x8_zero()), vector3x8_scale(v, f32x8_fast_rsqrt(length_squared)), v);
+	return result;
+}
+
+internal Vector3x8 vector3x8_lerp(Vector3x8 a, Vector3x8 b, f32x8 t) {
+	Vector3x8 result;
+	result.x = f32x8_madd(t, f32x8_sub(b.x, a.x), a.x);
+	result.y = f32x8_madd(t, f32x8_sub(b.y, a.y), a.y);
+	result.z = f32x8_madd(t, f32x8_sub(b.z, a.z), a.z);
+	return result;
+}
+
+internal Vector3x8 vector3x8_select(f32x8 mask, Vector3x8 a, Vector3x8 b) {
+	Vector3x8 result;
+	result.x = f32x8_select(mask, a.x, b.x);
+	result.y = f32x8_select(mask, a.y, b.y);
+	result.z = f32x8_select(mask, a.z, b.z);
+	return result;
+}
+
+/* Row r of the matrix lives at m->m[r*4 .. r*4 + 3] */
+internal Vector3x8 mul_vector3x8_matrix4x8(Vector3x8 v, Matrix4x8* m) {
+	f32x8* e = m->m;
+	Vector3x8 result;
+	result.x = f32x8_madd(e[0], v.x, f32x8_madd(e[1], v.y, f32x8_madd(e[2],  v.z, e[3])));
+	result.y = f32x8_madd(e[4], v.x, f32x8_madd(e[5], v.y, f32x8_madd(e[6],  v.z, e[7])));
+	result.z = f32x8_madd(e[8], v.x, f32x8_madd(e[9], v.y, f32x8_madd(e[10], v.z, e[11])));
+	return result;
+}
+
+internal Vector4x8 vector4x8_splat(Vector4 v) {
+	Vector4x8 result;
+	result.x = f32x8_splat(v.x);
+	result.y = f32x8_splat(v.y);
+	result.z = f32x8_splat(v.z);
+	result.w = f32x8_splat(v.w);
+	return result;
+}
+
+internal Vector4x8 vector4x8_load(Vector4* ptr) {
+	Vector4x4 lo = vector4x4_load(ptr);
+	Vector4x4 hi = vector4x4_load(ptr + 4);
+	Vector4x8 result;
+	result.x = f32x8_from_f32x4(lo.x, hi.x);
+	result.y = f32x8_from_f32x4(lo.y, hi.y);
+	result.z = f32x8_from_f32x4(lo.z, hi.z);
+	result.w = f32x8_from_f32x4(lo.w, hi.w);
+	return result;
+}
+
+internal void vector4x8_store(Vector4* ptr, Vector4x8 v) {
+	Vector4x4 lo = { f32x8_lo(v.x), f32x8_lo(v.y), f32x8_lo(v.z), f32x8_lo(v.w) };
+	Vector4x4 hi = { f32x8_hi(v.x), f32x8_hi(v.y), f32x8_hi(v.z), f32x8_hi(v.w) };
+	vector4x4_store(ptr,     lo);
+	vector4x4_store(ptr + 4, hi);
+}
+
+internal Vector4 vector4x8_get(Vector4x8 v, u32 lane) {
+	Assert(lane < 8);
+	f32 x[8], y[8], z[8], w[8];
+	f32x8_store(x, v.x);
+	f32x8_store(y, v.y);
+	f32x8_store(z, v.z);
+	f32x8_store(w, v.w);
+	Vector4 result = { x[lane], y[lane], z[lane], w[lane] };
+	return result;
+}
+
+internal Vector4x8 vector4x8_add(Vector4x8 a, Vector4x8 b) {
+	Vector4x8 result;
+	result.x = f32x8_add(a.x, b.x);
+	result.y = f32x8_add(a.y, b.y);
+	result.z = f32x8_add(a.z, b.z);
+	result.w = f32x8_add(a.w, b.w);
+	return result;
+}
+
+internal Vector4x8 vector4x8_sub(Vector4x8 a, Vector4x8 b) {
+	Vector4x8 result;
+	result.x = f32x8_sub(a.x, b.x);
+	result.y = f32x8_sub(a.y, b.y);
+	result.z = f32x8_sub(a.z, b.z);
+	result.w = f32x8_sub(a.w, b.w);
+	return result;
+}
+
+internal Vector4x8 vector4x8_mul(Vector4x8 a, Vector4x8 b) {
+	Vector4x8 result;
+	result.x = f32x8_mul(a.x, b.x);
+	result.y = f32x8_mul(a.y, b.y);
+	result.z = f32x8_mul(a.z, b.z);
+	result.w = f32x8_mul(a.w, b.w);
+	return result;
+}
+
+internal Vector4x8 vector4x8_scale(Vector4x8 v, f32x8 scalar) {
+	Vector4x8 result;
+	result.x = f32x8_mul(v.x, scalar);
+	result.y = f32x8_mul(v.y, scalar);
+	result.z = f32x8_mul(v.z, scalar);
+	result.w = f32x8_mul(v.w, scalar);
+	return result;
+}
+
+internal f32x8 vector4x8_dot(Vector4x8 a, Vector4x8 b) {
+	f32x8 result = f32x8_madd(a.x, b.x, f32x8_madd(a.y, b.y, f32x8_madd(a.z, b.z, f32x8_mul(a.w, b.w))));
+	return result;
+}
+
+internal Vector4x8 vector4x8_normalize(Vector4x8 v) {
+	f32x8 length = f32x8_sqrt(vector4x8_dot(v, v));
+	f32x8 inverse_length = f32x8_div(f32x8_splat(1.0f), length);
+	Vector4x8 result = vector4x8_select(f32x8_cmp_gt(length, f32x8_zero()), vector4x8_scale(v, inverse_length), v);
+	return result;
+}
+
+internal Vector4x8 vector4x8_select(f32x8 mask, Vector4x8 a, Vector4x8 b) {
+	Vector4x8 result;
+	result.x = f32x8_select(mask, a.x, b.x);
+	result.y = f32x8_select(mask, a.y, b.y);
+	result.z = f32x8_select(mask, a.z, b.z);
+	result.w = f32x8_select(mask, a.w, b.w);
+	return result;
+}
+
+internal Vector4x8 mul_vector4x8_matrix4x8(Vector4x8 v, Matrix4x8* m) {
+	f32x8* e = m->m;
+	Vector4x8 result;
+	result.x = f32x8_madd(e[0],  v.x, f32x8_madd(e[1],  v.y, f32x8_madd(e[2],  v.z, f32x8_mul(e[3],  v.w))));
+	result.y = f32x8_madd(e[4],  v.x, f32x8_madd(e[5],  v.y, f32x8_madd(e[6],  v.z, f32x8_mul(e[7],  v.w))));
+	result.z = f32x8_madd(e[8],  v.x, f32x8_madd(e[9],  v.y, f32x8_madd(e[10], v.z, f32x8_mul(e[11], v.w))));
+	result.w = f32x8_madd(e[12], v.x, f32x8_madd(e[13], v.y, f32x8_madd(e[14], v.z, f32x8_mul(e[15], v.w))));
+	return result;
+}
+
+internal Matrix4x8 matrix4x8_from_matrix4(Matrix4 m) {
+	Matrix4x8 result;
+	f32* elements = &m.data[0][0];
+	for (u32 i = 0; i < 16; i += 1) {
+		result.m[i] = f32x8_splat(elements[i]);
+	}
+	return result;
+}
+
+//////////////////////////////////////////////
+// Ray intersection
+
+internal b32 intersect_ray_with_triangle(Ray ray, Vector3 a, Vector3 b, Vector3 c, Ray_Hit* hit) {
+	b32 result = 0;
+	Vector3 edge1 = sub(b, a);
+	Vector3 edge2 = sub(c, a);
+	Vector3 p = vector3_cross(ray.direction, edge2);
+	f32 determinant = vector3_dot(edge1, p);
+	if (fabsf(determinant) > RAY_EPSILON) {
+		f32 inverse_determinant = 1.0f/determinant;
+		Vector3 s = sub(ray.point, a);
+		f32 u = vector3_dot(s, p)*inverse_determinant;
+		Vector3 q = vector3_cross(s, edge1);
+		f32 v = vector3_dot(ray.direction, q)*inverse_determinant;
+		f32 t = vector3_dot(edge2, q)*inverse_determinant;
+		if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > RAY_EPSILON) {
+			hit->hit = 1;
+			hit->t   = t;
+			hit->u   = u;
+			hit->v   = v;
+			result   = 1;
+		}
+	}
+	return result;
+}
+
+/* A zero direction component with the origin exactly on that slab's plane gives 0*inf = NaN. The ray then runs
+ * inside the slab's boundary, so the plane distance becomes unbounded instead: -F32_MAX for min, F32_MAX for max. */
+internal f32x4 _ray_slab_distance(f32x4 t, f32 unbounded) {
+	f32x4 result = f32x4_select(f32x4_cmp_eq(t, t), t, f32x4_splat(unbounded));
+	return result;
+}
+
+internal b32 intersect_ray_with_aabb(Ray ray, Vector3 min, Vector3 max, f32* t) {
+	f32x4 inverse_direction = f32x4_div(f32x4_splat(1.0f), _f32x4_from_vector3(ray.direction, 1.0f));
+	f32x4 point = _f32x4_from_vector3(ray.point, 0.0f);
+	f32x4 t0 = _ray_slab_distance(f32x4_mul(f32x4_sub(_f32x4_from_vector3(min, 0.0f), point), inverse_direction), -F32_MAX);
+	f32x4 t1 = _ray_slab_distance(f32x4_mul(f32x4_sub(_f32x4_from_vector3(max, 0.0f), point), inverse_direction),  F32_MAX);
+	f32 near_t[4], far_t[4];
+	f32x4_store(near_t, f32x4_min(t0, t1));
+	f32x4_store(far_t,  f32x4_max(t0, t1));
+	f32 enter = Max(Max(near_t[0], near_t[1]), Max(near_t[2], 0.0f));
+	f32 leave = Min(Min(far_t[0], far_t[1]), far_t[2]);
+	b32 result = (enter <= leave);
+	*t = result? enter : F32_MAX;
+	return result;
+}
+
+/* Moller-Trumbore on 4 lanes, any mix of splat and per-lane inputs */
+internal f32x4 _intersect_ray_triangle_x4(Vector3x4 point, Vector3x4 direction, Vector3x4 a, Vector3x4 b, Vector3x4 c, f32x4* t) {
+	Vector3x4 edge1 = vector3x4_sub(b, a);
+	Vector3x4 edge2 = vector3x4_sub(c, a);
+	Vector3x4 p     = vector3x4_cross(direction, edge2);
+	f32x4 determinant         = vector3x4_dot(edge1, p);
+	f32x4 inverse_determinant = f32x4_div(f32x4_splat(1.0f), determinant);
+
+	Vector3x4 s = vector3x4_sub(point, a);
+	f32x4 u = f32x4_mul(vector3x4_dot(s, p), inverse_determinant);
+	Vector3x4 q = vector3x4_cross(s, edge1);
+	f32x4 v = f32x4_mul(vector3x4_dot(direction, q), inverse_determinant);
+	f32x4 distance = f32x4_mul(vector3x4_dot(edge2, q), inverse_determinant);
+
+	f32x4 zero = f32x4_zero();
+	f32x4 mask = f32x4_cmp_gt(f32x4_abs(determinant), f32x4_splat(RAY_EPSILON));
+	mask = f32x4_and(mask, f32x4_cmp_ge(u, zero));
+	mask = f32x4_and(mask, f32x4_cmp_ge(v, zero));
+	mask = f32x4_and(mask, f32x4_cmp_le(f32x4_add(u, v), f32x4_splat(1.0f)));
+	mask = f32x4_and(mask, f32x4_cmp_gt(distance, f32x4_splat(RAY_EPSILON)));
+	*t = f32x4_select(mask, distance, f32x4_splat(F32_MAX));
+	return mask;
+}
+
+/* Slab test. Returns the entry distance, or 0 when the origin is inside the box */
+internal f32x4 _intersect_ray_aabb_x4(Vector3x4 point, Vector3x4 inverse_direction, Vector3x4 min, Vector3x4 max, f32x4* t) {
+	Vector3x4 t0 = vector3x4_mul(vector3x4_sub(min, point), inverse_direction);
+	Vector3x4 t1 = vector3x4_mul(vector3x4_sub(max, point), inverse_direction);
+	t0.x = _ray_slab_distance(t0.x, -F32_MAX);
+	t0.y = _ray_slab_distance(t0.y, -F32_MAX);
+	t0.z = _ray_slab_distance(t0.z, -F32_MAX);
+	t1.x = _ray_slab_distance(t1.x,  F32_MAX);
+	t1.y = _ray_slab_distance(t1.y,  F32_MAX);
+	t1.z = _ray_slab_distance(t1.z,  F32_MAX);
+	Vector3x4 near_t = vector3x4_min(t0, t1);
+	Vector3x4 far_t  = vector3x4_max(t0, t1);
+	f32x4 enter = f32x4_max(f32x4_max(near_t.x, near_t.y), f32x4_max(near_t.z, f32x4_zero()));
+	f32x4 leave = f32x4_min(f32x4_min(far_t.x, far_t.y), far_t.z);
+	f32x4 mask  = f32x4_cmp_le(enter, leave);
+	*t = f32x4_select(mask, enter, f32x4_splat(F32_MAX));
+	return mask;
+}
+
+internal f32x4 intersect_ray_with_triangle_x4(Ray ray, Vector3x4 a, Vector3x4 b, Vector3x4 c, f32x4* t) {
+	f32x4 result = _intersect_ray_triangle_x4(vector3x4_splat(ray.point), vector3x4_splat(ray.direction), a, b, c, t);
+	return result;
+}
+
+internal f32x4 intersect_ray_with_aabb_x4(Ray ray, Vector3x4 min, Vector3x4 max, f32x4* t) {
+	Vector3 inverse_direction = vector3(1.0f/ray.direction.x, 1.0f/ray.direction.y, 1.0f/ray.direction.z);
+	f32x4 result = _intersect_ray_aabb_x4(vector3x4_splat(ray.point), vector3x4_splat(inverse_direction), min, max, t);
+	return result;
+}
+
+internal f32x4 intersect_rayx4_with_triangle(Rayx4 rays, Vector3 a, Vector3 b, Vector3 c, f32x4* t) {
+	f32x4 result = _intersect_ray_triangle_x4(rays.point, rays.direction, vector3x4_splat(a), vector3x4_splat(b), vector3x4_splat(c), t);
+	return result;
+}
+
+internal f32x4 intersect_rayx4_with_aabb(Rayx4 rays, Vector3 min, Vector3 max, f32x4* t) {
+	f32x4 one = f32x4_splat(1.0f);
+	Vector3x4 inverse_direction;
+	inverse_direction.x = f32x4_div(one, rays.direction.x);
+	inverse_direction.y = f32x4_div(one, rays.direction.y);
+	inverse_direction.z = f32x4_div(one, rays.direction.z);
+	f32x4 result = _intersect_ray_aabb_x4(rays.point, inverse_direction, vector3x4_splat(min), vector3x4_splat(max), t);
+	return result;
+}
+
+/* Moller-Trumbore on 8 lanes, any mix of splat and per-lane inputs */
+internal f32x8 _intersect_ray_triangle_x8(Vector3x8 point, Vector3x8 direction, Vector3x8 a, Vector3x8 b, Vector3x8 c, f32x8* t) {
+	Vector3x8 edge1 = vector3x8_sub(b, a);
+	Vector3x8 edge2 = vector3x8_sub(c, a);
+	Vector3x8 p     = vector3x8_cross(direction, edge2);
+	f32x8 determinant         = vector3x8_dot(edge1, p);
+	f32x8 inverse_determinant = f32x8_div(f32x8_splat(1.0f), determinant);
+
+	Vector3x8 s = vector3x8_sub(point, a);
+	f32x8 u = f32x8_mul(vector3x8_dot(s, p), inverse_determinant);
+	Vector3x8 q = vector3x8_cross(s, edge1);
+	f32x8 v = f32x8_mul(vector3x8_dot(direction, q), inverse_determinant);
+	f32x8 distance = f32x8_mul(vector3x8_dot(edge2, q), inverse_determinant);
+
+	f32x8 zero = f32x8_zero();
+	f32x8 mask = f32x8_cmp_gt(f32x8_abs(determinant), f32x8_splat(RAY_EPSILON));
+	mask = f32x8_and(mask, f32x8_cmp_ge(u, zero));
+	mask = f32x8_and(mask, f32x8_cmp_ge(v, zero));
+	mask = f32x8_and(mask, f32x8_cmp_le(f32x8_add(u, v), f32x8_splat(1.0f)));
+	mask = f32x8_and(mask, f32x8_cmp_gt(distance, f32x8_splat(RAY_EPSILON)));
+	*t = f32x8_select(mask, distance, f32x8_splat(F32_MAX));
+	return mask;
+}
+
+/* _ray_slab_distance, 8 wide */
+internal f32x8 _ray_slab_distance_x8(f32x8 t, f32 unbounded) {
+	f32x8 result = f32x8_select(f32x8_cmp_eq(t, t), t, f32x8_splat(unbounded));
+	return result;
+}
+
+/* Slab test. Returns the entry distance, or 0 when the origin is inside the box */
+internal f32x8 _intersect_ray_aabb_x8(Vector3x8 point, Vector3x8 inverse_direction, Vector3x8 min, Vector3x8 max, f32x8* t) {
+	Vector3x8 t0 = vector3x8_mul(vector3x8_sub(min, point), inverse_direction);
+	Vector3x8 t1 = vector3x8_mul(vector3x8_sub(max, point), inverse_direction);
+	t0.x = _ray_slab_distance_x8(t0.x, -F32_MAX);
+	t0.y = _ray_slab_distance_x8(t0.y, -F32_MAX);
+	t0.z = _ray_slab_distance_x8(t0.z, -F32_MAX);
+	t1.x = _ray_slab_distance_x8(t1.x,  F32_MAX);
+	t1.y = _ray_slab_distance_x8(t1.y,  F32_MAX);
+	t1.z = _ray_slab_distance_x8(t1.z,  F32_MAX);
+	Vector3x8 near_t = vector3x8_min(t0, t1);
+	Vector3x8 far_t  = vector3x8_max(t0, t1);
+	f32x8 enter = f32x8_max(f32x8_max(near_t.x, near_t.y), f32x8_max(near_t.z, f32x8_zero()));
+	f32x8 leave = f32x8_min(f32x8_min(far_t.x, far_t.y), far_t.z);
+	f32x8 mask  = f32x8_cmp_le(enter, leave);
+	*t = f32x8_select(mask, enter, f32x8_splat(F32_MAX));
+	return mask;
+}
+
+internal f32x8 intersect_ray_with_triangle_x8(Ray ray, Vector3x8 a, Vector3x8 b, Vector3x8 c, f32x8* t) {
+	f32x8 result = _intersect_ray_triangle_x8(vector3x8_splat(ray.point), vector3x8_splat(ray.direction), a, b, c, t);
+	return result;
+}
+
+internal f32x8 intersect_ray_with_aabb_x8(Ray ray, Vector3x8 min, Vector3x8 max, f32x8* t) {
+	Vector3 inverse_direction = vector3(1.0f/ray.direction.x, 1.0f/ray.direction.y, 1.0f/ray.direction.z);
+	f32x8 result = _intersect_ray_aabb_x8(vector3x8_splat(ray.point), vector3x8_splat(inverse_direction), min, max, t);
+	return result;
+}
+
+internal f32x8 intersect_rayx8_with_triangle(Rayx8 rays, Vector3 a, Vector3 b, Vector3 c, f32x8* t) {
+	f32x8 result = _intersect_ray_triangle_x8(rays.point, rays.direction, vector3x8_splat(a), vector3x8_splat(b), vector3x8_splat(c), t);
+	return result;
+}
+
+internal f32x8 intersect_rayx8_with_aabb(Rayx8 rays, Vector3 min, Vector3 max, f32x8* t) {
+	f32x8 one = f32x8_splat(1.0f);
+	Vector3x8 inverse_direction;
+	inverse_direction.x = f32x8_div(one, rays.direction.x);
+	inverse_direction.y = f32x8_div(one, rays.direction.y);
+	inverse_direction.z = f32x8_div(one, rays.direction.z);
+	f32x8 result = _intersect_ray_aabb_x8(rays.point, inverse_direction, vector3x8_splat(min), vector3x8_splat(max), t);
+	return result;
+}
+
+internal Vector3 _triangle_list_corner(Vector3* vertices, u32* indices, u64 triangle, u32 corner) {
+	u64 index = triangle*3 + corner;
+	return vertices[indices ? indices[index] : index];
+}
+
+internal Ray_Hit intersect_ray_with_triangle_list(Ray ray, Vector3* vertices, u32* indices, u64 triangle_count) {
+	Ray_Hit result = { 0 };
+	result.t = F32_MAX;
+
+	Vector3x8 point     = vector3x8_splat(ray.point);
+	Vector3x8 direction = vector3x8_splat(ray.direction);
+	f32x8 closest = f32x8_splat(F32_MAX);
+
+	// NOTE(fz): Gather 8 triangles into SoA. Lanes only get scanned when one beats the closest hit so far.
+	u64 i = 0;
+	for (; i + 8 <= triangle_count; i += 8) {
+		f32 corners[3][3][8];
+		for (u32 lane = 0; lane < 8; lane += 1) {
+			for (u32 corner = 0; corner < 3; corner += 1) {
+				Vector3 v = _triangle_list_corner(vertices, indices, i + lane, corner);
+				corners[corner][0][lane] = v.x;
+				corners[corner][1][lane] = v.y;
+				corners[corner][2][lane] = v.z;
+			}
+		}
+		Vector3x8 a = { f32x8_load(corners[0][0]), f32x8_load(corners[0][1]), f32x8_load(corners[0][2]) };
+		Vector3x8 b = { f32x8_load(corners[1][0]), f32x8_load(corners[1][1]), f32x8_load(corners[1][2]) };
+		Vector3x8 c = { f32x8_load(corners[2][0]), f32x8_load(corners[2][1]), f32x8_load(corners[2][2]) };
+
+		f32x8 t;
+		f32x8 mask = _intersect_ray_triangle_x8(point, direction, a, b, c, &t);
+		if (f32x8_mask_bits(f32x8_and(mask, f32x8_cmp_lt(t, closest))) != 0) {
+			f32 lanes[8];
+			f32x8_store(lanes, t);
+			for (u32 lane = 0; lane < 8; lane += 1) {
+				if (lanes[lane] < result.t) {
+					result.t     = lanes[lane];
+					result.index = i + lane;
+				}
+			}
+			closest = f32x8_splat(result.t);
+		}
+	}
+
+	for (; i < triangle_count; i += 1) {
+		Ray_Hit hit = { 0 };
+		Vector3 a = _triangle_list_corner(vertices, indices, i, 0);
+		Vector3 b = _triangle_list_corner(vertices, indices, i, 1);
+		Vector3 c = _triangle_list_corner(vertices, indices, i, 2);
+		if (intersect_ray_with_triangle(ray, a, b, c, &hit) && hit.t < result.t) {
+			result.t     = hit.t;
+			result.index = i;
+		}
+	}
+
+	if (result.t != F32_MAX) {
+		// Barycentrics for the winner only
+		Vector3 a = _triangle_list_corner(vertices, indices, result.index, 0);
+		Vector3 b = _triangle_list_corner(vertices, indices, result.index, 1);
+		Vector3 c = _triangle_list_corner(vertices, indices, result.index, 2);
+		Ray_Hit hit = { 0 };
+		intersect_ray_with_triangle(ray, a, b, c, &hit);
+		result.hit = 1;
+		result.u   = hit.u;
+		result.v   = hit.v;
+	}
+	return result;
+}
+
+//////////////////////////////////////////////
+// Bounds and culling
+
+internal AABB aabb_from_points(Vector3* points, u64 count) {
+	AABB result = { vector3(F32_MAX, F32_MAX, F32_MAX), vector3(-F32_MAX, -F32_MAX, -F32_MAX) };
+	Vector3x8 min = vector3x8_splat(result.min);
+	Vector3x8 max = vector3x8_splat(result.max);
+	u64 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		Vector3x8 v = vector3x8_load(points + i);
+		min = vector3x8_min(min, v);
+		max = vector3x8_max(max, v);
+	}
+	for (u32 lane = 0; lane < 8; lane += 1) {
+		Vector3 lane_min = vector3x8_get(min, lane);
+		Vector3 lane_max = vector3x8_get(max, lane);
+		result.min = vector3(Min(result.min.x, lane_min.x), Min(result.min.y, lane_min.y), Min(result.min.z, lane_min.z));
+		result.max = vector3(Max(result.max.x, lane_max.x), Max(result.max.y, lane_max.y), Max(result.max.z, lane_max.z));
+	}
+	for (; i < count; i += 1) {
+		Vector3 p  = points[i];
+		result.min = vector3(Min(result.min.x, p.x), Min(result.min.y, p.y), Min(result.min.z, p.z));
+		result.max = vector3(Max(result.max.x, p.x), Max(result.max.y, p.y), Max(result.max.z, p.z));
+	}
+	return result;
+}
+
+internal AABB aabb_union(AABB a, AABB b) {
+	AABB result;
+	result.min = vector3(Min(a.min.x, b.min.x), Min(a.min.y, b.min.y), Min(a.min.z, b.min.z));
+	result.max = vector3(Max(a.max.x, b.max.x), Max(a.max.y, b.max.y), Max(a.max.z, b.max.z));
+	return result;
+}
+
+internal b32 aabb_is_empty(AABB box) {
+	b32 result = (box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z);
+	return result;
+}
+
+internal AABB aabb_transform(AABB box, Matrix4 m) {
+	AABB result = box;
+	if (!aabb_is_empty(box)) {
+		// NOTE(fz): Arvo. New center is m*center, new extent is |rotation/scale part|*extent.
+		Vector3 center = vector3_scale(vector3_add(box.min, box.max), 0.5f);
+		Vector3 extent = vector3_scale(sub(box.max, box.min), 0.5f);
+		Vector3 new_center = mul_vector3_matrix4(center, m);
+		Vector3 new_extent = {
+			fabsf(m.data[0][0])*extent.x + fabsf(m.data[0][1])*extent.y + fabsf(m.data[0][2])*extent.z,
+			fabsf(m.data[1][0])*extent.x + fabsf(m.data[1][1])*extent.y + fabsf(m.data[1][2])*extent.z,
+			fabsf(m.data[2][0])*extent.x + fabsf(m.data[2][1])*extent.y + fabsf(m.data[2][2])*extent.z
+		};
+		result.min = sub(new_center, new_extent);
+		result.max = vector3_add(new_center, new_extent);
+	}
+	return result;
+}
+
+internal Frustum frustum_from_matrix4(Matrix4 view_projection) {
+	// NOTE(fz): Gribb/Hartmann. Clip space is view_projection*p, so the planes are sums of its rows.
+	// OpenGL depth range, near is -w <= z.
+	Frustum result = { 0 };
+	f32x4 r0 = f32x4_load(view_projection.data[0]);
+	f32x4 r1 = f32x4_load(view_projection.data[1]);
+	f32x4 r2 = f32x4_load(view_projection.data[2]);
+	f32x4 r3 = f32x4_load(view_projection.data[3]);
+	f32x4 planes[FrustumPlane_Count];
+	planes[FrustumPlane_Left]   = f32x4_add(r3, r0);
+	planes[FrustumPlane_Right]  = f32x4_sub(r3, r0);
+	planes[FrustumPlane_Bottom] = f32x4_add(r3, r1);
+	planes[FrustumPlane_Top]    = f32x4_sub(r3, r1);
+	planes[FrustumPlane_Near]   = f32x4_add(r3, r2);
+	planes[FrustumPlane_Far]    = f32x4_sub(r3, r2);
+	for (u32 i = 0; i < FrustumPlane_Count; i += 1) {
+		f32x4 normal = f32x4_mul(planes[i], f32x4_set(1.0f, 1.0f, 1.0f, 0.0f));
+		f32 length   = sqrtf(f32x4_first(f32x4_dot(normal, normal)));
+		f32x4_store(result.planes[i].data, f32x4_mul(planes[i], f32x4_splat(1.0f/length)));
+	}
+	return result;
+}
+
+internal b32 frustum_intersects_aabb(Frustum* frustum, Vector3 center, Vector3 extent) {
+	b32 result = 1;
+	for (u32 i = 0; i < FrustumPlane_Count && result; i += 1) {
+		Vector4 plane = frustum->planes[i];
+		f32 distance = plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w;
+		f32 radius   = fabsf(plane.x)*extent.x + fabsf(plane.y)*extent.y + fabsf(plane.z)*extent.z;
+		result = (distance + radius >= 0.0f);
+	}
+	return result;
+}
+
+internal b32 frustum_intersects_sphere(Frustum* frustum, Vector3 center, f32 radius) {
+	b32 result = 1;
+	for (u32 i = 0; i < FrustumPlane_Count && result; i += 1) {
+		Vector4 plane = frustum->planes[i];
+		f32 distance = plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w;
+		result = (distance + radius >= 0.0f);
+	}
+	return result;
+}
+
+/* Writes first + lane for every set bit of the 8 lane mask. Branch free, visible needs room for 8 */
+internal u64 _cull_write_visible(u32 mask, u64 first, u32* visible) {
+	u64 result = 0;
+	for (u32 lane = 0; lane < 8; lane += 1) {
+		visible[result] = (u32)(first + lane);
+		result += (mask >> lane) & 1;
+	}
+	return result;
+}
+
+internal u64 frustum_cull_aabbs(Frustum* frustum, Vector3_SoA centers, Vector3_SoA extents, u64 count, u32* visible) {
+	u64 result = 0;
+	Vector3x8 normals[FrustumPlane_Count];
+	Vector3x8 abs_normals[FrustumPlane_Count];
+	f32x8     ds[FrustumPlane_Count];
+	for (u32 i = 0; i < FrustumPlane_Count; i += 1) {
+		Vector4 plane  = frustum->planes[i];
+		normals[i]     = vector3x8_splat(vector3(plane.x, plane.y, plane.z));
+		abs_normals[i] = vector3x8_splat(vector3(fabsf(plane.x), fabsf(plane.y), fabsf(plane.z)));
+		ds[i]          = f32x8_splat(plane.w);
+	}
+	
+	u64 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		Vector3x8 center = vector3x8_load_soa(centers, i);
+		Vector3x8 extent = vector3x8_load_soa(extents, i);
+		f32x8 inside = f32x8_cmp_eq(f32x8_zero(), f32x8_zero());
+		for (u32 p = 0; p < FrustumPlane_Count; p += 1) {
+			f32x8 distance = f32x8_add(vector3x8_dot(normals[p], center), ds[p]);
+			f32x8 radius   = vector3x8_dot(abs_normals[p], extent);
+			inside = f32x8_and(inside, f32x8_cmp_ge(f32x8_add(distance, radius), f32x8_zero()));
+		}
+		result += _cull_write_visible(f32x8_mask_bits(inside), i, visible + result);
+	}
+	for (; i < count; i += 1) {
+		Vector3 center = vector3(centers.x[i], centers.y[i], centers.z[i]);
+		Vector3 extent = vector3(extents.x[i], extents.y[i], extents.z[i]);
+		if (frustum_intersects_aabb(frustum, center, extent)) {
+			visible[result] = (u32)i;
+			result += 1;
+		}
+	}
+	return result;
+}
+
+internal u64 frustum_cull_spheres(Frustum* frustum, Vector3_SoA centers, f32* radii, u64 count, u32* visible) {
+	u64 result = 0;
+	Vector3x8 normals[FrustumPlane_Count];
+	f32x8     ds[FrustumPlane_Count];
+	for (u32 i = 0; i < FrustumPlane_Count; i += 1) {
+		Vector4 plane = frustum->planes[i];
+		normals[i]    = vector3x8_splat(vector3(plane.x, plane.y, plane.z));
+		ds[i]         = f32x8_splat(plane.w);
+	}
+	
+	u64 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		Vector3x8 center = vector3x8_load_soa(centers, i);
+		f32x8 radius = f32x8_load(radii + i);
+		f32x8 inside = f32x8_cmp_eq(f32x8_zero(), f32x8_zero());
+		for (u32 p = 0; p < FrustumPlane_Count; p += 1) {
+			f32x8 distance = f32x8_add(vector3x8_dot(normals[p], center), ds[p]);
+			inside = f32x8_and(inside, f32x8_cmp_ge(f32x8_add(distance, radius), f32x8_zero()));
+		}
+		result += _cull_write_visible(f32x8_mask_bits(inside), i, visible + result);
+	}
+	for (; i < count; i += 1) {
+		if (frustum_intersects_sphere(frustum, vector3(centers.x[i], centers.y[i], centers.z[i]), radii[i])) {
+			visible[result] = (u32)i;
+			result += 1;
+		}
+	}
+	return result;
+}
+
+//////////////////////////////////////////////
+// Rasterization
+
+/* Edge from a to b, positive on its left. Evaluated at pixel centres from integer pixel coordinates. */
+internal void _raster_setup_edge(Raster_Triangle* triangle, u32 edge, Vector2 a, Vector2 b) {
+	triangle->edge_a[edge] = a.y - b.y;
+	triangle->edge_b[edge] = b.x - a.x;
+	triangle->edge_c[edge] = -(triangle->edge_a[edge]*a.x + triangle->edge_b[edge]*a.y) + 0.5f*(triangle->edge_a[edge] + triangle->edge_b[edge]);
+}
+
+internal f32 raster_triangle_setup(Raster_Triangle* triangle, Vector2 p0, Vector2 p1, Vector2 p2, s32 width, s32 height) {
+	f32 area = (p1.x - p0.x)*(p2.y - p0.y) - (p2.x - p0.x)*(p1.y - p0.y);
+	if (!(area < 0.0f)) {
+		return 0.0f;
+	}
+	
+	f32 min_x = Min(p0.x, Min(p1.x, p2.x)), max_x = Max(p0.x, Max(p1.x, p2.x));
+	f32 min_y = Min(p0.y, Min(p1.y, p2.y)), max_y = Max(p0.y, Max(p1.y, p2.y));
+	s32 x0 = Max((s32)ceilf(min_x - 0.5f), 0), x1 = Min((s32)floorf(max_x - 0.5f), width  - 1);
+	s32 y0 = Max((s32)ceilf(min_y - 0.5f), 0), y1 = Min((s32)floorf(max_y - 0.5f), height - 1);
+	if (x0 > x1 || y0 > y1) {
+		return 0.0f;
+	}
+	
+	// Clockwise, walked backwards so the inside is on the left of every edge
+	_raster_setup_edge(triangle, 0, p0, p2);
+	_raster_setup_edge(triangle, 1, p2, p1);
+	_raster_setup_edge(triangle, 2, p1, p0);
+	triangle->min_x = x0;
+	triangle->min_y = y0;
+	triangle->max_x = x1;
+	triangle->max_y = y1;
+	return area;
+}
+
+//////////////////////////////////////////////
+// Batch transforms
+
+#define TRANSFORM_PARALLEL_MIN_BATCH 16384
+
+internal Matrix4x8 _matrix4x8_for_transform(Matrix4 m, Transform_Mode mode) {
+	Matrix4x8 result = matrix4x8_from_matrix4(m);
+	if (mode == TransformMode_Direction) {
+		result.m[3]  = f32x8_zero();
+		result.m[7]  = f32x8_zero();
+		result.m[11] = f32x8_zero();
+	}
+	return result;
+}
+
+internal Vector3x8 _transform_vector3x8(Matrix4x8* m, Vector3x8 v, Transform_Mode mode) {
+	Vector3x8 result = mul_vector3x8_matrix4x8(v, m);
+	if (mode == TransformMode_Perspective) {
+		f32x8* e = m->m;
+		f32x8 w = f32x8_madd(e[12], v.x, f32x8_madd(e[13], v.y, f32x8_madd(e[14], v.z, e[15])));
+		result = vector3x8_scale(result, f32x8_div(f32x8_splat(1.0f), w));
+	}
+	return result;
+}
+
+internal Vector3 _transform_vector3(Matrix4* m, Vector3 v, Transform_Mode mode) {
+	f32 w = (mode == TransformMode_Direction) ? 0.0f : 1.0f;
+	f32x4 r = _mul_f32x4_matrix4(_f32x4_from_vector3(v, w), m);
+	if (mode == TransformMode_Perspective) {
+		r = f32x4_div(r, F32x4Shuffle(r, 3, 3, 3, 3));
+	}
+	Vector3 result = _vector3_from_f32x4(r);
+	return result;
+}
+
+internal void transform_vector3_array(Matrix4 m, Vector3* in, Vector3* out, u64 count, Transform_Mode mode) {
+	Matrix4x8 lanes = _matrix4x8_for_transform(m, mode);
+	u64 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		vector3x8_store(out + i, _transform_vector3x8(&lanes, vector3x8_load(in + i), mode));
+	}
+	for (; i < count; i += 1) {
+		out[i] = _transform_vector3(&m, in[i], mode);
+	}
+}
+
+internal void transform_vector3_soa(Matrix4 m, Vector3_SoA in, Vector3_SoA out, u64 count, Transform_Mode mode) {
+	Matrix4x8 lanes = _matrix4x8_for_transform(m, mode);
+	u64 i = 0;
+	for (; i + 8 <= count; i += 8) {
+		vector3x8_store_soa(out, i, _transform_vector3x8(&lanes, vector3x8_load_soa(in, i), mode));
+	}
+	for (; i < count; i += 1) {
+		Vector3 v = _transform_vector3(&m, vector3(in.x[i], in.y[i], in.z[i]), mode);
+		out.x[i] = v.x;
+		out.y[i] = v.y;
+		out.z[i] = v.z;
+	}
+}
+
+internal void transform_vector4_array(Matrix4 m, Vector4* in, Vector4* out, u64 count) {
+	// NOTE(fz): Columns of m, so each vector is x*c0 + y*c1 + z*c2 + w*c3 without horizontal adds.
+	f32x4 c0 = f32x4_load(m.data[0]);
+	f32x4 c1 = f32x4_load(m.data[1]);
+	f32x4 c2 = f32x4_load(m.data[2]);
+	f32x4 c3 = f32x4_load(m.data[3]);
+	f32x4_transpose(&c0, &c1, &c2, &c3);
+	for (u64 i = 0; i < count; i += 1) {
+		f32x4 v = f32x4_load(in[i].data);
+		f32x4 r = f32x4_mul(F32x4Shuffle(v, 0, 0, 0, 0), c0);
+		r = f32x4_madd(F32x4Shuffle(v, 1, 1, 1, 1), c1, r);
+		r = f32x4_madd(F32x4Shuffle(v, 2, 2, 2, 2), c2, r);
+		r = f32x4_madd(F32x4Shuffle(v, 3, 3, 3, 3), c3, r);
+		f32x4_store(out[i].data, r);
+	}
+}
+
+typedef struct Transform_Job {
+	Matrix4 m;
+	Transform_Mode mode;
+	void* in;
+	void* out;
+	Vector3_SoA in_soa;
+	Vector3_SoA out_soa;
+} Transform_Job;
+
+internal void _transform_vector3_array_job(void* context, u64 first, u64 one_past_last) {
+	Transform_Job* job = (Transform_Job*)context;
+	transform_vector3_array(job->m, (Vector3*)job->in + first, (Vector3*)job->out + first, one_past_last - first, job->mode);
+}
+
+internal void _transform_vector3_soa_job(void* context, u64 first, u64 one_past_last) {
+	Transform_Job* job = (Transform_Job*)context;
+	Vector3_SoA in  = { job->in_soa.x  + first, job->in_soa.y  + first, job->in_soa.z  + first };
+	Vector3_SoA out = { job->out_soa.x + first, job->out_soa.y + first, job->out_soa.z + first };
+	transform_vector3_soa(job->m, in, out, one_past_last - first, job->mode);
+}
+
+internal void _transform_vector4_array_job(void* context, u64 first, u64 one_past_last) {
+	Transform_Job* job = (Transform_Job*)context;
+	transform_vector4_array(job->m, (Vector4*)job->in + first, (Vector4*)job->out + first, one_past_last - first);
+}
+
+internal void transform_vector3_array_parallel(Matrix4 m, Vector3* in, Vector3* out, u64 count, Transform_Mode mode) {
+	Transform_Job job = { 0 };
+	job.m    = m;
+	job.mode = mode;
+	job.in   = in;
+	job.out  = out;
+	parallel_for(count, TRANSFORM_PARALLEL_MIN_BATCH, _transform_vector3_array_job, &job);
+}
+
+internal void transform_vector3_soa_parallel(Matrix4 m, Vector3_SoA in, Vector3_SoA out, u64 count, Transform_Mode mode) {
+	Transform_Job job = { 0 };
+	job.m       = m;
+	job.mode    = mode;
+	job.in_soa  = in;
+	job.out_soa = out;
+	parallel_for(count, TRANSFORM_PARALLEL_MIN_BATCH, _transform_vector3_soa_job, &job);
+}
+
+internal void transform_vector4_array_parallel(Matrix4 m, Vector4* in, Vector4* out, u64 count) {
+	Transform_Job job = { 0 };
+	job.m   = m;
+	job.in  = in;
+	job.out = out;
+	parallel_for(count, TRANSFORM_PARALLEL_MIN_BATCH, _transform_vector4_array_job, &job);
+}
+
+//////////////////////////////////////////////
+// Fast math
+
+#define FAST_MATH_2_OVER_PI  0.636619772367581343f
+#define FAST_MATH_PI_OVER_2  1.57079632679489662f
+/* pi/2 split in three so q*PIO2_A and q*PIO2_B are exact for the q we care about (Cody-Waite) */
+#define FAST_MATH_PIO2_A 1.5703125f
+#define FAST_MATH_PIO2_B 4.837512969970703125e-4f
+#define FAST_MATH_PIO2_C 7.54978995489188216e-8f
+
+#if FAST_MATH_PRECISION == FAST_MATH_PRECISION_HIGH
+/* Cephes sinf/cosf minimax coefficients on [-pi/4, pi/4] */
+# define FAST_MATH_SIN_1 -1.6666654611e-1f
+# define FAST_MATH_SIN_2  8.3321608736e-3f
+# define FAST_MATH_SIN_3 -1.9515295891e-4f
+# define FAST_MATH_COS_1  4.166664568298827e-2f
+# define FAST_MATH_COS_2 -1.388731625493765e-3f
+# define FAST_MATH_COS_3  2.443315711809948e-5f
+#else
+/* Taylor, one term shorter for sin */
+# define FAST_MATH_SIN_1 -1.6666667e-1f
+# define FAST_MATH_SIN_2  8.3333333e-3f
+# define FAST_MATH_SIN_3  0.0f
+# define FAST_MATH_COS_1  4.1666667e-2f
+# define FAST_MATH_COS_2 -1.3888889e-3f
+# define FAST_MATH_COS_3  0.0f
+#endif
+
+/* sin(r) and cos(r) for r in [-pi/4, pi/4] */
+internal void _f32_sincos_kernel(f32 r, f32* s, f32* c) {
+	f32 z = r*r;
+	*s = r + r*z*(FAST_MATH_SIN_1 + z*(FAST_MATH_SIN_2 + z*FAST_MATH_SIN_3));
+	*c = 1.0f - 0.5f*z + z*z*(FAST_MATH_COS_1 + z*(FAST_MATH_COS_2 + z*FAST_MATH_COS_3));
+}
+
+internal void f32_fast_sincos(f32 x, f32* sin_out, f32* cos_out) {
+	f32 scaled   = x*FAST_MATH_2_OVER_PI;
+	s32 quadrant = (s32)(scaled + ((scaled >= 0.0f)? 0.5f : -0.5f));
+	f32 q = (f32)quadrant;
+	f32 r = ((x - q*FAST_MATH_PIO2_A) - q*FAST_MATH_PIO2_B) - q*FAST_MATH_PIO2_C;
+
+	f32 s, c;
+	_f32_sincos_kernel(r, &s, &c);
+	switch (quadrant & 3) {
+		case 0: { *sin_out =  s; *cos_out =  c; } break;
+		case 1: { *sin_out =  c; *cos_out = -s; } break;
+		case 2: { *sin_out = -s; *cos_out = -c; } break;
+		case 3: { *sin_out = -c; *cos_out =  s; } break;
+	}
+}
+
+internal f32 f32_fast_sin(f32 x) {
+	f32 s, c;
+	f32_fast_sincos(x, &s, &c);
+	return s;
+}
+
+internal f32 f32_fast_cos(f32 x) {
+	f32 s, c;
+	f32_fast_sincos(x, &s, &c);
+	return c;
+}
+
+/* One Newton-Raphson step: y' = y*(1.5 - 0.5*x*y*y) */
+internal f32x4 _f32x4_rsqrt_newton(f32x4 x, f32x4 y) {
+	f32x4 half_x = f32x4_mul(x, f32x4_splat(0.5f));
+	f32x4 result = f32x4_mul(y, f32x4_sub(f32x4_splat(1.5f), f32x4_mul(half_x, f32x4_mul(y, y))));
+	return result;
+}
+
+internal f32x4 f32x4_fast_rsqrt(f32x4 x) {
+	f32x4 result = f32x4_rsqrt_estimate(x);
+#if FAST_MATH_PRECISION == FAST_MATH_PRECISION_HIGH
+	result = _f32x4_rsqrt_newton(x, result);
+#endif
+	return result;
+}
+
+internal f32x8 f32x8_fast_rsqrt(f32x8 x) {
+	f32x8 result = f32x8_rsqrt_estimate(x);
+#if FAST_MATH_PRECISION == FAST_MATH_PRECISION_HIGH
+	f32x8 half_x = f32x8_mul(x, f32x8_splat(0.5f));
+	result = f32x8_mul(result, f32x8_sub(f32x8_splat(1.5f), f32x8_mul(half_x, f32x8_mul(result, result))));
+#endif
+	return result;
+}
+
+internal f32 f32_fast_rsqrt(f32 x) {
+	f32 result = f32x4_first(f32x4_fast_rsqrt(f32x4_splat(x)));
+	return result;
+}
+
+/* Highest degree first, for Horner */
+#if FAST_MATH_PRECISION == FAST_MATH_PRECISION_HIGH
+/* Abramowitz & Stegun 4.4.49, atan(a)/a as a polynomial in a^2 for a in [0, 1] */
+global f32 FastMathAtanCoefficients[] = { 0.0028662257f, -0.0161657367f, 0.0429096138f, -0.0752896400f, 0.1065626393f, -0.1420889944f, 0.1999355085f, -0.3333314528f, 1.0f };
+/* Abramowitz & Stegun 4.4.46, acos(a)/sqrt(1 - a) as a polynomial in a for a in [0, 1] */
+global f32 FastMathAcosCoefficients[] = { -0.0012624911f, 0.0066700901f, -0.0170881256f, 0.0308918810f, -0.0501743046f, 0.0889789874f, -0.2145988016f, 1.5707963050f };
+#else
+/* Abramowitz & Stegun 4.4.47 and 4.4.45 */
+global f32 FastMathAtanCoefficients[] = { 0.0208351f, -0.0851330f, 0.1801410f, -0.3302995f, 0.9998660f };
+global f32 FastMathAcosCoefficients[] = { -0.0187293f, 0.0742610f, -0.2121144f, 1.5707288f };
+#endif
+
+internal f32 _f32_horner(f32* coefficients, u32 count, f32 x) {
+	f32 result = coefficients[0];
+	for (u32 i = 1; i < count; i += 1) {
+		result = result*x + coefficients[i];
+	}
+	return result;
+}
+
+internal f32x4 _f32x4_horner(f32* coefficients, u32 count, f32x4 x) {
+	f32x4 result = f32x4_splat(coefficients[0]);
+	for (u32 i = 1; i < count; i += 1) {
+		result = f32x4_madd(result, x, f32x4_splat(coefficients[i]));
+	}
+	return result;
+}
+
+internal f32 f32_fast_atan2(f32 y, f32 x) {
+	f32 abs_x = fabsf(x);
+	f32 abs_y = fabsf(y);
+	f32 big   = Max(abs_x, abs_y);
+	f32 a = (big > 0.0f)? Min(abs_x, abs_y)/big : 0.0f;
+	f32 z = a*a;
+	f32 result = a*_f32_horner(FastMathAtanCoefficients, ArrayCount(FastMathAtanCoefficients), z);
+	if (abs_y > abs_x) result = FAST_MATH_PI_OVER_2 - result;
+	// NOTE(fz): Signs from the sign bits like libm, so atan2(-0, -1) is -PI and atan2(0, -0) is PI.
+	if (signbit(x))    result = PI - result;
+	if (signbit(y))    result = -result;
+	return result;
+}
+
+internal f32 f32_fast_acos(f32 x) {
+	f32 a = Min(fabsf(x), 1.0f);
+	f32 result = sqrtf(1.0f - a)*_f32_horner(FastMathAcosCoefficients, ArrayCount(FastMathAcosCoefficients), a);
+	if (x < 0.0f) result = PI - result;
+	return result;
+}
+
+internal void f32x4_fast_sincos(f32x4 x, f32x4* sin_out, f32x4* cos_out) {
+	f32x4 q = f32x4_round(f32x4_mul(x, f32x4_splat(FAST_MATH_2_OVER_PI)));
+	f32x4 r = f32x4_sub(x, f32x4_mul(q, f32x4_splat(FAST_MATH_PIO2_A)));
+	r = f32x4_sub(r, f32x4_mul(q, f32x4_splat(FAST_MATH_PIO2_B)));
+	r = f32x4_sub(r, f32x4_mul(q, f32x4_splat(FAST_MATH_PIO2_C)));
+
+	f32x4 z = f32x4_mul(r, r);
+	f32x4 s = f32x4_madd(z, f32x4_splat(FAST_MATH_SIN_3), f32x4_splat(FAST_MATH_SIN_2));
+	s = f32x4_madd(z, s, f32x4_splat(FAST_MATH_SIN_1));
+	s = f32x4_madd(f32x4_mul(r, z), s, r);
+	f32x4 c = f32x4_madd(z, f32x4_splat(FAST_MATH_COS_3), f32x4_splat(FAST_MATH_COS_2));
+	c = f32x4_madd(z, c, f32x4_splat(FAST_MATH_COS_1));
+	c = f32x4_madd(f32x4_mul(z, z), c, f32x4_sub(f32x4_splat(1.0f), f32x4_mul(z, f32x4_splat(0.5f))));
+
+	// NOTE(fz): quadrant = q mod 4. Odd quadrants swap sin and cos, the sign flips follow the switch in f32_fast_sincos.
+	f32x4 quadrant = f32x4_sub(q, f32x4_mul(f32x4_floor(f32x4_mul(q, f32x4_splat(0.25f))), f32x4_splat(4.0f)));
+	f32x4 one      = f32x4_splat(1.0f);
+	f32x4 three    = f32x4_splat(3.0f);
+	f32x4 odd      = f32x4_or(f32x4_cmp_eq(quadrant, one), f32x4_cmp_eq(quadrant, three));
+	f32x4 sign_bit = f32x4_splat(-0.0f);
+	f32x4 sin_sign = f32x4_and(f32x4_cmp_ge(quadrant, f32x4_splat(2.0f)), sign_bit);
+	f32x4 cos_sign = f32x4_and(f32x4_and(f32x4_cmp_ge(quadrant, one), f32x4_cmp_lt(quadrant, three)), sign_bit);
+	*sin_out = f32x4_xor(f32x4_select(odd, c, s), sin_sign);
+	*cos_out = f32x4_xor(f32x4_select(odd, s, c), cos_sign);
+}
+
+internal f32x4 f32x4_fast_sin(f32x4 x) {
+	f32x4 s, c;
+	f32x4_fast_sincos(x, &s, &c);
+	return s;
+}
+
+internal f32x4 f32x4_fast_cos(f32x4 x) {
+	f32x4 s, c;
+	f32x4_fast_sincos(x, &s, &c);
+	return c;
+}
+
+internal f32x4 f32x4_fast_atan2(f32x4 y, f32x4 x) {
+	f32x4 abs_x = f32x4_abs(x);
+	f32x4 abs_y = f32x4_abs(y);
+	f32x4 big   = f32x4_max(abs_x, abs_y);
+	f32x4 a     = f32x4_div(f32x4_min(abs_x, abs_y), f32x4_max(big, f32x4_splat(1e-30f)));
+	f32x4 z     = f32x4_mul(a, a);
+	f32x4 result = f32x4_mul(a, _f32x4_horner(FastMathAtanCoefficients, ArrayCount(FastMathAtanCoefficients), z));
+	result = f32x4_select(f32x4_cmp_gt(abs_y, abs_x), f32x4_sub(f32x4_splat(FAST_MATH_PI_OVER_2), result), result);
+	// Signs from the sign bits, see f32_fast_atan2. x's is moved onto 1 so -0 compares below zero.
+	f32x4 sign_bit = f32x4_splat(-0.0f);
+	f32x4 x_sign   = f32x4_or(f32x4_and(x, sign_bit), f32x4_splat(1.0f));
+	result = f32x4_select(f32x4_cmp_lt(x_sign, f32x4_zero()), f32x4_sub(f32x4_splat(PI), result), result);
+	result = f32x4_or(result, f32x4_and(y, sign_bit));
+	return result;
+}
+
+internal f32x4 f32x4_fast_acos(f32x4 x) {
+	f32x4 a    = f32x4_min(f32x4_abs(x), f32x4_splat(1.0f));
+	f32x4 poly = _f32x4_horner(FastMathAcosCoefficients, ArrayCount(FastMathAcosCoefficients), a);
+	f32x4 result = f32x4_mul(f32x4_sqrt(f32x4_sub(f32x4_splat(1.0f), a)), poly);
+	result = f32x4_select(f32x4_cmp_lt(x, f32x4_zero()), f32x4_sub(f32x4_splat(PI), result), result);
+	return result;
+}
+
+internal Vector3 vector3_normalize_fast(Vector3 v) {
+	Vector3 result = v;
+	f32x4 xyz = _f32x4_from_vector3(v, 0.0f);
+	f32x4 length_squared = f32x4_dot(xyz, xyz);
+	if (f32x4_first(length_squared) != 0.0f) {
+		result = _vector3_from_f32x4(f32x4_mul(xyz, f32x4_fast_rsqrt(length_squared)));
+	}
+	return result;
+}
+
+internal Vector4 vector4_normalize_fast(Vector4 v) {
+	Vector4 result = v;
+	f32x4 xyzw = f32x4_load(v.data);
+	f32x4 length_squared = f32x4_dot(xyzw, xyzw);
+	if (f32x4_first(length_squared) > 0) {
+		f32x4_store(result.data, f32x4_mul(xyzw, f32x4_fast_rsqrt(length_squared)));
+	}
+	return result;
+}
@@ -4,6 +4,15 @@
 
 #define PI 3.14159265358979323846f
 #define EPSILON 0.000001f
+#define RAY_EPSILON 0.000001f
+
+// NOTE(fz): Selects the polynomials behind the f32_fast_* and f32x4_fast_* functions.
+// Define FAST_MATH_PRECISION before including f_base to override.
+#define FAST_MATH_PRECISION_LOW  0
+#define FAST_MATH_PRECISION_HIGH 1
+#ifndef FAST_MATH_PRECISION
+# define FAST_MATH_PRECISION FAST_MATH_PRECISION_HIGH
+#endif
 
 #define Degrees(r) (r * (180 / PI))
 #define Radians(d) (d * (PI / 180))
@@ -82,7 +91,103 @@ typedef struct Ray {
   Vector3 point;
   Vector3 direction;
 } Ray;
-#define ray(point, direction) (Rayf32){point,direction}
+#define ray(point, direction) (Ray){point,direction}
+
+/* Structure of arrays, one stream per component */
+typedef struct Vector3_SoA {
+  f32* x;
+  f32* y;
+  f32* z;
+} Vector3_SoA;
+
+typedef enum Transform_Mode {
+  TransformMode_Point,       /* w = 1 */
+  TransformMode_Direction,   /* w = 0. For normals pass the inverse transpose of the matrix */
+  TransformMode_Perspective  /* w = 1, then divides xyz by the resulting w */
+} Transform_Mode;
+
+// NOTE(fz): Wide types, the same structure of arrays trick across SIMD lanes: Vector3x8 holds 8 Vector3,
+// its x holds all 8 x values. x8 is native under AVX and two f32x4 otherwise, so code written at x8
+// runs at full width everywhere. Masks come from f32x4_cmp_*/f32x8_cmp_* and feed the _select functions.
+typedef struct Vector3x4 {
+  f32x4 x;
+  f32x4 y;
+  f32x4 z;
+} Vector3x4;
+
+typedef struct Vector4x4 {
+  f32x4 x;
+  f32x4 y;
+  f32x4 z;
+  f32x4 w;
+} Vector4x4;
+
+typedef struct Matrix4x4 {
+  f32x4 m[16]; /* Every element of a Matrix4 splat across the lanes, same order as Matrix4 */
+} Matrix4x4;
+
+typedef struct Vector3x8 {
+  f32x8 x;
+  f32x8 y;
+  f32x8 z;
+} Vector3x8;
+
+typedef struct Vector4x8 {
+  f32x8 x;
+  f32x8 y;
+  f32x8 z;
+  f32x8 w;
+} Vector4x8;
+
+typedef struct Matrix4x8 {
+  f32x8 m[16]; /* Every element of a Matrix4 splat across the lanes, same order as Matrix4 */
+} Matrix4x8;
+
+typedef struct Rayx4 {
+  Vector3x4 point;
+  Vector3x4 direction;
+} Rayx4;
+
+typedef struct Rayx8 {
+  Vector3x8 point;
+  Vector3x8 direction;
+} Rayx8;
+
+typedef struct AABB {
+  Vector3 min;
+  Vector3 max;
+} AABB;
+
+/* Planes are (normal, d) in a Vector4, a point p is inside when dot(normal, p) + d >= 0 */
+typedef enum Frustum_Plane {
+  FrustumPlane_Left,
+  FrustumPlane_Right,
+  FrustumPlane_Bottom,
+  FrustumPlane_Top,
+  FrustumPlane_Near,
+  FrustumPlane_Far,
+  FrustumPlane_Count
+} Frustum_Plane;
+
+typedef struct Frustum {
+  Vector4 planes[FrustumPlane_Count];
+} Frustum;
+
+/* Screen space triangle for the CPU rasterizers, covered where all three edges are >= 0 */
+typedef struct Raster_Triangle {
+  f32 edge_a[3]; // e(x, y) = a*x + b*y + c, at pixel centres
+  f32 edge_b[3];
+  f32 edge_c[3];
+  s32 min_x, min_y; // Pixel bounds, inclusive and clamped to the target
+  s32 max_x, max_y;
+} Raster_Triangle;
+
+typedef struct Ray_Hit {
+  b32 hit;
+  f32 t;     /* point + t*direction */
+  f32 u, v;  /* Barycentrics, hit = (1 - u - v)*a + u*b + v*c */
+  u64 index; /* Triangle index, for the list queries */
+} Ray_Hit;
 
 internal f32 f32_clamp(f32 value, f32 min, f32 max);
 internal f32 f32_lerp(f32 start, f32 end, f32 amount);
@@ -110,6 +215,7 @@ internal Vector3 vector3_normalize(Vector3 v);
 internal Vector3 vector3_rotate_by_axis(Vector3 v, Vector3 axis, f32 angle);
 internal Vector3 vector3_lerp(Vector3 a, Vector3 b, f32 t);
 internal Vector3 vector3_unproject(Vector3 source, Matrix4 projection, Matrix4 view);
+internal Vector3 vector3_unproject_inverse(Vector3 source, Matrix4 inverse_view_projection); /* Skips rebuilding and inverting view*projection */
 internal Vector3 mul_vector3_matrix4(Vector3 v, Matrix4 m);
 
 internal f32 vector3_dot(Vector3 a, Vector3 b);
@@ -146,6 +252,9 @@ internal Matrix4 matrix4_rotate_xyz(Vector3 radians);
 internal Matrix4 matrix4_rotate_zyx(Vector3 radians);
 
 internal Matrix4 matrix4_transpose(Matrix4 m);
+internal Matrix4 matrix4_inverse(Matrix4 m);        /* Any invertible matrix. Returns a zero matrix if m is singular */
+internal Matrix4 matrix4_inverse_affine(Matrix4 m); /* Bottom row must be (0, 0, 0, 1): rotation, scale, shear and translation */
+internal Matrix4 matrix4_inverse_rigid(Matrix4 m);  /* Rotation and translation only, no scale */
 internal Matrix4 matrix4_scale(f32 x, f32 y, f32 z);
 internal Matrix4 matrix4_frustum(f64 left, f64 right, f64 bottom, f64 top, f64 near_plane, f64 far_plane);
 internal Matrix4 matrix4_perspective(f64 fovy, f64 window_width, f64 window_height, f64 near_plane, f64 far_plane);
@@ -177,7 +286,145 @@ internal void       euler_from_quaternion(Quaternion q, f32* pitch, f32* yaw, f3
 internal Quaternion quaternion_mul_matric4(Quaternion q, Matrix4 mat);
 internal b32        quaternion_equals(Quaternion p, Quaternion q);
 
+internal Vector3x4 vector3x4_splat(Vector3 v);
+internal Vector3x4 vector3x4_load(Vector3* ptr); /* 4 packed Vector3 */
+internal void      vector3x4_store(Vector3* ptr, Vector3x4 v);
+internal Vector3x4 vector3x4_load_soa(Vector3_SoA soa, u64 index);
+internal void      vector3x4_store_soa(Vector3_SoA soa, u64 index, Vector3x4 v);
+internal Vector3   vector3x4_get(Vector3x4 v, u32 lane);
+internal Vector3x4 vector3x4_add(Vector3x4 a, Vector3x4 b);
+internal Vector3x4 vector3x4_sub(Vector3x4 a, Vector3x4 b);
+internal Vector3x4 vector3x4_mul(Vector3x4 a, Vector3x4 b);
+internal Vector3x4 vector3x4_scale(Vector3x4 v, f32x4 scalar);
+internal Vector3x4 vector3x4_min(Vector3x4 a, Vector3x4 b);
+internal Vector3x4 vector3x4_max(Vector3x4 a, Vector3x4 b);
+internal f32x4     vector3x4_dot(Vector3x4 a, Vector3x4 b);
+internal Vector3x4 vector3x4_cross(Vector3x4 a, Vector3x4 b);
+internal f32x4     vector3x4_length(Vector3x4 v);
+internal Vector3x4 vector3x4_normalize(Vector3x4 v); /* Zero length lanes are left as is */
+internal Vector3x4 vector3x4_normalize_fast(Vector3x4 v);
+internal Vector3x4 vector3x4_lerp(Vector3x4 a, Vector3x4 b, f32x4 t);
+internal Vector3x4 vector3x4_select(f32x4 mask, Vector3x4 a, Vector3x4 b); /* mask ? a : b, per lane */
+internal Vector3x4 mul_vector3x4_matrix4x4(Vector3x4 v, Matrix4x4* m); /* w = 1, no divide */
+
+internal Vector4x4 vector4x4_splat(Vector4 v);
+internal Vector4x4 vector4x4_load(Vector4* ptr); /* 4 packed Vector4 */
+internal void      vector4x4_store(Vector4* ptr, Vector4x4 v);
+internal Vector4   vector4x4_get(Vector4x4 v, u32 lane);
+internal Vector4x4 vector4x4_add(Vector4x4 a, Vector4x4 b);
+internal Vector4x4 vector4x4_sub(Vector4x4 a, Vector4x4 b);
+internal Vector4x4 vector4x4_mul(Vector4x4 a, Vector4x4 b);
+internal Vector4x4 vector4x4_scale(Vector4x4 v, f32x4 scalar);
+internal f32x4     vector4x4_dot(Vector4x4 a, Vector4x4 b);
+internal Vector4x4 vector4x4_normalize(Vector4x4 v);
+internal Vector4x4 vector4x4_select(f32x4 mask, Vector4x4 a, Vector4x4 b);
+internal Vector4x4 mul_vector4x4_matrix4x4(Vector4x4 v, Matrix4x4* m);
+
+internal Matrix4x4 matrix4x4_from_matrix4(Matrix4 m);
+
+internal Vector3x8 vector3x8_splat(Vector3 v);
+internal Vector3x8 vector3x8_load(Vector3* ptr); /* 8 packed Vector3 */
+internal void      vector3x8_store(Vector3* ptr, Vector3x8 v);
+internal Vector3x8 vector3x8_load_soa(Vector3_SoA soa, u64 index);
+internal void      vector3x8_store_soa(Vector3_SoA soa, u64 index, Vector3x8 v);
+internal Vector3   vector3x8_get(Vector3x8 v, u32 lane);
+internal Vector3x8 vector3x8_add(Vector3x8 a, Vector3x8 b);
+internal Vector3x8 vector3x8_sub(Vector3x8 a, Vector3x8 b);
+internal Vector3x8 vector3x8_mul(Vector3x8 a, Vector3x8 b);
+internal Vector3x8 vector3x8_scale(Vector3x8 v, f32x8 scalar);
+internal Vector3x8 vector3x8_min(Vector3x8 a, Vector3x8 b);
+internal Vector3x8 vector3x8_max(Vector3x8 a, Vector3x8 b);
+internal f32x8     vector3x8_dot(Vector3x8 a, Vector3x8 b);
+internal Vector3x8 vector3x8_cross(Vector3x8 a, Vector3x8 b);
+internal f32x8     vector3x8_length(Vector3x8 v);
+internal Vector3x8 vector3x8_normalize(Vector3x8 v); /* Zero length lanes are left as is */
+internal Vector3x8 vector3x8_normalize_fast(Vector3x8 v);
+internal Vector3x8 vector3x8_lerp(Vector3x8 a, Vector3x8 b, f32x8 t);
+internal Vector3x8 vector3x8_select(f32x8 mask, Vector3x8 a, Vector3x8 b); /* mask ? a : b, per lane */
+internal Vector3x8 mul_vector3x8_matrix4x8(Vector3x8 v, Matrix4x8* m); /* w = 1, no divide */
+
+internal Vector4x8 vector4x8_splat(Vector4 v);
+internal Vector4x8 vector4x8_load(Vector4* ptr); /* 8 packed Vector4 */
+internal void      vector4x8_store(Vector4* ptr, Vector4x8 v);
+internal Vector4   vector4x8_get(Vector4x8 v, u32 lane);
+internal Vector4x8 vector4x8_add(Vector4x8 a, Vector4x8 b);
+internal Vector4x8 vector4x8_sub(Vector4x8 a, Vector4x8 b);
+internal Vector4x8 vector4x8_mul(Vector4x8 a, Vector4x8 b);
+internal Vector4x8 vector4x8_scale(Vector4x8 v, f32x8 scalar);
+internal f32x8     vector4x8_dot(Vector4x8 a, Vector4x8 b);
+internal Vector4x8 vector4x8_normalize(Vector4x8 v);
+internal Vector4x8 vector4x8_select(f32x8 mask, Vector4x8 a, Vector4x8 b);
+internal Vector4x8 mul_vector4x8_matrix4x8(Vector4x8 v, Matrix4x8* m);
+
+internal Matrix4x8 matrix4x8_from_matrix4(Matrix4 m);
+
+internal AABB aabb_from_points(Vector3* points, u64 count); /* Empty (min > max) when count is 0 */
+internal AABB aabb_union(AABB a, AABB b);
+internal AABB aabb_transform(AABB box, Matrix4 m); /* Bounds of the transformed box, not the box itself */
+internal b32  aabb_is_empty(AABB box);
+
+// NOTE(fz): Culling. Frustum planes come normalized, so sphere radii compare directly.
+// The _cull_ functions test 8 volumes per step and write the indices of the visible ones to visible,
+// which needs room for count entries. They return how many were written, in increasing index order.
+// AABBs are center/extent (half size) here since that's what the test wants.
+internal Frustum frustum_from_matrix4(Matrix4 view_projection);
+internal b32 frustum_intersects_aabb(Frustum* frustum, Vector3 center, Vector3 extent);
+internal b32 frustum_intersects_sphere(Frustum* frustum, Vector3 center, f32 radius);
+internal u64 frustum_cull_aabbs(Frustum* frustum, Vector3_SoA centers, Vector3_SoA extents, u64 count, u32* visible);
+internal u64 frustum_cull_spheres(Frustum* frustum, Vector3_SoA centers, f32* radii, u64 count, u32* visible);
+
+// NOTE(fz): Rasterization. Window coordinates, pixel centres at + 0.5. Only clockwise triangles are kept, the renderer
+// culls GL_FRONT. Returns the signed area (negative), or 0 when the triangle is culled or covers no pixel centre.
+internal f32 raster_triangle_setup(Raster_Triangle* triangle, Vector2 p0, Vector2 p1, Vector2 p2, s32 width, s32 height);
+
+// NOTE(fz): Batch transforms. Same math as mul_vector3_matrix4/mul_vector4_matrix4, 8 elements per step.
+// in and out may alias. The _parallel versions split the array across threads.
+internal void transform_vector3_array(Matrix4 m, Vector3* in, Vector3* out, u64 count, Transform_Mode mode);
+internal void transform_vector3_soa(Matrix4 m, Vector3_SoA in, Vector3_SoA out, u64 count, Transform_Mode mode);
+internal void transform_vector4_array(Matrix4 m, Vector4* in, Vector4* out, u64 count);
+internal void transform_vector3_array_parallel(Matrix4 m, Vector3* in, Vector3* out, u64 count, Transform_Mode mode);
+internal void transform_vector3_soa_parallel(Matrix4 m, Vector3_SoA in, Vector3_SoA out, u64 count, Transform_Mode mode);
+internal void transform_vector4_array_parallel(Matrix4 m, Vector4* in, Vector4* out, u64 count);
+
+// NOTE(fz): Fast approximations, opt-in for hot loops. The precise versions above are untouched.
+// Max errors measured against double precision libm, HIGH / LOW:
+//   sincos: 9.3e-8 / 3.6e-5 absolute, for |x| < 8192 (range reduction loses bits beyond that)
+//   rsqrt:  2.5e-7 / 3.3e-4 relative on SSE. The scalar fallback is exact, NEON gets ~16 bits on LOW
+//   atan2:  3.2e-7 / 1.2e-5 radians
+//   acos:   4.0e-7 / 6.8e-5 radians, input clamped to [-1, 1]
+// The f32x4 versions run ~10x faster than libm per element, the scalar ones ~1.7x.
+internal void f32_fast_sincos(f32 x, f32* sin_out, f32* cos_out);
+internal f32  f32_fast_sin(f32 x);
+internal f32  f32_fast_cos(f32 x);
+internal f32  f32_fast_rsqrt(f32 x);
+internal f32  f32_fast_atan2(f32 y, f32 x);
+internal f32  f32_fast_acos(f32 x);
+internal void  f32x4_fast_sincos(f32x4 x, f32x4* sin_out, f32x4* cos_out);
+internal f32x4 f32x4_fast_sin(f32x4 x);
+internal f32x4 f32x4_fast_cos(f32x4 x);
+internal f32x4 f32x4_fast_rsqrt(f32x4 x);
+internal f32x4 f32x4_fast_atan2(f32x4 y, f32x4 x);
+internal f32x4 f32x4_fast_acos(f32x4 x);
+internal f32x8 f32x8_fast_rsqrt(f32x8 x);
+internal Vector3 vector3_normalize_fast(Vector3 v); /* rsqrt instead of sqrt + divide */
+internal Vector4 vector4_normalize_fast(Vector4 v);
+
 internal b32 is_vector_inside_rectangle(Vector3 p, Vector3 a, Vector3 b, Vector3 c);
 internal Vector3 intersect_ray_with_plane(Ray line, Vector3 point1, Vector3 point2, Vector3 point3);
 
+// NOTE(fz): Ray kernels. Triangles are two sided, hits closer than RAY_EPSILON are ignored.
+// The _x4/_x8 versions test one ray against 4/8 shapes, the rayx4/rayx8 versions test a packet of
+// rays against one shape. Both return a lane mask and write t, F32_MAX in the lanes that missed.
+internal b32 intersect_ray_with_triangle(Ray ray, Vector3 a, Vector3 b, Vector3 c, Ray_Hit* hit);
+internal b32 intersect_ray_with_aabb(Ray ray, Vector3 min, Vector3 max, f32* t); /* t = 0 when starting inside */
+internal f32x4 intersect_ray_with_triangle_x4(Ray ray, Vector3x4 a, Vector3x4 b, Vector3x4 c, f32x4* t);
+internal f32x4 intersect_ray_with_aabb_x4(Ray ray, Vector3x4 min, Vector3x4 max, f32x4* t);
+internal f32x4 intersect_rayx4_with_triangle(Rayx4 rays, Vector3 a, Vector3 b, Vector3 c, f32x4* t);
+internal f32x4 intersect_rayx4_with_aabb(Rayx4 rays, Vector3 min, Vector3 max, f32x4* t);
+internal f32x8 intersect_ray_with_triangle_x8(Ray ray, Vector3x8 a, Vector3x8 b, Vector3x8 c, f32x8* t);
+internal f32x8 intersect_ray_with_aabb_x8(Ray ray, Vector3x8 min, Vector3x8 max, f32x8* t);
+internal f32x8 intersect_rayx8_with_triangle(Rayx8 rays, Vector3 a, Vector3 b, Vector3 c, f32x8* t);
+internal f32x8 intersect_rayx8_with_aabb(Rayx8 rays, Vector3 min, Vector3 max, f32x8* t);
+internal Ray_Hit intersect_ray_with_triangle_list(Ray ray, Vector3* vertices, u32* indices, u64 triangle_count); /* Closest hit. indices can be NULL, then it is 3 vertices per triangle */
+
 #endif // F_MATH_H
\ No newline at end of file
@@ -22,6 +22,12 @@ internal OS_Thread os_thread_create(thread_func* start, void* context);
 internal void os_thread_wait_for_join(OS_Thread* other);
 internal void os_thread_wait_for_join_all(OS_Thread** threads, u32 count);
 internal void os_thread_wait_for_join_any(OS_Thread** threads, u32 count);
+internal u32  os_thread_get_core_count();
+
+//~ Time
+internal u64 os_get_ticks(); /* High resolution counter, os_get_ticks_per_second() ticks per second */
+internal u64 os_get_ticks_per_second();
+internal u64 os_get_cpu_cycles(); /* Raw time stamp counter, 0 where there isn't one */
 
 //~ File handling
 typedef struct OS_File {
@@ -32,9 +38,11 @@ typedef struct OS_File {
 internal b32 os_file_create(String file_name);
 internal b32 os_file_exists(String file_name);
 internal u32 os_file_write(String file_name, u8* data, u64 data_size);
-internal u32 os_file_size(String file_name);
+internal u64 os_file_size(String file_name);
 internal OS_File os_file_load_entire_file(Arena* arena, String file_name);
 internal u64 os_file_get_last_modified_time(String file_name);
+internal OS_File os_file_map(String file_name); /* Private copy on write view, empty on failure */
+internal void    os_file_unmap(OS_File* file);
 
 //~ Logging
 internal void os_print_string(String string);
@@ -1,5 +1,6 @@
 #include <Windows.h>
 #include <userenv.h>
+#include <intrin.h>
 
 global u64 Win32TicksOerSec = 1;
 global u32 Win32ThreadContextIndex;
@@ -37,6 +38,90 @@ internal u64 os_memory_get_page_size() {
   return(sysinfo.dwPageSize);
 }
 
+//~ Threading
+
+typedef struct Win32_Thread_Start {
+  thread_func* start;
+  void* context;
+} Win32_Thread_Start;
+
+internal DWORD WINAPI _win32_thread_entry(LPVOID parameter) {
+  Win32_Thread_Start start = *(Win32_Thread_Start*)parameter;
+  free(parameter);
+  DWORD result = (DWORD)start.start(start.context);
+  return result;
+}
+
+internal OS_Thread os_thread_create(thread_func* start, void* context) {
+  OS_Thread result = { 0 };
+  Win32_Thread_Start* parameter = (Win32_Thread_Start*)malloc(sizeof(Win32_Thread_Start));
+  parameter->start   = start;
+  parameter->context = context;
+  
+  HANDLE handle = CreateThread(NULL, 0, _win32_thread_entry, parameter, 0, NULL);
+  if (handle == NULL) {
+    printf("Error: CreateThread failed with error: %lu\n", GetLastError());
+    free(parameter);
+  }
+  result.v[0] = (u64)handle;
+  return result;
+}
+
+internal void os_thread_wait_for_join(OS_Thread* other) {
+  HANDLE handle = (HANDLE)other->v[0];
+  if (handle != NULL) {
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
+    other->v[0] = 0;
+  }
+}
+
+internal void os_thread_wait_for_join_all(OS_Thread** threads, u32 count) {
+  for (u32 i = 0; i < count; i += 1) {
+    os_thread_wait_for_join(threads[i]);
+  }
+}
+
+internal void os_thread_wait_for_join_any(OS_Thread** threads, u32 count) {
+  HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+  u32 handle_count = 0;
+  for (u32 i = 0; i < count && handle_count < MAXIMUM_WAIT_OBJECTS; i += 1) {
+    if (threads[i]->v[0] != 0) {
+      handles[handle_count] = (HANDLE)threads[i]->v[0];
+      handle_count += 1;
+    }
+  }
+  if (handle_count > 0) {
+    WaitForMultipleObjects(handle_count, handles, FALSE, INFINITE);
+  }
+}
+
+internal u32 os_thread_get_core_count() {
+  SYSTEM_INFO sysinfo = {0};
+  GetSystemInfo(&sysinfo);
+  return(sysinfo.dwNumberOfProcessors);
+}
+
+//~ Time
+
+internal u64 os_get_ticks() {
+  LARGE_INTEGER counter = {0};
+  QueryPerformanceCounter(&counter);
+  return (u64)counter.QuadPart;
+}
+
+internal u64 os_get_ticks_per_second() {
+  return Win32TicksOerSec;
+}
+
+internal u64 os_get_cpu_cycles() {
+#if ARCH_X64 || ARCH_X86
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
 //~ File handling
 
 internal HANDLE _win32_get_file_handle_read(String file_name) {
@@ -107,8 +192,8 @@ internal u32 os_file_write(String file_name, u8* data, u64 data_size) {
   return bytes_written;
 }
 
-internal u32 os_file_size(String file_name) {
-  u32 result = 0;
+internal u64 os_file_size(String file_name) {
+  u64 result = 0;
   if (!os_file_exists(file_name)) {
     printf("Error: os_file_exists failed because file %s doesn't exist\n", file_name.str);
     return result;
@@ -146,6 +231,41 @@ internal OS_File os_file_load_entire_file(Arena* arena, String file_name) {
   return os_file;
 }
 
+internal OS_File os_file_map(String file_name) {
+  OS_File result = { 0 };
+  HANDLE file_handle = _win32_get_file_handle_read(file_name);
+  if (file_handle == NULL) {
+    return result;
+  }
+  
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file_handle, &size) && size.QuadPart > 0) {
+    HANDLE mapping = CreateFileMappingA(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping != NULL) {
+      result.data = (u8*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      if (result.data != NULL) {
+        result.size = size.QuadPart;
+      } else {
+        printf("Error: %lu in os_file_map::MapViewOfFile\n", GetLastError());
+      }
+      CloseHandle(mapping); // NOTE(fz): The view keeps the mapping alive.
+    } else {
+      printf("Error: %lu in os_file_map::CreateFileMappingA\n", GetLastError());
+    }
+  }
+  
+  CloseHandle(file_handle);
+  return result;
+}
+
+internal void os_file_unmap(OS_File* file) {
+  if (file->data != NULL) {
+    UnmapViewOfFile(file->data);
+  }
+  file->data = NULL;
+  file->size = 0;
+}
+
 internal void os_print_string(String string) {
   HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
   WriteFile(handle, string.str, string.size, NULL, NULL);
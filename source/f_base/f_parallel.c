@@ -0,0 +1,63 @@
+internal u64 _parallel_for_thread_entry(void* context) {
+  Parallel_For_Range* range = (Parallel_For_Range*)context;
+  
+  Thread_Context thread_context;
+  thread_context_init_and_attach(&thread_context);
+  range->func(range->context, range->first, range->one_past_last);
+  thread_context_free();
+  
+  return 0;
+}
+
+internal u32 parallel_for_thread_count(u64 count, u64 min_batch_size) {
+  u64 batches = (min_batch_size > 0) ? (count / min_batch_size) : count;
+  u64 result  = Min(batches, (u64)os_thread_get_core_count());
+  result = Clamp(1, result, PARALLEL_MAX_THREADS);
+  return (u32)result;
+}
+
+internal void parallel_for(u64 count, u64 min_batch_size, parallel_for_func* func, void* context) {
+  if (count == 0) {
+    return;
+  }
+  
+  u32 thread_count = parallel_for_thread_count(count, min_batch_size);
+  if (thread_count == 1) {
+    func(context, 0, count);
+    return;
+  }
+  
+  Parallel_For_Range ranges[PARALLEL_MAX_THREADS];
+  OS_Thread threads[PARALLEL_MAX_THREADS];
+  OS_Thread* thread_ptrs[PARALLEL_MAX_THREADS];
+  
+  u64 batch_size = count / thread_count;
+  u64 remainder  = count % thread_count;
+  u64 first      = 0;
+  for (u32 i = 0; i < thread_count; i += 1) {
+    u64 size = batch_size + ((i < remainder) ? 1 : 0);
+    ranges[i].func          = func;
+    ranges[i].context       = context;
+    ranges[i].first         = first;
+    ranges[i].one_past_last = first + size;
+    first += size;
+  }
+  
+  u32 worker_count  = thread_count - 1;
+  u32 spawned_count = 0;
+  for (u32 i = 0; i < worker_count; i += 1) {
+    threads[i] = os_thread_create(_parallel_for_thread_entry, &ranges[i]);
+    if (threads[i].v[0] == 0) {
+      // NOTE(fz): Couldn't spawn, do the work here instead. Only real handles are joined below.
+      func(context, ranges[i].first, ranges[i].one_past_last);
+    } else {
+      thread_ptrs[spawned_count] = &threads[i];
+      spawned_count += 1;
+    }
+  }
+  
+  Parallel_For_Range* last = &ranges[worker_count];
+  func(context, last->first, last->one_past_last);
+  
+  os_thread_wait_for_join_all(thread_ptrs, spawned_count);
+}
@@ -0,0 +1,22 @@
+#ifndef F_PARALLEL_H
+#define F_PARALLEL_H
+
+#define PARALLEL_MAX_THREADS 64
+
+/* Processes the items in [first, one_past_last) */
+typedef void parallel_for_func(void* context, u64 first, u64 one_past_last);
+
+typedef struct Parallel_For_Range {
+  parallel_for_func* func;
+  void* context;
+  u64 first;
+  u64 one_past_last;
+} Parallel_For_Range;
+
+// NOTE(fz): Splits count items into contiguous ranges of at least min_batch_size and runs them on
+// worker threads, the caller takes the last range. Blocks until every range is done.
+// Workers get their own Thread_Context, so scratch arenas are available inside func.
+internal void parallel_for(u64 count, u64 min_batch_size, parallel_for_func* func, void* context);
+internal u32  parallel_for_thread_count(u64 count, u64 min_batch_size);
+
+#endif // F_PARALLEL_H
@@ -0,0 +1,692 @@
+//////////////////////////////////////////////
+// f32x4
+
+internal f32x4 f32x4_set(f32 x, f32 y, f32 z, f32 w) {
+#if SIMD_SSE
+  f32x4 result = _mm_setr_ps(x, y, z, w);
+#elif SIMD_NEON
+  f32 lanes[4] = { x, y, z, w };
+  f32x4 result = vld1q_f32(lanes);
+#else
+  f32x4 result = { x, y, z, w };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_splat(f32 value) {
+#if SIMD_SSE
+  f32x4 result = _mm_set1_ps(value);
+#elif SIMD_NEON
+  f32x4 result = vdupq_n_f32(value);
+#else
+  f32x4 result = { value, value, value, value };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_zero() {
+  f32x4 result = f32x4_splat(0.0f);
+  return result;
+}
+
+internal f32x4 f32x4_load(f32* ptr) {
+#if SIMD_SSE
+  f32x4 result = _mm_loadu_ps(ptr);
+#elif SIMD_NEON
+  f32x4 result = vld1q_f32(ptr);
+#else
+  f32x4 result = { ptr[0], ptr[1], ptr[2], ptr[3] };
+#endif
+  return result;
+}
+
+internal void f32x4_store(f32* ptr, f32x4 v) {
+#if SIMD_SSE
+  _mm_storeu_ps(ptr, v);
+#elif SIMD_NEON
+  vst1q_f32(ptr, v);
+#else
+  ptr[0] = v.v[0];
+  ptr[1] = v.v[1];
+  ptr[2] = v.v[2];
+  ptr[3] = v.v[3];
+#endif
+}
+
+internal f32 f32x4_lane(f32x4 v, u32 lane) {
+  f32 lanes[4];
+  f32x4_store(lanes, v);
+  return lanes[lane & 3];
+}
+
+internal f32 f32x4_first(f32x4 v) {
+#if SIMD_SSE
+  f32 result = _mm_cvtss_f32(v);
+#elif SIMD_NEON
+  f32 result = vgetq_lane_f32(v, 0);
+#else
+  f32 result = v.v[0];
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_add(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_add_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vaddq_f32(a, b);
+#else
+  f32x4 result = { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_sub(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_sub_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vsubq_f32(a, b);
+#else
+  f32x4 result = { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_mul(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_mul_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vmulq_f32(a, b);
+#else
+  f32x4 result = { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_div(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_div_ps(a, b);
+#elif SIMD_NEON && ARCH_ARM64
+  f32x4 result = vdivq_f32(a, b);
+#else
+  f32x4 result = f32x4_set(f32x4_lane(a, 0) / f32x4_lane(b, 0),
+                           f32x4_lane(a, 1) / f32x4_lane(b, 1),
+                           f32x4_lane(a, 2) / f32x4_lane(b, 2),
+                           f32x4_lane(a, 3) / f32x4_lane(b, 3));
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_madd(f32x4 a, f32x4 b, f32x4 c) {
+#if SIMD_FMA
+  f32x4 result = _mm_fmadd_ps(a, b, c);
+#elif SIMD_SSE
+  f32x4 result = _mm_add_ps(_mm_mul_ps(a, b), c);
+#elif SIMD_NEON
+  f32x4 result = vmlaq_f32(c, a, b);
+#else
+  f32x4 result = {
+    a.v[0]*b.v[0] + c.v[0],
+    a.v[1]*b.v[1] + c.v[1],
+    a.v[2]*b.v[2] + c.v[2],
+    a.v[3]*b.v[3] + c.v[3]
+  };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_min(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_min_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vminq_f32(a, b);
+#else
+  f32x4 result = { Min(a.v[0], b.v[0]), Min(a.v[1], b.v[1]), Min(a.v[2], b.v[2]), Min(a.v[3], b.v[3]) };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_max(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_max_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vmaxq_f32(a, b);
+#else
+  f32x4 result = { Max(a.v[0], b.v[0]), Max(a.v[1], b.v[1]), Max(a.v[2], b.v[2]), Max(a.v[3], b.v[3]) };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_sqrt(f32x4 v) {
+#if SIMD_SSE
+  f32x4 result = _mm_sqrt_ps(v);
+#elif SIMD_NEON && ARCH_ARM64
+  f32x4 result = vsqrtq_f32(v);
+#else
+  f32x4 result = f32x4_set(sqrtf(f32x4_lane(v, 0)), sqrtf(f32x4_lane(v, 1)), sqrtf(f32x4_lane(v, 2)), sqrtf(f32x4_lane(v, 3)));
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_abs(f32x4 v) {
+#if SIMD_SSE
+  f32x4 result = _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+#elif SIMD_NEON
+  f32x4 result = vabsq_f32(v);
+#else
+  f32x4 result = { fabsf(v.v[0]), fabsf(v.v[1]), fabsf(v.v[2]), fabsf(v.v[3]) };
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_round(f32x4 v) {
+#if SIMD_AVX
+  f32x4 result = _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#elif SIMD_NEON && ARCH_ARM64
+  f32x4 result = vrndnq_f32(v);
+#else
+  // NOTE(fz): Adding 1.5*2^23 pushes the fraction out of the mantissa, the FPU rounds it to nearest even.
+  f32x4 magic  = f32x4_splat(12582912.0f);
+  f32x4 result = f32x4_sub(f32x4_add(v, magic), magic);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_floor(f32x4 v) {
+#if SIMD_AVX
+  f32x4 result = _mm_floor_ps(v);
+#elif SIMD_NEON && ARCH_ARM64
+  f32x4 result = vrndmq_f32(v);
+#else
+  f32x4 rounded = f32x4_round(v);
+  f32x4 result  = f32x4_sub(rounded, f32x4_and(f32x4_cmp_gt(rounded, v), f32x4_splat(1.0f)));
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_rsqrt_estimate(f32x4 v) {
+#if SIMD_SSE
+  f32x4 result = _mm_rsqrt_ps(v);
+#elif SIMD_NEON
+  // vrsqrte is only ~8 bits, one step brings it in line with SSE
+  f32x4 result = vrsqrteq_f32(v);
+  result = vmulq_f32(result, vrsqrtsq_f32(vmulq_f32(v, result), result));
+#else
+  f32x4 result = { 1.0f/sqrtf(v.v[0]), 1.0f/sqrtf(v.v[1]), 1.0f/sqrtf(v.v[2]), 1.0f/sqrtf(v.v[3]) };
+#endif
+  return result;
+}
+
+internal f32x4 _f32x4_from_bits(u32 x, u32 y, u32 z, u32 w) {
+#if SIMD_SSE
+  f32x4 result = _mm_castsi128_ps(_mm_set_epi32((s32)w, (s32)z, (s32)y, (s32)x));
+#elif SIMD_NEON
+  u32 bits[4] = { x, y, z, w };
+  f32x4 result = vreinterpretq_f32_u32(vld1q_u32(bits));
+#else
+  f32x4 result;
+  result.u[0] = x;
+  result.u[1] = y;
+  result.u[2] = z;
+  result.u[3] = w;
+#endif
+  return result;
+}
+
+#if SIMD_SSE
+# define _F32x4Compare(name,sse,neon,op) internal f32x4 name(f32x4 a, f32x4 b) { return _mm_##sse##_ps(a, b); }
+#elif SIMD_NEON
+# define _F32x4Compare(name,sse,neon,op) internal f32x4 name(f32x4 a, f32x4 b) { return vreinterpretq_f32_u32(v##neon##q_f32(a, b)); }
+#else
+# define _F32x4Compare(name,sse,neon,op) internal f32x4 name(f32x4 a, f32x4 b) { \
+  return _f32x4_from_bits((a.v[0] op b.v[0]) ? U32_MAX : 0, (a.v[1] op b.v[1]) ? U32_MAX : 0, \
+                          (a.v[2] op b.v[2]) ? U32_MAX : 0, (a.v[3] op b.v[3]) ? U32_MAX : 0); }
+#endif
+
+_F32x4Compare(f32x4_cmp_eq, cmpeq, ceq, ==)
+_F32x4Compare(f32x4_cmp_lt, cmplt, clt, <)
+_F32x4Compare(f32x4_cmp_le, cmple, cle, <=)
+_F32x4Compare(f32x4_cmp_gt, cmpgt, cgt, >)
+_F32x4Compare(f32x4_cmp_ge, cmpge, cge, >=)
+
+internal f32x4 f32x4_cmp_neq(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_cmpneq_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(a, b)));
+#else
+  f32x4 result = _f32x4_from_bits((a.v[0] != b.v[0]) ? U32_MAX : 0, (a.v[1] != b.v[1]) ? U32_MAX : 0,
+                                  (a.v[2] != b.v[2]) ? U32_MAX : 0, (a.v[3] != b.v[3]) ? U32_MAX : 0);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_and(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_and_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+#else
+  f32x4 result = _f32x4_from_bits(a.u[0] & b.u[0], a.u[1] & b.u[1], a.u[2] & b.u[2], a.u[3] & b.u[3]);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_or(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_or_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+#else
+  f32x4 result = _f32x4_from_bits(a.u[0] | b.u[0], a.u[1] | b.u[1], a.u[2] | b.u[2], a.u[3] | b.u[3]);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_xor(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_xor_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+#else
+  f32x4 result = _f32x4_from_bits(a.u[0] ^ b.u[0], a.u[1] ^ b.u[1], a.u[2] ^ b.u[2], a.u[3] ^ b.u[3]);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_andnot(f32x4 a, f32x4 b) {
+#if SIMD_SSE
+  f32x4 result = _mm_andnot_ps(a, b);
+#elif SIMD_NEON
+  f32x4 result = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b), vreinterpretq_u32_f32(a)));
+#else
+  f32x4 result = _f32x4_from_bits(~a.u[0] & b.u[0], ~a.u[1] & b.u[1], ~a.u[2] & b.u[2], ~a.u[3] & b.u[3]);
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_select(f32x4 mask, f32x4 a, f32x4 b) {
+#if SIMD_AVX
+  f32x4 result = _mm_blendv_ps(b, a, mask);
+#elif SIMD_NEON
+  f32x4 result = vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+#else
+  f32x4 result = f32x4_or(f32x4_and(mask, a), f32x4_andnot(mask, b));
+#endif
+  return result;
+}
+
+internal u32 f32x4_mask_bits(f32x4 mask) {
+#if SIMD_SSE
+  u32 result = (u32)_mm_movemask_ps(mask);
+#else
+  f32 lanes[4];
+  f32x4_store(lanes, mask);
+  u32 result = 0;
+  for (u32 i = 0; i < 4; i += 1) {
+    u32 bits;
+    MemoryCopy(&bits, &lanes[i], sizeof(u32));
+    result |= (bits >> 31) << i;
+  }
+#endif
+  return result;
+}
+
+internal f32x4 f32x4_dot(f32x4 a, f32x4 b) {
+  f32x4 m = f32x4_mul(a, b);
+#if SIMD_SSE
+  // (x+y, x+y, z+w, z+w) then add the swapped halves
+  f32x4 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  f32x4 result = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+#elif SIMD_NEON && ARCH_ARM64
+  f32x4 result = vdupq_n_f32(vaddvq_f32(m));
+#else
+  f32x4 result = f32x4_splat(f32x4_lane(m, 0) + f32x4_lane(m, 1) + f32x4_lane(m, 2) + f32x4_lane(m, 3));
+#endif
+  return result;
+}
+
+internal f32 f32x4_hsum(f32x4 v) {
+#if SIMD_SSE
+  f32x4 s = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+  f32 result = _mm_cvtss_f32(s);
+#elif SIMD_NEON && ARCH_ARM64
+  f32 result = vaddvq_f32(v);
+#else
+  f32 result = f32x4_lane(v, 0) + f32x4_lane(v, 1) + f32x4_lane(v, 2) + f32x4_lane(v, 3);
+#endif
+  return result;
+}
+
+internal void f32x4_transpose(f32x4* r0, f32x4* r1, f32x4* r2, f32x4* r3) {
+#if SIMD_SSE
+  _MM_TRANSPOSE4_PS(*r0, *r1, *r2, *r3);
+#elif SIMD_NEON
+  float32x4x2_t t01 = vtrnq_f32(*r0, *r1);
+  float32x4x2_t t23 = vtrnq_f32(*r2, *r3);
+  *r0 = vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0]));
+  *r1 = vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1]));
+  *r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  *r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+#else
+  f32x4 a = *r0, b = *r1, c = *r2, d = *r3;
+  *r0 = f32x4_set(a.v[0], b.v[0], c.v[0], d.v[0]);
+  *r1 = f32x4_set(a.v[1], b.v[1], c.v[1], d.v[1]);
+  *r2 = f32x4_set(a.v[2], b.v[2], c.v[2], d.v[2]);
+  *r3 = f32x4_set(a.v[3], b.v[3], c.v[3], d.v[3]);
+#endif
+}
+
+internal void f32x4_load_xyz4(f32* ptr, f32x4* x, f32x4* y, f32x4* z) {
+#if SIMD_NEON
+  float32x4x3_t xyz = vld3q_f32(ptr);
+  *x = xyz.val[0];
+  *y = xyz.val[1];
+  *z = xyz.val[2];
+#else
+  // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+  f32x4 a = f32x4_load(ptr);
+  f32x4 b = f32x4_load(ptr + 4);
+  f32x4 c = f32x4_load(ptr + 8);
+  *x = F32x4Shuffle2(a, F32x4Shuffle2(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+  *y = F32x4Shuffle2(F32x4Shuffle2(a, b, 1, 1, 0, 0), F32x4Shuffle2(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+  *z = F32x4Shuffle2(F32x4Shuffle2(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+#endif
+}
+
+internal void f32x4_store_xyz4(f32* ptr, f32x4 x, f32x4 y, f32x4 z) {
+#if SIMD_NEON
+  float32x4x3_t xyz;
+  xyz.val[0] = x;
+  xyz.val[1] = y;
+  xyz.val[2] = z;
+  vst3q_f32(ptr, xyz);
+#else
+  f32x4 a = F32x4Shuffle2(F32x4Shuffle2(x, y, 0, 0, 0, 0), F32x4Shuffle2(z, x, 0, 0, 1, 1), 0, 2, 0, 2);
+  f32x4 b = F32x4Shuffle2(F32x4Shuffle2(y, z, 1, 1, 1, 1), F32x4Shuffle2(x, y, 2, 2, 2, 2), 0, 2, 0, 2);
+  f32x4 c = F32x4Shuffle2(F32x4Shuffle2(z, x, 2, 2, 3, 3), F32x4Shuffle2(y, z, 3, 3, 3, 3), 0, 2, 0, 2);
+  f32x4_store(ptr,     a);
+  f32x4_store(ptr + 4, b);
+  f32x4_store(ptr + 8, c);
+#endif
+}
+
+internal u32 f32x4_pack_unorm8(f32x4 v) {
+  v = f32x4_round(f32x4_mul(f32x4_min(f32x4_max(v, f32x4_zero()), f32x4_splat(1.0f)), f32x4_splat(255.0f)));
+#if SIMD_SSE
+  __m128i i32 = _mm_cvttps_epi32(v);
+  __m128i i16 = _mm_packs_epi32(i32, i32);
+  u32 result  = (u32)_mm_cvtsi128_si32(_mm_packus_epi16(i16, i16));
+#elif SIMD_NEON
+  uint16x4_t u16 = vmovn_u32(vcvtq_u32_f32(v));
+  u32 result     = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(u16, u16))), 0);
+#else
+  u32 result = ((u32)v.v[0]) | ((u32)v.v[1] << 8) | ((u32)v.v[2] << 16) | ((u32)v.v[3] << 24);
+#endif
+  return result;
+}
+
+internal u32 f32x4_pack_snorm8(f32x4 v) {
+  v = f32x4_round(f32x4_mul(f32x4_min(f32x4_max(v, f32x4_splat(-1.0f)), f32x4_splat(1.0f)), f32x4_splat(127.0f)));
+#if SIMD_SSE
+  __m128i i32 = _mm_cvttps_epi32(v);
+  __m128i i16 = _mm_packs_epi32(i32, i32);
+  u32 result  = (u32)_mm_cvtsi128_si32(_mm_packs_epi16(i16, i16));
+#elif SIMD_NEON
+  int16x4_t s16 = vmovn_s32(vcvtq_s32_f32(v));
+  u32 result    = vget_lane_u32(vreinterpret_u32_s8(vmovn_s16(vcombine_s16(s16, s16))), 0);
+#else
+  u32 result = ((u32)(u8)(s8)v.v[0]) | ((u32)(u8)(s8)v.v[1] << 8) | ((u32)(u8)(s8)v.v[2] << 16) | ((u32)(u8)(s8)v.v[3] << 24);
+#endif
+  return result;
+}
+
+internal u16 _f32_to_f16(f32 value) {
+  // NOTE(fz): Overflow goes to infinity and values under the half denormal range flush to zero.
+  u32 bits;
+  MemoryCopy(&bits, &value, sizeof(bits));
+  u32 sign     = (bits >> 16) & 0x8000;
+  s32 exponent = (s32)((bits >> 23) & 0xff) - 127 + 15;
+  u32 mantissa = bits & 0x7fffff;
+  
+  u16 result;
+  if (((bits >> 23) & 0xff) == 0xff) {
+    result = (u16)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+  } else if (exponent >= 31) {
+    result = (u16)(sign | 0x7c00);
+  } else if (exponent <= 0) {
+    if (exponent < -10) {
+      result = (u16)sign;
+    } else {
+      mantissa |= 0x800000;
+      u32 shift = (u32)(14 - exponent);
+      u32 half  = mantissa >> shift;
+      u32 rest  = mantissa & ((1u << shift) - 1);
+      u32 mid   = 1u << (shift - 1);
+      half += (rest > mid || (rest == mid && (half & 1)));
+      result = (u16)(sign | half);
+    }
+  } else {
+    u32 half = ((u32)exponent << 10) | (mantissa >> 13);
+    u32 rest = mantissa & 0x1fff;
+    half += (rest > 0x1000 || (rest == 0x1000 && (half & 1))); // Carry into the exponent is the correct rounding
+    result = (u16)(sign | half);
+  }
+  return result;
+}
+
+internal void f32x4_store_f16(u16* ptr, f32x4 v) {
+#if SIMD_F16C
+  _mm_storel_epi64((__m128i*)ptr, _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#elif SIMD_NEON && ARCH_ARM64
+  vst1_u16(ptr, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+#else
+  f32 lanes[4];
+  f32x4_store(lanes, v);
+  for (u32 i = 0; i < 4; i += 1) {
+    ptr[i] = _f32_to_f16(lanes[i]);
+  }
+#endif
+}
+
+//////////////////////////////////////////////
+// f32x8
+
+internal f32x8 f32x8_set(f32 a, f32 b, f32 c, f32 d, f32 e, f32 f, f32 g, f32 h) {
+#if SIMD_AVX
+  f32x8 result = _mm256_setr_ps(a, b, c, d, e, f, g, h);
+#else
+  f32x8 result = { f32x4_set(a, b, c, d), f32x4_set(e, f, g, h) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_splat(f32 value) {
+#if SIMD_AVX
+  f32x8 result = _mm256_set1_ps(value);
+#else
+  f32x8 result = { f32x4_splat(value), f32x4_splat(value) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_zero() {
+  f32x8 result = f32x8_splat(0.0f);
+  return result;
+}
+
+internal f32x8 f32x8_from_f32x4(f32x4 lo, f32x4 hi) {
+#if SIMD_AVX
+  f32x8 result = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+#else
+  f32x8 result = { lo, hi };
+#endif
+  return result;
+}
+
+internal f32x4 f32x8_lo(f32x8 v) {
+#if SIMD_AVX
+  f32x4 result = _mm256_castps256_ps128(v);
+#else
+  f32x4 result = v.lo;
+#endif
+  return result;
+}
+
+internal f32x4 f32x8_hi(f32x8 v) {
+#if SIMD_AVX
+  f32x4 result = _mm256_extractf128_ps(v, 1);
+#else
+  f32x4 result = v.hi;
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_load(f32* ptr) {
+#if SIMD_AVX
+  f32x8 result = _mm256_loadu_ps(ptr);
+#else
+  f32x8 result = { f32x4_load(ptr), f32x4_load(ptr + 4) };
+#endif
+  return result;
+}
+
+internal void f32x8_store(f32* ptr, f32x8 v) {
+#if SIMD_AVX
+  _mm256_storeu_ps(ptr, v);
+#else
+  f32x4_store(ptr,     v.lo);
+  f32x4_store(ptr + 4, v.hi);
+#endif
+}
+
+internal f32x8 f32x8_add(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_add_ps(a, b);
+#else
+  f32x8 result = { f32x4_add(a.lo, b.lo), f32x4_add(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_sub(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_sub_ps(a, b);
+#else
+  f32x8 result = { f32x4_sub(a.lo, b.lo), f32x4_sub(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_mul(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_mul_ps(a, b);
+#else
+  f32x8 result = { f32x4_mul(a.lo, b.lo), f32x4_mul(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_div(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_div_ps(a, b);
+#else
+  f32x8 result = { f32x4_div(a.lo, b.lo), f32x4_div(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_madd(f32x8 a, f32x8 b, f32x8 c) {
+#if SIMD_FMA
+  f32x8 result = _mm256_fmadd_ps(a, b, c);
+#elif SIMD_AVX
+  f32x8 result = _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#else
+  f32x8 result = { f32x4_madd(a.lo, b.lo, c.lo), f32x4_madd(a.hi, b.hi, c.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_min(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_min_ps(a, b);
+#else
+  f32x8 result = { f32x4_min(a.lo, b.lo), f32x4_min(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_max(f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_max_ps(a, b);
+#else
+  f32x8 result = { f32x4_max(a.lo, b.lo), f32x4_max(a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal f32x8 f32x8_sqrt(f32x8 v) {
+#if SIMD_AVX
+  f32x8 result = _mm256_sqrt_ps(v);
+#else
+  f32x8 result = { f32x4_sqrt(v.lo), f32x4_sqrt(v.hi) };
+#endif
+  return result;
+}
+
+#if SIMD_AVX
+# define _F32x8Unary(name,avx,f32x4_op) internal f32x8 name(f32x8 v) { return avx; }
+# define _F32x8Binary(name,avx,f32x4_op) internal f32x8 name(f32x8 a, f32x8 b) { return avx; }
+#else
+# define _F32x8Unary(name,avx,f32x4_op) internal f32x8 name(f32x8 v) { f32x8 result = { f32x4_op(v.lo), f32x4_op(v.hi) }; return result; }
+# define _F32x8Binary(name,avx,f32x4_op) internal f32x8 name(f32x8 a, f32x8 b) { f32x8 result = { f32x4_op(a.lo, b.lo), f32x4_op(a.hi, b.hi) }; return result; }
+#endif
+
+_F32x8Unary(f32x8_abs,    _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v),                            f32x4_abs)
+_F32x8Unary(f32x8_round,  _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC),     f32x4_round)
+_F32x8Unary(f32x8_floor,  _mm256_floor_ps(v),                                                    f32x4_floor)
+_F32x8Unary(f32x8_rsqrt_estimate, _mm256_rsqrt_ps(v),                                            f32x4_rsqrt_estimate)
+
+_F32x8Binary(f32x8_cmp_eq,  _mm256_cmp_ps(a, b, _CMP_EQ_OQ),  f32x4_cmp_eq)
+_F32x8Binary(f32x8_cmp_neq, _mm256_cmp_ps(a, b, _CMP_NEQ_UQ), f32x4_cmp_neq)
+_F32x8Binary(f32x8_cmp_lt,  _mm256_cmp_ps(a, b, _CMP_LT_OQ),  f32x4_cmp_lt)
+_F32x8Binary(f32x8_cmp_le,  _mm256_cmp_ps(a, b, _CMP_LE_OQ),  f32x4_cmp_le)
+_F32x8Binary(f32x8_cmp_gt,  _mm256_cmp_ps(a, b, _CMP_GT_OQ),  f32x4_cmp_gt)
+_F32x8Binary(f32x8_cmp_ge,  _mm256_cmp_ps(a, b, _CMP_GE_OQ),  f32x4_cmp_ge)
+_F32x8Binary(f32x8_and,     _mm256_and_ps(a, b),              f32x4_and)
+_F32x8Binary(f32x8_or,      _mm256_or_ps(a, b),               f32x4_or)
+_F32x8Binary(f32x8_xor,     _mm256_xor_ps(a, b),              f32x4_xor)
+_F32x8Binary(f32x8_andnot,  _mm256_andnot_ps(a, b),           f32x4_andnot)
+
+internal f32x8 f32x8_select(f32x8 mask, f32x8 a, f32x8 b) {
+#if SIMD_AVX
+  f32x8 result = _mm256_blendv_ps(b, a, mask);
+#else
+  f32x8 result = { f32x4_select(mask.lo, a.lo, b.lo), f32x4_select(mask.hi, a.hi, b.hi) };
+#endif
+  return result;
+}
+
+internal u32 f32x8_mask_bits(f32x8 mask) {
+#if SIMD_AVX
+  u32 result = (u32)_mm256_movemask_ps(mask);
+#else
+  u32 result = f32x4_mask_bits(mask.lo) | (f32x4_mask_bits(mask.hi) << 4);
+#endif
+  return result;
+}
+
+internal void f32x8_load_xyz8(f32* ptr, f32x8* x, f32x8* y, f32x8* z) {
+  f32x4 x0, y0, z0, x1, y1, z1;
+  f32x4_load_xyz4(ptr,      &x0, &y0, &z0);
+  f32x4_load_xyz4(ptr + 12, &x1, &y1, &z1);
+  *x = f32x8_from_f32x4(x0, x1);
+  *y = f32x8_from_f32x4(y0, y1);
+  *z = f32x8_from_f32x4(z0, z1);
+}
+
+internal void f32x8_store_xyz8(f32* ptr, f32x8 x, f32x8 y, f32x8 z) {
+  f32x4_store_xyz4(ptr,      f32x8_lo(x), f32x8_lo(y), f32x8_lo(z));
+  f32x4_store_xyz4(ptr + 12, f32x8_hi(x), f32x8_hi(y), f32x8_hi(z));
+}
@@ -0,0 +1,149 @@
+#ifndef F_SIMD_H
+#define F_SIMD_H
+
+// NOTE(fz): Thin wrappers over the platform intrinsics so f_math can be written once.
+// Backend is picked by the SIMD_* macros in f_core.h. The scalar fallback uses plain
+// structs, which the compiler is free to auto-vectorize.
+
+#if SIMD_SSE
+# include <immintrin.h>
+#elif SIMD_NEON
+# include <arm_neon.h>
+#endif
+
+//~ f32x4
+
+#if SIMD_SSE
+typedef __m128 f32x4;
+#elif SIMD_NEON
+typedef float32x4_t f32x4;
+#else
+typedef struct f32x4 {
+  union {
+    f32 v[4];
+    u32 u[4]; /* Bit patterns, for masks */
+  };
+} f32x4;
+#endif
+
+internal f32x4 f32x4_set(f32 x, f32 y, f32 z, f32 w);
+internal f32x4 f32x4_splat(f32 value);
+internal f32x4 f32x4_zero();
+internal f32x4 f32x4_load(f32* ptr); /* Unaligned */
+internal void  f32x4_store(f32* ptr, f32x4 v); /* Unaligned */
+internal f32   f32x4_lane(f32x4 v, u32 lane);
+internal f32   f32x4_first(f32x4 v);
+
+internal f32x4 f32x4_add(f32x4 a, f32x4 b);
+internal f32x4 f32x4_sub(f32x4 a, f32x4 b);
+internal f32x4 f32x4_mul(f32x4 a, f32x4 b);
+internal f32x4 f32x4_div(f32x4 a, f32x4 b);
+internal f32x4 f32x4_madd(f32x4 a, f32x4 b, f32x4 c); /* a*b + c */
+internal f32x4 f32x4_min(f32x4 a, f32x4 b);
+internal f32x4 f32x4_max(f32x4 a, f32x4 b);
+internal f32x4 f32x4_sqrt(f32x4 v);
+
+internal f32x4 f32x4_abs(f32x4 v);
+internal f32x4 f32x4_round(f32x4 v); /* Nearest, ties to even. Exact for |v| < 2^22 */
+internal f32x4 f32x4_floor(f32x4 v); /* Exact for |v| < 2^22 */
+internal f32x4 f32x4_rsqrt_estimate(f32x4 v); /* ~12 bits, refine with a Newton step */
+
+// NOTE(fz): Masks are f32x4 with every bit of a lane set (true) or cleared (false).
+internal f32x4 f32x4_cmp_eq(f32x4 a, f32x4 b);
+internal f32x4 f32x4_cmp_neq(f32x4 a, f32x4 b);
+internal f32x4 f32x4_cmp_lt(f32x4 a, f32x4 b);
+internal f32x4 f32x4_cmp_le(f32x4 a, f32x4 b);
+internal f32x4 f32x4_cmp_gt(f32x4 a, f32x4 b);
+internal f32x4 f32x4_cmp_ge(f32x4 a, f32x4 b);
+internal f32x4 f32x4_and(f32x4 a, f32x4 b);
+internal f32x4 f32x4_or(f32x4 a, f32x4 b);
+internal f32x4 f32x4_xor(f32x4 a, f32x4 b);
+internal f32x4 f32x4_andnot(f32x4 a, f32x4 b); /* ~a & b */
+internal f32x4 f32x4_select(f32x4 mask, f32x4 a, f32x4 b); /* mask ? a : b */
+internal u32   f32x4_mask_bits(f32x4 mask); /* Bit i set when lane i is true */
+
+internal f32x4 f32x4_dot(f32x4 a, f32x4 b); /* Dot product broadcast to every lane */
+internal f32   f32x4_hsum(f32x4 v);
+internal void  f32x4_transpose(f32x4* r0, f32x4* r1, f32x4* r2, f32x4* r3);
+
+/* Packed xyz triplets (e.g. 4 Vector3) <-> one register per component */
+internal void f32x4_load_xyz4(f32* ptr, f32x4* x, f32x4* y, f32x4* z);
+internal void f32x4_store_xyz4(f32* ptr, f32x4 x, f32x4 y, f32x4 z);
+
+/* Quantization, lane i ends up in byte i. Clamped, then rounded to nearest */
+internal u32  f32x4_pack_unorm8(f32x4 v); /* [0, 1]  -> [0, 255] */
+internal u32  f32x4_pack_snorm8(f32x4 v); /* [-1, 1] -> [-127, 127] */
+internal void f32x4_store_f16(u16* ptr, f32x4 v); /* IEEE half, round to nearest even */
+
+#if SIMD_SSE
+# define F32x4Shuffle(v,x,y,z,w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w),(z),(y),(x)))
+#else
+# define F32x4Shuffle(v,x,y,z,w) f32x4_set(f32x4_lane((v),(x)), f32x4_lane((v),(y)), f32x4_lane((v),(z)), f32x4_lane((v),(w)))
+#endif
+
+/* (a[x], a[y], b[z], b[w]) */
+#if SIMD_SSE
+# define F32x4Shuffle2(a,b,x,y,z,w) _mm_shuffle_ps((a), (b), _MM_SHUFFLE((w),(z),(y),(x)))
+#else
+# define F32x4Shuffle2(a,b,x,y,z,w) f32x4_set(f32x4_lane((a),(x)), f32x4_lane((a),(y)), f32x4_lane((b),(z)), f32x4_lane((b),(w)))
+#endif
+
+//~ f32x8
+
+#if SIMD_AVX
+typedef __m256 f32x8;
+#else
+typedef struct f32x8 {
+  f32x4 lo;
+  f32x4 hi;
+} f32x8;
+#endif
+
+internal f32x8 f32x8_set(f32 a, f32 b, f32 c, f32 d, f32 e, f32 f, f32 g, f32 h);
+internal f32x8 f32x8_splat(f32 value);
+internal f32x8 f32x8_zero();
+internal f32x8 f32x8_from_f32x4(f32x4 lo, f32x4 hi);
+internal f32x4 f32x8_lo(f32x8 v);
+internal f32x4 f32x8_hi(f32x8 v);
+internal f32x8 f32x8_load(f32* ptr); /* Unaligned */
+internal void  f32x8_store(f32* ptr, f32x8 v); /* Unaligned */
+
+internal f32x8 f32x8_add(f32x8 a, f32x8 b);
+internal f32x8 f32x8_sub(f32x8 a, f32x8 b);
+internal f32x8 f32x8_mul(f32x8 a, f32x8 b);
+internal f32x8 f32x8_div(f32x8 a, f32x8 b);
+internal f32x8 f32x8_madd(f32x8 a, f32x8 b, f32x8 c); /* a*b + c */
+internal f32x8 f32x8_min(f32x8 a, f32x8 b);
+internal f32x8 f32x8_max(f32x8 a, f32x8 b);
+internal f32x8 f32x8_sqrt(f32x8 v);
+
+internal f32x8 f32x8_abs(f32x8 v);
+internal f32x8 f32x8_round(f32x8 v);
+internal f32x8 f32x8_floor(f32x8 v);
+internal f32x8 f32x8_rsqrt_estimate(f32x8 v);
+
+/* Same mask convention as f32x4 */
+internal f32x8 f32x8_cmp_eq(f32x8 a, f32x8 b);
+internal f32x8 f32x8_cmp_neq(f32x8 a, f32x8 b);
+internal f32x8 f32x8_cmp_lt(f32x8 a, f32x8 b);
+internal f32x8 f32x8_cmp_le(f32x8 a, f32x8 b);
+internal f32x8 f32x8_cmp_gt(f32x8 a, f32x8 b);
+internal f32x8 f32x8_cmp_ge(f32x8 a, f32x8 b);
+internal f32x8 f32x8_and(f32x8 a, f32x8 b);
+internal f32x8 f32x8_or(f32x8 a, f32x8 b);
+internal f32x8 f32x8_xor(f32x8 a, f32x8 b);
+internal f32x8 f32x8_andnot(f32x8 a, f32x8 b); /* ~a & b */
+internal f32x8 f32x8_select(f32x8 mask, f32x8 a, f32x8 b); /* mask ? a : b */
+internal u32   f32x8_mask_bits(f32x8 mask); /* Bit i set when lane i is true */
+
+internal void f32x8_load_xyz8(f32* ptr, f32x8* x, f32x8* y, f32x8* z);
+internal void f32x8_store_xyz8(f32* ptr, f32x8 x, f32x8 y, f32x8 z);
+
+/* Shuffles inside each 128-bit half, i.e. both halves get the same x,y,z,w pattern */
+#if SIMD_AVX
+# define F32x8Shuffle(v,x,y,z,w) _mm256_permute_ps((v), _MM_SHUFFLE((w),(z),(y),(x)))
+#else
+# define F32x8Shuffle(v,x,y,z,w) f32x8_from_f32x4(F32x4Shuffle(f32x8_lo(v),(x),(y),(z),(w)), F32x4Shuffle(f32x8_hi(v),(x),(y),(z),(w)))
+#endif
+
+#endif // F_SIMD_H
@@ -5,8 +5,23 @@ int main(int argc, char** argv) {
   Thread_Context main_thread_context;
   thread_context_init_and_attach(&main_thread_context);
   
-  program_init();
-  renderer_init(GProgram.window_width, GProgram.window_height);
+  // NOTE(fz): -software <file.ppm> draws a single frame on the CPU, with no window or GL context, and writes it out.
+  String software_output = { 0 };
+  for (s32 i = 1; i < argc; i += 1) {
+    String arg = string_new(strlen(argv[i]), (u8*)argv[i]);
+    if (strings_match(arg, StringLiteral("-software")) && i + 1 < argc) {
+      i += 1;
+      software_output = string_new(strlen(argv[i]), (u8*)argv[i]);
+    }
+  }
+  b32 headless = software_output.size > 0;
+  
+  program_init(!headless);
+  if (headless) {
+    renderer_init_software(GProgram.window_width, GProgram.window_height);
+  } else {
+    renderer_init(GProgram.window_width, GProgram.window_height);
+  }
   
   f32 texture_red   = renderer_load_color_texture(1.0, 0.0, 0.0, 1.0);
   f32 texture_green = renderer_load_color_texture(0.0, 1.0, 0.0, 1.0);
@@ -18,11 +33,46 @@ int main(int argc, char** argv) {
   renderer_push_line(vector3( 0.0f,  0.0f, -8.0f), vector3(0.0f, 0.0f, 8.0f), texture_blue);
 
   Model model = renderer_load_obj(StringLiteral("D:\\work\\namefull\\resources\\crate.obj"));
+  
+  if (headless) {
+    camera_set_perspective(&GProgram.camera, Radians(CAMERA_FOVY), GProgram.window_width, GProgram.window_height, GProgram.near_plane, GProgram.far_plane);
+    renderer_push_instance(&model, model.transform);
+    renderer_draw(camera_get_view(&GProgram.camera), camera_get_projection(&GProgram.camera), GProgram.window_width, GProgram.window_height, 0.0f);
+    if (!renderer_software_write_ppm(software_output)) {
+      printf("Failed to write %s\n", software_output.str);
+      return 1;
+    }
+    return 0;
+  }
 
   while (GProgram.is_running) {
     program_tick();
+    
+    // NOTE(fz): Only what survives culling can be picked or drawn.
+    Frustum frustum = camera_get_frustum(&GProgram.camera);
+    u32 visible_model;
+    u32 visible_count = renderer_cull_models(&frustum, &model, 1, &visible_model);
+    
+    if (visible_count > 0) {
+      renderer_push_instance(&model, model.transform);
+    }
+    
+    if (GProgram.camera.mode == CameraMode_Select && visible_count > 0) {
+      GProgram.picked = renderer_intersect_ray_with_model(&model, ray(GProgram.camera.position, GProgram.raycast), &GProgram.picked_mesh);
+    } else {
+      MemoryZeroStruct(&GProgram.picked);
+    }
+
+    // Marker on the picked point, rebuilt every frame through the stream buffer
+    if (GProgram.picked.hit) {
+      Vector3 p = vector3_add(GProgram.camera.position, vector3_scale(GProgram.raycast, GProgram.picked.t));
+      f32 size  = 0.1f;
+      renderer_push_stream_line(vector3(p.x - size, p.y, p.z), vector3(p.x + size, p.y, p.z), texture_yell);
+      renderer_push_stream_line(vector3(p.x, p.y - size, p.z), vector3(p.x, p.y + size, p.z), texture_yell);
+      renderer_push_stream_line(vector3(p.x, p.y, p.z - size), vector3(p.x, p.y, p.z + size), texture_yell);
+    }
 
-    renderer_draw(GProgram.view, GProgram.projection, GProgram.window_width, GProgram.window_height);
+    renderer_draw(camera_get_view(&GProgram.camera), camera_get_projection(&GProgram.camera), GProgram.window_width, GProgram.window_height, (f32)GProgram.current_time);
 
     glfwSwapBuffers(GProgram.window);
   }
@@ -34,10 +84,8 @@ internal void program_tick() {
   input_update(); 
   glfwPollEvents();
   
-  GProgram.view = matrix4_look_at(GProgram.camera.position, vector3_add(GProgram.camera.position, GProgram.camera.front), GProgram.camera.up);
-  GProgram.projection = matrix4_perspective(Radians(45), GProgram.window_width, GProgram.window_height, GProgram.near_plane, GProgram.far_plane);
-  
   camera_update(&GProgram.camera, GProgram.delta_time);
+  camera_set_perspective(&GProgram.camera, Radians(CAMERA_FOVY), GProgram.window_width, GProgram.window_height, GProgram.near_plane, GProgram.far_plane);
   
   GProgram.current_time = glfwGetTime();
   GProgram.delta_time   = GProgram.current_time - GProgram.last_time;;
@@ -47,7 +95,7 @@ internal void program_tick() {
     f32 mouse_x_ndc = (2.0f * InputState.mouse_current.screen_space_x) / GProgram.window_width - 1.0f;
     f32 mouse_y_ndc = 1.0f - (2.0f * InputState.mouse_current.screen_space_y) / GProgram.window_height;
     
-    Vector3 unproject_mouse = vector3_unproject(vector3(mouse_x_ndc, mouse_y_ndc, 1.0f), GProgram.projection, GProgram.view);
+    Vector3 unproject_mouse = vector3_unproject_inverse(vector3(mouse_x_ndc, mouse_y_ndc, 1.0f), camera_get_inverse_view_projection(&GProgram.camera));
     GProgram.raycast = vector3_normalize(sub(vector3(unproject_mouse.x, unproject_mouse.y, unproject_mouse.z), vector3(GProgram.camera.position.x, GProgram.camera.position.y, GProgram.camera.position.z)));
   } else {
     GProgram.raycast = vector3(F32_MAX, F32_MAX, F32_MAX);
@@ -58,26 +106,26 @@ internal void program_tick() {
   }
 }
 
-internal void  program_init() {
+internal void  program_init(b32 window) {
   AssertNoReentry();
   MemoryZeroStruct(&GProgram);
   
   GProgram.window_width  = 1280;
   GProgram.window_height = 720;
   
-  GProgram.view       = matrix4(1.0f);
-  GProgram.projection = matrix4(1.0f);
-  
   GProgram.current_time = 0.0f;
   GProgram.delta_time   = 0.0f;
   GProgram.last_time    = 0.0f;
   
-  GProgram.near_plane = 0.1;
-  GProgram.far_plane  = 100.0f;
+  GProgram.near_plane = CAMERA_NEAR_PLANE;
+  GProgram.far_plane  = CAMERA_FAR_PLANE;
   GProgram.is_running = true;
   
   GProgram.camera      = camera_init();
   input_init(GProgram.window_width, GProgram.window_height);
+  if (!window) {
+    return;
+  }
   
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
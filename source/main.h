@@ -22,6 +22,8 @@
 //~ *.h
 #include "input.h"
 #include "camera.h"
+#include "occlusion.h"
+#include "renderer_software.h"
 #include "renderer.h"
 
 //~ Third-party source
@@ -33,7 +35,9 @@
 //~ *.c
 #include "input.c"
 #include "camera.c"
+#include "occlusion.c"
 #include "renderer.c"
+#include "renderer_software.c"
 
 //~ Program
 
@@ -44,9 +48,6 @@ typedef struct Program {
   
   Camera camera;
   
-  Matrix4 view;
-  Matrix4 projection;
-  
   f64 current_time;
   f64 delta_time;
   f64 last_time;
@@ -55,12 +56,14 @@ typedef struct Program {
   f32 far_plane;
   
   Vector3 raycast;
+  Ray_Hit picked;
+  u32     picked_mesh;
   b32 is_running;
 } Program;
 
 Program GProgram;
 
-internal void program_init();
+internal void program_init(b32 window); /* Without a window only the program state is set up, see -software */
 internal void program_tick();
 
 // Glfw 
@@ -0,0 +1,211 @@
+internal Occlusion_Buffer occlusion_init(u32 width, u32 height) {
+  Occlusion_Buffer result = { 0 };
+  result.arena   = arena_init();
+  result.width   = AlignPow2(Max(width, 1), Occlusion_Tile_Size);
+  result.height  = AlignPow2(Max(height, 1), Occlusion_Tile_Size);
+  result.tiles_x = result.width  / Occlusion_Tile_Size;
+  result.tiles_y = result.height / Occlusion_Tile_Size;
+  result.depth    = ArenaPushNoZero(result.arena, f32, result.width*result.height);
+  result.tile_max = ArenaPushNoZero(result.arena, f32, result.tiles_x*result.tiles_y);
+  for (u32 i = 0; i < result.width*result.height; i += 1)   result.depth[i]    = 1.0f;
+  for (u32 i = 0; i < result.tiles_x*result.tiles_y; i += 1) result.tile_max[i] = 1.0f;
+  
+  result.view_projection    = matrix4(1.0f);
+  result.triangles_capacity = Max_Occluder_Triangles;
+  result.triangles          = ArenaPushNoZero(result.arena, Occlusion_Triangle, result.triangles_capacity);
+  return result;
+}
+
+internal void occlusion_free(Occlusion_Buffer* buffer) {
+  arena_free(buffer->arena);
+  MemoryZeroStruct(buffer);
+}
+
+internal void occlusion_begin(Occlusion_Buffer* buffer, Matrix4 view_projection) {
+  buffer->view_projection = view_projection;
+  buffer->triangles_count = 0;
+}
+
+internal void occlusion_push_triangles(Occlusion_Buffer* buffer, Vector3* vertices, u32 vertex_count, u32* indices, u32 triangle_count, Matrix4 transform) {
+  // NOTE(fz): Past the capacity the rest of the occluders are skipped, that only lets more through like dropped ones.
+  if (triangle_count == 0 || buffer->triangles_count >= buffer->triangles_capacity) {
+    return;
+  }
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  Vector4* clip = ArenaPushNoZero(scratch.arena, Vector4, vertex_count);
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    clip[i] = vector4(vertices[i].x, vertices[i].y, vertices[i].z, 1.0f);
+  }
+  transform_vector4_array_parallel(matrix4_mul(transform, buffer->view_projection), clip, clip, vertex_count);
+  
+  // NOTE(fz): No clipping, a triangle crossing the near plane is simply not an occluder. Dropping occluders only ever
+  // lets more through, never less.
+  Vector3* screen  = ArenaPushNoZero(scratch.arena, Vector3, vertex_count);
+  b8*      dropped = ArenaPushNoZero(scratch.arena, b8, vertex_count);
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    Vector4 p = clip[i];
+    dropped[i] = p.w < Occlusion_Near_W || p.z < -p.w;
+    if (!dropped[i]) {
+      f32 inverse_w = 1.0f / p.w;
+      screen[i] = vector3((p.x*inverse_w*0.5f + 0.5f) * (f32)buffer->width,
+                          (p.y*inverse_w*0.5f + 0.5f) * (f32)buffer->height,
+                          Min(p.z*inverse_w*0.5f + 0.5f, 1.0f));
+    }
+  }
+  
+  for (u32 t = 0; t < triangle_count; t += 1) {
+    u32* tri = indices + t*3;
+    if (dropped[tri[0]] || dropped[tri[1]] || dropped[tri[2]]) {
+      continue;
+    }
+    Vector3 p0 = screen[tri[0]];
+    Vector3 p1 = screen[tri[1]];
+    Vector3 p2 = screen[tri[2]];
+    
+    if (buffer->triangles_count >= buffer->triangles_capacity) {
+      break;
+    }
+    Occlusion_Triangle* triangle = &buffer->triangles[buffer->triangles_count];
+    f32 area = raster_triangle_setup(&triangle->raster, vector2(p0.x, p0.y), vector2(p1.x, p1.y), vector2(p2.x, p2.y), (s32)buffer->width, (s32)buffer->height);
+    if (area == 0.0f) {
+      continue;
+    }
+    buffer->triangles_count += 1;
+    
+    // Depth plane through the three vertices, moved to its furthest point inside each pixel
+    f32 dx1 = p1.x - p0.x, dy1 = p1.y - p0.y, dz1 = p1.z - p0.z;
+    f32 dx2 = p2.x - p0.x, dy2 = p2.y - p0.y, dz2 = p2.z - p0.z;
+    triangle->z_dx  = (dz1*dy2 - dz2*dy1) / area;
+    triangle->z_dy  = (dx1*dz2 - dx2*dz1) / area;
+    triangle->z_c   = p0.z - triangle->z_dx*(p0.x - 0.5f) - triangle->z_dy*(p0.y - 0.5f) + 0.5f*(fabsf(triangle->z_dx) + fabsf(triangle->z_dy));
+    triangle->z_max = Max(p0.z, Max(p1.z, p2.z));
+  }
+  scratch_end(&scratch);
+}
+
+/* One band of tile rows: clear, draw every triangle reaching it 8 pixels at a time, then rebuild the tile maxima */
+internal void _occlusion_rasterize_tile_rows(void* context, u64 first, u64 one_past_last) {
+  Occlusion_Buffer* buffer = (Occlusion_Buffer*)context;
+  s32 row_first = (s32)first*Occlusion_Tile_Size;
+  s32 row_last  = (s32)one_past_last*Occlusion_Tile_Size - 1;
+  
+  f32x8 far = f32x8_splat(1.0f);
+  for (s32 y = row_first; y <= row_last; y += 1) {
+    for (u32 x = 0; x < buffer->width; x += 8) {
+      f32x8_store(buffer->depth + y*buffer->width + x, far);
+    }
+  }
+  
+  f32x8 zero = f32x8_zero();
+  f32x8 lane = f32x8_set(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  for (u32 i = 0; i < buffer->triangles_count; i += 1) {
+    Occlusion_Triangle* triangle = &buffer->triangles[i];
+    Raster_Triangle*    raster   = &triangle->raster;
+    if (raster->max_y < row_first || raster->min_y > row_last) {
+      continue;
+    }
+    s32 y0 = Max(raster->min_y, row_first);
+    s32 y1 = Min(raster->max_y, row_last);
+    s32 x0 = raster->min_x & ~7;
+    
+    f32x8 a0 = f32x8_splat(raster->edge_a[0]), a1 = f32x8_splat(raster->edge_a[1]), a2 = f32x8_splat(raster->edge_a[2]);
+    f32x8 z_dx  = f32x8_splat(triangle->z_dx);
+    f32x8 z_max = f32x8_splat(triangle->z_max);
+    for (s32 y = y0; y <= y1; y += 1) {
+      f32x8 c0 = f32x8_splat(raster->edge_b[0]*(f32)y + raster->edge_c[0]);
+      f32x8 c1 = f32x8_splat(raster->edge_b[1]*(f32)y + raster->edge_c[1]);
+      f32x8 c2 = f32x8_splat(raster->edge_b[2]*(f32)y + raster->edge_c[2]);
+      f32x8 z_row = f32x8_splat(triangle->z_dy*(f32)y + triangle->z_c);
+      f32* row = buffer->depth + y*buffer->width;
+      for (s32 x = x0; x <= raster->max_x; x += 8) {
+        f32x8 px = f32x8_add(f32x8_splat((f32)x), lane);
+        f32x8 inside = f32x8_and(f32x8_and(f32x8_cmp_ge(f32x8_madd(a0, px, c0), zero),
+                                           f32x8_cmp_ge(f32x8_madd(a1, px, c1), zero)),
+                                 f32x8_cmp_ge(f32x8_madd(a2, px, c2), zero));
+        if (f32x8_mask_bits(inside) == 0) {
+          continue;
+        }
+        f32x8 z   = f32x8_min(f32x8_madd(z_dx, px, z_row), z_max);
+        f32x8 old = f32x8_load(row + x);
+        f32x8_store(row + x, f32x8_select(inside, f32x8_min(old, z), old));
+      }
+    }
+  }
+  
+  for (u32 ty = (u32)first; ty < (u32)one_past_last; ty += 1) {
+    for (u32 tx = 0; tx < buffer->tiles_x; tx += 1) {
+      f32* tile = buffer->depth + ty*Occlusion_Tile_Size*buffer->width + tx*Occlusion_Tile_Size;
+      f32x8 furthest = f32x8_load(tile);
+      for (u32 y = 1; y < Occlusion_Tile_Size; y += 1) {
+        furthest = f32x8_max(furthest, f32x8_load(tile + y*buffer->width));
+      }
+      f32x4 half = f32x4_max(f32x8_lo(furthest), f32x8_hi(furthest));
+      half = f32x4_max(half, F32x4Shuffle(half, 2, 3, 0, 1));
+      half = f32x4_max(half, F32x4Shuffle(half, 1, 0, 3, 2));
+      buffer->tile_max[ty*buffer->tiles_x + tx] = f32x4_first(half);
+    }
+  }
+}
+
+internal void occlusion_rasterize(Occlusion_Buffer* buffer) {
+  // NOTE(fz): Threads own whole tile rows, so no two of them ever write the same pixel.
+  parallel_for(buffer->tiles_y, 1, _occlusion_rasterize_tile_rows, buffer);
+}
+
+internal b32 occlusion_test_aabb(Occlusion_Buffer* buffer, AABB box, Matrix4 model_view_projection) {
+  if (aabb_is_empty(box)) {
+    return false;
+  }
+  
+  f32 min_x = F32_MAX, max_x = -F32_MAX;
+  f32 min_y = F32_MAX, max_y = -F32_MAX;
+  f32 min_z = F32_MAX;
+  for (u32 i = 0; i < 8; i += 1) {
+    Vector4 corner = vector4((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z, 1.0f);
+    Vector4 p = mul_vector4_matrix4(corner, model_view_projection);
+    if (p.w < Occlusion_Near_W || p.z < -p.w) {
+      return true; // Reaches the camera, nothing can be in front of it
+    }
+    f32 inverse_w = 1.0f / p.w;
+    f32 x = (p.x*inverse_w*0.5f + 0.5f) * (f32)buffer->width;
+    f32 y = (p.y*inverse_w*0.5f + 0.5f) * (f32)buffer->height;
+    min_x = Min(min_x, x);
+    max_x = Max(max_x, x);
+    min_y = Min(min_y, y);
+    max_y = Max(max_y, y);
+    min_z = Min(min_z, p.z*inverse_w*0.5f + 0.5f);
+  }
+  
+  // Every pixel the projected rectangle touches
+  if (max_x < 0.0f || max_y < 0.0f || min_x >= (f32)buffer->width || min_y >= (f32)buffer->height) {
+    return false;
+  }
+  s32 x0 = Max((s32)floorf(min_x), 0), x1 = Min((s32)floorf(max_x), (s32)buffer->width  - 1);
+  s32 y0 = Max((s32)floorf(min_y), 0), y1 = Min((s32)floorf(max_y), (s32)buffer->height - 1);
+  
+  f32x8 nearest = f32x8_splat(min_z);
+  for (s32 ty = y0 / Occlusion_Tile_Size; ty <= y1 / Occlusion_Tile_Size; ty += 1) {
+    for (s32 tx = x0 / Occlusion_Tile_Size; tx <= x1 / Occlusion_Tile_Size; tx += 1) {
+      if (buffer->tile_max[ty*buffer->tiles_x + tx] < min_z) {
+        continue;
+      }
+      s32 tile_x = tx*Occlusion_Tile_Size;
+      s32 tile_y = ty*Occlusion_Tile_Size;
+      s32 first_column = Max(x0 - tile_x, 0), last_column = Min(x1 - tile_x, Occlusion_Tile_Size - 1);
+      s32 first_row    = Max(y0 - tile_y, 0), last_row    = Min(y1 - tile_y, Occlusion_Tile_Size - 1);
+      if (first_column == 0 && last_column == Occlusion_Tile_Size - 1 && first_row == 0 && last_row == Occlusion_Tile_Size - 1) {
+        return true; // The whole tile is inside, its furthest pixel is behind the box
+      }
+      
+      u32 columns = ((1u << (last_column + 1)) - 1) & ~((1u << first_column) - 1);
+      for (s32 y = tile_y + first_row; y <= tile_y + last_row; y += 1) {
+        f32x8 depth = f32x8_load(buffer->depth + y*buffer->width + tile_x);
+        if (f32x8_mask_bits(f32x8_cmp_ge(depth, nearest)) & columns) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
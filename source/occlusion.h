@@ -0,0 +1,52 @@
+/* date = October 19th 2026 10:12 am */
+
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+// NOTE(fz): Low resolution depth buffer rasterized on the CPU from a few occluder meshes, then used to reject
+// bounds before they reach the draw list. Depth is NDC z remapped to [0, 1], 1 being the far plane.
+// A pixel is covered when its centre is and keeps the furthest depth its nearest triangle reaches inside it,
+// every tile keeps the furthest of its pixels. A box is hidden when all the pixels it touches are nearer than it.
+// Nothing here touches GL, it runs headless.
+
+#define Occlusion_Width        320
+#define Occlusion_Height       192
+#define Occlusion_Tile_Size    8     // Pixels on a side, one f32x8 per tile row
+#define Occlusion_Near_W       1e-5f // Triangles with a vertex closer than this (or past the near plane) are dropped
+#define Max_Occluder_Triangles Kilobytes(64) // Triangles pushed past this are skipped
+
+typedef struct Occlusion_Triangle {
+  Raster_Triangle raster;
+  f32 z_dx; // Depth plane, already pushed to the far side of each pixel
+  f32 z_dy;
+  f32 z_c;
+  f32 z_max;
+} Occlusion_Triangle;
+
+typedef struct Occlusion_Buffer {
+  Arena* arena;
+  u32 width;   // Multiples of Occlusion_Tile_Size
+  u32 height;
+  u32 tiles_x;
+  u32 tiles_y;
+  f32* depth;    // width*height, rows bottom up
+  f32* tile_max; // tiles_x*tiles_y, furthest depth of each tile
+  
+  Matrix4 view_projection; // Of the frame being built, see occlusion_begin
+  
+  Occlusion_Triangle* triangles;
+  u32 triangles_count;
+  u32 triangles_capacity;
+} Occlusion_Buffer;
+
+internal Occlusion_Buffer occlusion_init(u32 width, u32 height); /* Rounded up to whole tiles */
+internal void occlusion_free(Occlusion_Buffer* buffer);
+internal void occlusion_begin(Occlusion_Buffer* buffer, Matrix4 view_projection); /* Drops the occluders of the last frame */
+internal void occlusion_push_triangles(Occlusion_Buffer* buffer, Vector3* vertices, u32 vertex_count, u32* indices, u32 triangle_count, Matrix4 transform);
+internal void occlusion_rasterize(Occlusion_Buffer* buffer); /* Clears the depth and draws everything pushed since occlusion_begin */
+
+/* False when the box is hidden behind the occluders or entirely off screen, model_view_projection takes box space to clip space.
+ * Read only, can be called from any thread once occlusion_rasterize returned. */
+internal b32 occlusion_test_aabb(Occlusion_Buffer* buffer, AABB box, Matrix4 model_view_projection);
+
+#endif // OCCLUSION_H
@@ -1,14 +1,14 @@
-internal void renderer_init(s32 window_width, s32 window_height) {
-  AssertNoReentry();
-  
-  MemoryZeroStruct(&GRenderer);
-  
+/* CPU side of the renderer, shared by both backends */
+internal void _renderer_init_data() {
   GRenderer.arena = arena_init();
   
   GRenderer.vertices_capacity = Kilobytes(64);
-  GRenderer.vertices_data  = ArenaPush(GRenderer.arena, Vertex, GRenderer.vertices_capacity);
+  GRenderer.vertices_data  = ArenaPush(GRenderer.arena, Vertex_Packed, GRenderer.vertices_capacity);
   GRenderer.vertices_count = 0;
   
+  GRenderer.vertices_hash_capacity = GRenderer.vertices_capacity*2;
+  GRenderer.vertices_hash_slots    = ArenaPush(GRenderer.arena, u32, GRenderer.vertices_hash_capacity);
+  
   GRenderer.triangles_indices_capacity = Kilobytes(16);
   GRenderer.triangles_indices_data  = (u32*)ArenaPush(GRenderer.arena, u32, GRenderer.triangles_indices_capacity);
   GRenderer.triangles_indices_count = 0;
@@ -17,9 +17,20 @@ internal void renderer_init(s32 window_width, s32 window_height) {
   GRenderer.lines_indices_data  = ArenaPush(GRenderer.arena, u32, GRenderer.lines_indices_capacity);
   GRenderer.lines_indices_count = 0;
   
-  GRenderer.textures_capacity = Initial_Textures;
-  GRenderer.textures_data  = ArenaPush(GRenderer.arena, u32, GRenderer.textures_capacity);
-  GRenderer.textures_count = 0;
+  GRenderer.meshes_indices_capacity = Kilobytes(256);
+  GRenderer.meshes_indices_data  = ArenaPush(GRenderer.arena, u32, GRenderer.meshes_indices_capacity);
+  GRenderer.meshes_indices_count = 0;
+  
+  GRenderer.instances_data = ArenaPush(GRenderer.arena, Renderer_Instance, Max_Instances_Per_Frame);
+  GRenderer.occlusion      = occlusion_init(Occlusion_Width, Occlusion_Height);
+}
+
+internal void renderer_init(s32 window_width, s32 window_height) {
+  AssertNoReentry();
+  
+  MemoryZeroStruct(&GRenderer);
+  GRenderer.backend = RendererBackend_OpenGL;
+  _renderer_init_data();
   
   Arena_Temp scratch = scratch_begin(0, 0);
   
@@ -68,6 +79,8 @@ internal void renderer_init(s32 window_width, s32 window_height) {
     }
   }
   
+  renderer_cache_uniforms(GRenderer.main_shader);
+  
   glDetachShader(GRenderer.main_shader, vertex_shader);
   glDetachShader(GRenderer.main_shader, fragment_shader);
   glDeleteShader(vertex_shader);
@@ -76,35 +89,68 @@ internal void renderer_init(s32 window_width, s32 window_height) {
   glCreateVertexArrays(1, &GRenderer.vertices_vao);
   {
     glEnableVertexArrayAttrib (GRenderer.vertices_vao, 0);
-    glVertexArrayAttribFormat (GRenderer.vertices_vao, 0, 3, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex, position));
+    glVertexArrayAttribFormat (GRenderer.vertices_vao, 0, 3, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex_Packed, position));
     glVertexArrayAttribBinding(GRenderer.vertices_vao, 0, 0);
     
     glEnableVertexArrayAttrib (GRenderer.vertices_vao, 1);
-    glVertexArrayAttribFormat (GRenderer.vertices_vao, 1, 4, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex, color));
+    glVertexArrayAttribFormat (GRenderer.vertices_vao, 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, OffsetOfMember(Vertex_Packed, color));
     glVertexArrayAttribBinding(GRenderer.vertices_vao, 1, 0);
     
     glEnableVertexArrayAttrib (GRenderer.vertices_vao, 2);
-    glVertexArrayAttribFormat (GRenderer.vertices_vao, 2, 2, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex, uv));
+    glVertexArrayAttribFormat (GRenderer.vertices_vao, 2, 2, GL_HALF_FLOAT, GL_FALSE, OffsetOfMember(Vertex_Packed, uv));
     glVertexArrayAttribBinding(GRenderer.vertices_vao, 2, 0);
     
-    glEnableVertexArrayAttrib (GRenderer.vertices_vao, 4);
-    glVertexArrayAttribFormat (GRenderer.vertices_vao, 4, 3, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex, normal));
-    glVertexArrayAttribBinding(GRenderer.vertices_vao, 4, 0);
+    // Octahedral, decoded in vs_main
+    glEnableVertexArrayAttrib (GRenderer.vertices_vao, 3);
+    glVertexArrayAttribFormat (GRenderer.vertices_vao, 3, 2, GL_BYTE, GL_TRUE, OffsetOfMember(Vertex_Packed, normal));
+    glVertexArrayAttribBinding(GRenderer.vertices_vao, 3, 0);
 
     glEnableVertexArrayAttrib (GRenderer.vertices_vao, 4);
-    glVertexArrayAttribFormat (GRenderer.vertices_vao, 4, 1, GL_FLOAT, GL_FALSE, OffsetOfMember(Vertex, texture));
+    glVertexArrayAttribFormat (GRenderer.vertices_vao, 4, 1, GL_UNSIGNED_SHORT, GL_FALSE, OffsetOfMember(Vertex_Packed, texture));
     glVertexArrayAttribBinding(GRenderer.vertices_vao, 4, 0);
     
     glCreateBuffers(1, &GRenderer.vertices_vbo);
-    glNamedBufferData(GRenderer.vertices_vbo, sizeof(Vertex) * Initial_Vertices, NULL, GL_STATIC_DRAW);
-    glVertexArrayVertexBuffer(GRenderer.vertices_vao, 0, GRenderer.vertices_vbo, 0, sizeof(Vertex));
+    glNamedBufferData(GRenderer.vertices_vbo, sizeof(Vertex_Packed) * Initial_Vertices, NULL, GL_STATIC_DRAW);
+    GRenderer.vertices_vbo_capacity = Initial_Vertices;
+    glVertexArrayVertexBuffer(GRenderer.vertices_vao, 0, GRenderer.vertices_vbo, 0, sizeof(Vertex_Packed));
+  }
+  
+  GRenderer.stream_lines = renderer_stream_buffer_init(Stream_Lines_Per_Frame * sizeof(Vertex_Packed));
+  
+  {
+    s32 alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    GRenderer.frame_uniforms_alignment = (u64)alignment;
+    u64 slot_size = ((sizeof(Renderer_Frame_Uniforms) + alignment - 1) / alignment) * alignment;
+    GRenderer.frame_uniforms = renderer_stream_buffer_init(slot_size);
+  }
+  
+  {
+    // NOTE(fz): Each frame's draw data starts at a region boundary, and slot 0 is pushed with the element alignment counted
+    // from the buffer start. The region size is a multiple of both, so every region start is a valid SSBO offset.
+    s32 alignment;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    GRenderer.draw_data_alignment = (u64)alignment;
+    u64 step = (u64)alignment;
+    while (step % sizeof(Renderer_Draw_Data) != 0) {
+      step += (u64)alignment;
+    }
+    u64 draw_data_size = ((Max_Draw_Data_Per_Frame * sizeof(Renderer_Draw_Data) + step - 1) / step) * step;
+    GRenderer.draw_commands = renderer_stream_buffer_init(Max_Draw_Commands_Per_Frame * sizeof(Renderer_Draw_Command));
+    GRenderer.draw_data     = renderer_stream_buffer_init(draw_data_size);
   }
   
   glCreateBuffers(1, &GRenderer.triangles_ebo);
   glNamedBufferData(GRenderer.triangles_ebo, sizeof(u32) * Initial_Indices, NULL, GL_STATIC_DRAW);
+  GRenderer.triangles_ebo_capacity = Initial_Indices;
   
   glCreateBuffers(1, &GRenderer.lines_ebo);
   glNamedBufferData(GRenderer.lines_ebo, sizeof(u32) * Initial_Indices, NULL, GL_STATIC_DRAW);
+  GRenderer.lines_ebo_capacity = Initial_Indices;
+  
+  glCreateBuffers(1, &GRenderer.meshes_ebo);
+  glNamedBufferData(GRenderer.meshes_ebo, sizeof(u32) * Initial_Indices, NULL, GL_STATIC_DRAW);
+  GRenderer.meshes_ebo_capacity = Initial_Indices;
   
   // MSAA
   {
@@ -203,6 +249,7 @@ internal void renderer_init(s32 window_width, s32 window_height) {
       }
     }
   }
+  renderer_cache_uniforms(GRenderer.screen_shader);
   
   f32 screen_vertices[] = {
     -1.0f,  1.0f,
@@ -223,12 +270,24 @@ internal void renderer_init(s32 window_width, s32 window_height) {
   glNamedBufferData(GRenderer.screen_vbo, sizeof(screen_vertices), &screen_vertices, GL_STATIC_DRAW);
   glVertexArrayVertexBuffer(GRenderer.screen_vao, 0, GRenderer.screen_vbo, 0, 2*sizeof(f32));
   
+  // Palette, entry 0 is white so untextured vertices sample 1.0
+  {
+    glCreateTextures(GL_TEXTURE_2D, 1, &GRenderer.palette_texture);
+    glTextureStorage2D(GRenderer.palette_texture, 1, GL_RGBA8, Palette_Size, 1);
+    glTextureParameteri(GRenderer.palette_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(GRenderer.palette_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTextureUnit(Palette_Texture_Unit, GRenderer.palette_texture);
+    renderer_load_color_texture(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+  
   glUseProgram(GRenderer.main_shader);
-  u32 texture_ids[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
-  renderer_set_array_s32(GRenderer.main_shader, "u_texture", 8, texture_ids);
+  s32 page_units[Max_Texture_Pages];
+  for (u32 i = 0; i < Max_Texture_Pages; i += 1) {
+    page_units[i] = Texture_Pages_Unit + i;
+  }
+  renderer_set_uniform_s32(GRenderer.main_shader, "u_palette", Palette_Texture_Unit);
+  renderer_set_array_s32(GRenderer.main_shader, "u_texture_pages", Max_Texture_Pages, page_units);
   glUseProgram(0);
-  
-  GRenderer.textures_count = 0;
 
   glCullFace(GL_FRONT);
   glFrontFace(GL_CCW);
@@ -236,41 +295,497 @@ internal void renderer_init(s32 window_width, s32 window_height) {
   scratch_end(&scratch);
 }
 
-internal void renderer_draw(Matrix4 view, Matrix4 projection, s32 window_width, s32 window_height) {
+internal void renderer_init_software(s32 width, s32 height) {
+  AssertNoReentry();
+  
+  MemoryZeroStruct(&GRenderer);
+  GRenderer.backend = RendererBackend_Software;
+  _renderer_init_data();
+  
+  // NOTE(fz): Stream buffers are plain memory here, see renderer_stream_buffer_init.
+  GRenderer.stream_lines  = renderer_stream_buffer_init(Stream_Lines_Per_Frame * sizeof(Vertex_Packed));
+  GRenderer.draw_commands = renderer_stream_buffer_init(Max_Draw_Commands_Per_Frame * sizeof(Renderer_Draw_Command));
+  GRenderer.draw_data     = renderer_stream_buffer_init(Max_Draw_Data_Per_Frame * sizeof(Renderer_Draw_Data));
+  
+  // Palette, entry 0 is white so untextured vertices sample 1.0
+  renderer_load_color_texture(1.0f, 1.0f, 1.0f, 1.0f);
+  
+  renderer_software_resize(width, height);
+}
+
+/* Stable merge sort of items by decreasing keys[item], temp needs count entries */
+internal void _renderer_sort_descending(u32* items, f32* keys, u32 count, u32* temp) {
+  for (u32 width = 1; width < count; width *= 2) {
+    for (u32 first = 0; first < count; first += 2*width) {
+      u32 middle = Min(first + width, count);
+      u32 last   = Min(first + 2*width, count);
+      u32 a = first, b = middle, o = first;
+      while (a < middle && b < last) {
+        temp[o++] = keys[items[b]] > keys[items[a]] ? items[b++] : items[a++];
+      }
+      while (a < middle) temp[o++] = items[a++];
+      while (b < last)   temp[o++] = items[b++];
+    }
+    MemoryCopy(items, temp, sizeof(u32)*count);
+  }
+}
+
+internal void _renderer_mark_dirty(Renderer_Dirty_Range* range, u32 first, u32 count) {
+  if (range->min >= range->max) {
+    range->min = first;
+    range->max = first + count;
+  } else {
+    range->min = Min(range->min, first);
+    range->max = Max(range->max, first + count);
+  }
+}
+
+/* Grows a GPU buffer geometrically to hold count elements, keeping its contents. Returns true when the buffer name changed */
+internal b32 _renderer_reserve_buffer(u32* buffer, u32* capacity, u32 count, u64 stride) {
+  if (count <= *capacity) {
+    return false;
+  }
+  
+  u32 new_capacity = Max(*capacity, 1);
+  while (new_capacity < count) {
+    new_capacity *= 2;
+  }
+  
+  u32 new_buffer;
+  glCreateBuffers(1, &new_buffer);
+  glNamedBufferData(new_buffer, new_capacity * stride, NULL, GL_STATIC_DRAW);
+  glCopyNamedBufferSubData(*buffer, new_buffer, 0, 0, *capacity * stride);
+  glDeleteBuffers(1, buffer);
+  
+  *buffer   = new_buffer;
+  *capacity = new_capacity;
+  return true;
+}
+
+internal void _renderer_upload_dirty(u32 buffer, Renderer_Dirty_Range* range, u64 stride, void* data) {
+  if (range->min >= range->max) {
+    return;
+  }
+  glNamedBufferSubData(buffer, range->min * stride, (range->max - range->min) * stride, (u8*)data + range->min * stride);
+  range->min = 0;
+  range->max = 0;
+}
+
+/* Writes draw data 0 the first time the draw list is touched in a frame */
+internal void _renderer_begin_draw_list() {
+  if (GRenderer.draw_data_count > 0) {
+    return;
+  }
+  Renderer_Draw_Data* data = (Renderer_Draw_Data*)renderer_stream_buffer_push(&GRenderer.draw_data, sizeof(Renderer_Draw_Data), sizeof(Renderer_Draw_Data), &GRenderer.draw_data_offset);
+  data->transform = matrix4(1.0f);
+  data->color     = vector4(1.0f, 1.0f, 1.0f, 1.0f);
+  GRenderer.draw_data_count = 1;
+}
+
+internal void _renderer_push_draw_command(u32 first_index, u32 count, u32 instance_count, u32 base_instance) {
+  u64 offset;
+  Renderer_Draw_Command* command = (Renderer_Draw_Command*)renderer_stream_buffer_push(&GRenderer.draw_commands, sizeof(Renderer_Draw_Command), sizeof(Renderer_Draw_Command), &offset);
+  if (GRenderer.draw_commands_count == 0) {
+    GRenderer.draw_commands_offset = offset;
+  }
+  command->count          = count;
+  command->instance_count = instance_count;
+  command->first_index    = first_index;
+  command->base_vertex    = 0;
+  command->base_instance  = base_instance;
+  GRenderer.draw_commands_count += 1;
+}
+
+/* Coarsest level whose error stays under Lod_Pixel_Error, 0 being the full mesh */
+internal u32 _renderer_select_lod(Mesh* mesh, f32 pixels_per_unit) {
+  u32 result = 0;
+  while (result < mesh->lod_count && mesh->lods[result].error*pixels_per_unit <= Lod_Pixel_Error) {
+    result += 1;
+  }
+  return result;
+}
+
+/* How many pixels one model space unit covers at the instance's nearest point, from the model bounding sphere */
+internal f32 _renderer_instance_pixels_per_unit(Model* model, Matrix4 transform, Matrix4 view, Matrix4 projection, s32 window_height) {
+  if (aabb_is_empty(model->bounds)) {
+    return F32_MAX;
+  }
+  f32 scale = 0.0f;
+  for (u32 i = 0; i < 3; i += 1) {
+    Vector4 axis = { 0 };
+    axis.data[i] = 1.0f;
+    scale = Max(scale, vector3_length(vector3_from_vector4(mul_vector4_matrix4(axis, transform))));
+  }
+  
+  f32 result = projection.m5 * 0.5f * (f32)window_height * scale;
+  if (projection.m11 != 0.0f) {
+    Vector3 center = vector3_scale(vector3_add(model->bounds.min, model->bounds.max), 0.5f);
+    f32     radius = 0.5f * vector3_length(sub(model->bounds.max, model->bounds.min)) * scale;
+    Vector3 eye    = mul_vector3_matrix4(mul_vector3_matrix4(center, transform), view);
+    result /= Max(vector3_length(eye) - radius, Lod_Min_Distance);
+  }
+  return result;
+}
+
+// Meshlets of one instance's full mesh, tested in its model space
+typedef struct Renderer_Meshlet_Cull_Job {
+  Mesh*   mesh;
+  Frustum frustum;
+  Matrix4 model_view_projection;
+  Vector3 camera;
+  b32     cone; // Normal cones only hold under perspective and uniform scale
+  u32     first; // Into visible, prefix sum of the meshlet counts
+  u32     base_instance;
+} Renderer_Meshlet_Cull_Job;
+
+typedef struct Renderer_Meshlet_Cull_Context {
+  Renderer_Meshlet_Cull_Job* jobs;
+  u32 job_count;
+  b32 occlusion; // Test the survivors against GRenderer.occlusion too
+  u8* visible;
+} Renderer_Meshlet_Cull_Context;
+
+internal void _renderer_cull_meshlets(void* context, u64 first, u64 one_past_last) {
+  Renderer_Meshlet_Cull_Context* ctx = (Renderer_Meshlet_Cull_Context*)context;
+  
+  u32 low = 0, high = ctx->job_count - 1;
+  while (low < high) {
+    u32 middle = (low + high + 1) / 2;
+    if (ctx->jobs[middle].first <= first) low = middle;
+    else                                  high = middle - 1;
+  }
+  
+  u32 job_index = low;
+  for (u64 i = first; i < one_past_last; i += 1) {
+    while (job_index + 1 < ctx->job_count && ctx->jobs[job_index + 1].first <= i) {
+      job_index += 1;
+    }
+    Renderer_Meshlet_Cull_Job* job = &ctx->jobs[job_index];
+    Meshlet* meshlet = &job->mesh->meshlets[i - job->first];
+    
+    b32 visible = frustum_intersects_sphere(&job->frustum, meshlet->center, meshlet->radius);
+    if (visible && job->cone) {
+      // NOTE(fz): GL_FRONT is the culled face, so a cluster is hidden when every triangle's normal points at the camera.
+      Vector3 to_camera = sub(job->camera, meshlet->center);
+      visible = vector3_dot(to_camera, meshlet->cone_axis) < meshlet->cone_cutoff*vector3_length(to_camera) + meshlet->radius;
+    }
+    if (visible && ctx->occlusion) {
+      AABB box = { sub(meshlet->center, vector3(meshlet->radius, meshlet->radius, meshlet->radius)), vector3_add(meshlet->center, vector3(meshlet->radius, meshlet->radius, meshlet->radius)) };
+      visible = occlusion_test_aabb(&GRenderer.occlusion, box, job->model_view_projection);
+    }
+    ctx->visible[i] = (u8)visible;
+  }
+}
+
+typedef struct Renderer_Instance_Test_Context {
+  Matrix4 view_projection;
+  f32*    pixels_per_unit; // Set to -1 for the hidden instances
+} Renderer_Instance_Test_Context;
+
+internal void _renderer_test_instances(void* context, u64 first, u64 one_past_last) {
+  Renderer_Instance_Test_Context* ctx = (Renderer_Instance_Test_Context*)context;
+  for (u64 i = first; i < one_past_last; i += 1) {
+    Renderer_Instance* instance = &GRenderer.instances_data[i];
+    Model* model = GRenderer.instance_batches[instance->batch].model;
+    if (!occlusion_test_aabb(&GRenderer.occlusion, model->bounds, matrix4_mul(instance->transform, ctx->view_projection))) {
+      ctx->pixels_per_unit[i] = -1.0f;
+    }
+  }
+}
+
+/* Whether an instance draws its full mesh big enough on screen for culling its meshlets to beat one instanced draw */
+internal b32 _renderer_culls_meshlets(Model* model, Mesh* mesh, f32 pixels_per_unit) {
+  if (mesh->meshlet_count <= 1 || _renderer_select_lod(mesh, pixels_per_unit) != 0) {
+    return 0;
+  }
+  f32 radius = 0.5f * vector3_length(sub(model->bounds.max, model->bounds.min));
+  return pixels_per_unit*radius >= Meshlet_Cull_Min_Pixels;
+}
+
+/* One command per run of consecutive visible meshlets, nothing pushed when they don't fit the frame's meshlet budget */
+internal b32 _renderer_push_meshlet_draws(Renderer_Meshlet_Cull_Job* job, u8* visible, Renderer_Mesh gpu) {
+  Mesh* mesh = job->mesh;
+  u8*   mesh_visible = visible + job->first;
+  
+  u32 run_count = 0;
+  for (u32 i = 0; i < mesh->meshlet_count; i += 1) {
+    run_count += mesh_visible[i] && (i == 0 || !mesh_visible[i - 1]);
+  }
+  if (GRenderer.meshlet_draws_count + run_count > Max_Meshlet_Draws_Per_Frame) {
+    return 0;
+  }
+  GRenderer.meshlet_draws_count += run_count;
+  
+  for (u32 i = 0; i < mesh->meshlet_count;) {
+    if (!mesh_visible[i]) {
+      i += 1;
+      continue;
+    }
+    u32 first_triangle = mesh->meshlets[i].first_triangle;
+    u32 triangle_count = 0;
+    for (; i < mesh->meshlet_count && mesh_visible[i]; i += 1) {
+      triangle_count += mesh->meshlets[i].triangle_count;
+    }
+    _renderer_push_draw_command(gpu.first_index + first_triangle*3, triangle_count*3, 1, job->base_instance);
+  }
+  return 1;
+}
+
+/* Counting sort of the frame's instances by model, then by decreasing projected size inside each model so every
+ * mesh LOD covers a contiguous run of instances. Written straight into the mapped draw data, one command per run. */
+internal void _renderer_pack_instances(Matrix4 view, Matrix4 projection, s32 window_height) {
+  if (GRenderer.instances_count == 0) {
+    return;
+  }
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  u64 offset;
+  u32 first = GRenderer.draw_data_count;
+  Renderer_Draw_Data* data = (Renderer_Draw_Data*)renderer_stream_buffer_push(&GRenderer.draw_data, GRenderer.instances_count * sizeof(Renderer_Draw_Data), sizeof(Renderer_Draw_Data), &offset);
+  GRenderer.draw_data_count += GRenderer.instances_count;
+  
+  u32 batch_first = 0;
+  for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+    Renderer_Instance_Batch* batch = &GRenderer.instance_batches[i];
+    batch->next  = batch_first;
+    batch_first += batch->count;
+  }
+  u32* sorted          = ArenaPushNoZero(scratch.arena, u32, GRenderer.instances_count);
+  f32* pixels_per_unit = ArenaPushNoZero(scratch.arena, f32, GRenderer.instances_count);
+  for (u32 i = 0; i < GRenderer.instances_count; i += 1) {
+    Renderer_Instance* instance = &GRenderer.instances_data[i];
+    Renderer_Instance_Batch* batch = &GRenderer.instance_batches[instance->batch];
+    sorted[batch->next++] = i;
+    pixels_per_unit[i] = _renderer_instance_pixels_per_unit(batch->model, instance->transform, view, projection, window_height);
+  }
+  
+  // NOTE(fz): Hidden instances get a negative size, so the sort below moves them past the visible ones of their batch
+  // and only the first batch->visible are drawn.
+  Matrix4 view_projection = matrix4_mul(view, projection);
+  for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+    GRenderer.instance_batches[i].visible = GRenderer.instance_batches[i].count;
+  }
+  if (GRenderer.occluders_count > 0) {
+    occlusion_begin(&GRenderer.occlusion, view_projection);
+    for (u32 i = 0; i < GRenderer.occluders_count; i += 1) {
+      Model* model = GRenderer.occluders[i].model;
+      for (u32 j = 0; j < model->mesh_count; j += 1) {
+        Mesh* mesh = &model->meshes_data[j];
+        occlusion_push_triangles(&GRenderer.occlusion, mesh->vertices, mesh->vertex_count, mesh->indices, mesh->triangle_count, GRenderer.occluders[i].transform);
+      }
+    }
+    occlusion_rasterize(&GRenderer.occlusion);
+    
+    Renderer_Instance_Test_Context test = { view_projection, pixels_per_unit };
+    parallel_for(GRenderer.instances_count, Instance_Test_Batch, _renderer_test_instances, &test);
+    for (u32 i = 0; i < GRenderer.instances_count; i += 1) {
+      GRenderer.instance_batches[GRenderer.instances_data[i].batch].visible -= pixels_per_unit[i] < 0.0f;
+    }
+  }
+  
+  u32* temp = ArenaPushNoZero(scratch.arena, u32, GRenderer.instances_count);
+  batch_first = 0;
+  for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+    Renderer_Instance_Batch* batch = &GRenderer.instance_batches[i];
+    _renderer_sort_descending(sorted + batch_first, pixels_per_unit, batch->count, temp);
+    batch_first += batch->count;
+  }
+  for (u32 i = 0; i < GRenderer.instances_count; i += 1) {
+    data[i].transform = GRenderer.instances_data[sorted[i]].transform;
+    data[i].color     = vector4(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+  
+  // NOTE(fz): Instances close enough to draw a full mesh get its meshlets culled one by one, on every thread.
+  // The sort puts them at the front of their batch, and at most one job is made per meshlet command the frame allows.
+  // The jobs are gathered in the order the commands are emitted below, so that loop walks them with a cursor.
+  Renderer_Meshlet_Cull_Context cull = { 0 };
+  cull.occlusion = GRenderer.occluders_count > 0;
+  {
+    u32 meshlet_count = 0;
+    batch_first = 0;
+    for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+      Renderer_Instance_Batch* batch = &GRenderer.instance_batches[i];
+      for (u32 j = 0; j < batch->model->mesh_count; j += 1) {
+        Mesh* mesh = &batch->model->meshes_data[j];
+        for (u32 k = 0; k < batch->visible && cull.job_count < Max_Meshlet_Draws_Per_Frame; k += 1) {
+          if (!_renderer_culls_meshlets(batch->model, mesh, pixels_per_unit[sorted[batch_first + k]])) {
+            break;
+          }
+          cull.job_count += 1;
+          meshlet_count  += mesh->meshlet_count;
+        }
+      }
+      batch_first += batch->count;
+    }
+    
+    cull.jobs    = ArenaPushNoZero(scratch.arena, Renderer_Meshlet_Cull_Job, cull.job_count);
+    cull.visible = ArenaPushNoZero(scratch.arena, u8, meshlet_count);
+    Vector3 camera = mul_vector3_matrix4(vector3(0.0f, 0.0f, 0.0f), matrix4_inverse_affine(view));
+    u32 job_index = 0;
+    meshlet_count = 0;
+    batch_first   = 0;
+    for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+      Renderer_Instance_Batch* batch = &GRenderer.instance_batches[i];
+      for (u32 j = 0; j < batch->model->mesh_count; j += 1) {
+        Mesh* mesh = &batch->model->meshes_data[j];
+        for (u32 k = 0; k < batch->visible && job_index < cull.job_count; k += 1) {
+          if (!_renderer_culls_meshlets(batch->model, mesh, pixels_per_unit[sorted[batch_first + k]])) {
+            break;
+          }
+          Matrix4 transform = GRenderer.instances_data[sorted[batch_first + k]].transform;
+          f32 min_scale = F32_MAX, max_scale = 0.0f;
+          for (u32 axis = 0; axis < 3; axis += 1) {
+            Vector4 v = { 0 };
+            v.data[axis] = 1.0f;
+            f32 scale = vector3_length(vector3_from_vector4(mul_vector4_matrix4(v, transform)));
+            min_scale = Min(min_scale, scale);
+            max_scale = Max(max_scale, scale);
+          }
+          
+          Renderer_Meshlet_Cull_Job* job = &cull.jobs[job_index++];
+          job->mesh                  = mesh;
+          job->model_view_projection = matrix4_mul(transform, view_projection);
+          job->frustum               = frustum_from_matrix4(job->model_view_projection);
+          job->camera                = mul_vector3_matrix4(camera, matrix4_inverse_affine(transform));
+          job->cone                  = projection.m11 != 0.0f && max_scale - min_scale <= 0.001f*max_scale;
+          job->first                 = meshlet_count;
+          job->base_instance         = first + batch_first + k;
+          meshlet_count += mesh->meshlet_count;
+        }
+      }
+      batch_first += batch->count;
+    }
+    if (meshlet_count > 0) {
+      parallel_for(meshlet_count, Meshlet_Cull_Batch, _renderer_cull_meshlets, &cull);
+    }
+  }
+  
+  u32 job_index = 0;
+  batch_first = 0;
+  for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+    Renderer_Instance_Batch* batch = &GRenderer.instance_batches[i];
+    for (u32 j = 0; j < batch->model->mesh_count; j += 1) {
+      Mesh* mesh = &batch->model->meshes_data[j];
+      for (u32 run = 0; run < batch->visible;) {
+        u32 lod = _renderer_select_lod(mesh, pixels_per_unit[sorted[batch_first + run]]);
+        u32 run_count = 1;
+        while (run + run_count < batch->visible && _renderer_select_lod(mesh, pixels_per_unit[sorted[batch_first + run + run_count]]) == lod) {
+          run_count += 1;
+        }
+        
+        // NOTE(fz): Jobs cover a prefix of the LOD 0 run. Past the ones that fit the meshlet budget the rest of the run
+        // is one instanced command, so the command count never depends on the instance count.
+        Renderer_Mesh gpu = lod == 0 ? mesh->gpu : mesh->lods[lod - 1].gpu;
+        u32 culled = 0;
+        while (job_index < cull.job_count && cull.jobs[job_index].mesh == mesh && cull.jobs[job_index].base_instance == first + batch_first + run + culled) {
+          if (culled == run_count || !_renderer_push_meshlet_draws(&cull.jobs[job_index], cull.visible, gpu)) {
+            break;
+          }
+          job_index += 1;
+          culled    += 1;
+        }
+        while (job_index < cull.job_count && cull.jobs[job_index].mesh == mesh && cull.jobs[job_index].base_instance < first + batch_first + run + run_count) {
+          job_index += 1;
+        }
+        if (culled < run_count && gpu.index_count > 0) {
+          _renderer_push_draw_command(gpu.first_index, gpu.index_count, run_count - culled, first + batch_first + run + culled);
+        }
+        run += run_count;
+      }
+    }
+    batch_first += batch->count;
+  }
+  scratch_end(&scratch);
+}
+
+/* Hands the frame's stream buffer regions back and empties the per frame lists */
+internal void _renderer_end_frame() {
+  renderer_stream_buffer_next_frame(&GRenderer.stream_lines);
+  renderer_stream_buffer_next_frame(&GRenderer.frame_uniforms);
+  renderer_stream_buffer_next_frame(&GRenderer.draw_commands);
+  renderer_stream_buffer_next_frame(&GRenderer.draw_data);
+  GRenderer.draw_commands_count    = 0;
+  GRenderer.draw_data_count        = 0;
+  GRenderer.meshlet_draws_count    = 0;
+  GRenderer.instance_draws_reserved = 0;
+  GRenderer.occluders_count        = 0;
+  GRenderer.instances_count        = 0;
+  GRenderer.instance_batches_count = 0;
+  GRenderer.stream_lines_count = 0;
+}
+
+internal void renderer_draw(Matrix4 view, Matrix4 projection, s32 window_width, s32 window_height, f32 time) {
+  if (GRenderer.backend == RendererBackend_Software) {
+    renderer_software_draw(view, projection, window_height);
+    _renderer_end_frame();
+    return;
+  }
+  
+  // NOTE(fz): Everything shared by the frame's programs goes in one write to the mapped ring, no per uniform calls.
+  {
+    u64 offset;
+    Renderer_Frame_Uniforms* frame = (Renderer_Frame_Uniforms*)renderer_stream_buffer_push(&GRenderer.frame_uniforms, sizeof(Renderer_Frame_Uniforms), GRenderer.frame_uniforms_alignment, &offset);
+    frame->view            = view;
+    frame->projection      = projection;
+    frame->view_projection = matrix4_mul(view, projection);
+    frame->viewport        = vector4(0.0f, 0.0f, (f32)window_width, (f32)window_height);
+    frame->time            = time;
+    glBindBufferRange(GL_UNIFORM_BUFFER, Frame_Uniforms_Binding, GRenderer.frame_uniforms.buffer, offset, sizeof(Renderer_Frame_Uniforms));
+  }
+  
   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GRenderer.msaa_fbo);
   glClearColor(0.0, 0.0, 0.0, 1.0);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   glEnable(GL_DEPTH_TEST);
   
+  // NOTE(fz): Palette and texture pages stay bound to their units from creation, nothing to bind per frame.
   glUseProgram(GRenderer.main_shader);
-  renderer_set_uniform_mat4fv(GRenderer.main_shader, "u_model",      matrix4(1.0f));
-  renderer_set_uniform_mat4fv(GRenderer.main_shader, "u_view",       view);
-  renderer_set_uniform_mat4fv(GRenderer.main_shader, "u_projection", projection);
-  
-  for (u32 i = 0; i < GRenderer.textures_count; i += 1) {
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, GRenderer.textures_data[i]);
-  }
   
   // Draw to msaa_fbo
   {
     glBindVertexArray(GRenderer.vertices_vao);
     glEnable(GL_CULL_FACE);
 
-    // TODO(fz): We don't need to do NamedBufferSubData all the time, since we don't clear the buffers every frame.
+    // NOTE(fz): The buffers persist across frames, only what was pushed since the last frame goes over the bus.
+    if (_renderer_reserve_buffer(&GRenderer.vertices_vbo, &GRenderer.vertices_vbo_capacity, GRenderer.vertices_count, sizeof(Vertex_Packed))) {
+      glVertexArrayVertexBuffer(GRenderer.vertices_vao, 0, GRenderer.vertices_vbo, 0, sizeof(Vertex_Packed));
+    }
+    _renderer_reserve_buffer(&GRenderer.triangles_ebo, &GRenderer.triangles_ebo_capacity, GRenderer.triangles_indices_count, sizeof(u32));
+    _renderer_reserve_buffer(&GRenderer.lines_ebo,     &GRenderer.lines_ebo_capacity,     GRenderer.lines_indices_count,     sizeof(u32));
+    _renderer_reserve_buffer(&GRenderer.meshes_ebo,    &GRenderer.meshes_ebo_capacity,    GRenderer.meshes_indices_count,    sizeof(u32));
+    _renderer_upload_dirty(GRenderer.vertices_vbo,  &GRenderer.vertices_dirty,          sizeof(Vertex_Packed), GRenderer.vertices_data);
+    _renderer_upload_dirty(GRenderer.triangles_ebo, &GRenderer.triangles_indices_dirty, sizeof(u32),    GRenderer.triangles_indices_data);
+    _renderer_upload_dirty(GRenderer.lines_ebo,     &GRenderer.lines_indices_dirty,     sizeof(u32),    GRenderer.lines_indices_data);
+    _renderer_upload_dirty(GRenderer.meshes_ebo,    &GRenderer.meshes_indices_dirty,    sizeof(u32),    GRenderer.meshes_indices_data);
+    
+    _renderer_begin_draw_list();
+    _renderer_pack_instances(view, projection, window_height);
+    Assert(GRenderer.draw_data_offset % GRenderer.draw_data_alignment == 0);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, Draw_Data_Binding, GRenderer.draw_data.buffer, GRenderer.draw_data_offset, GRenderer.draw_data_count * sizeof(Renderer_Draw_Data));
 
     // Triangles
     glVertexArrayElementBuffer(GRenderer.vertices_vao, GRenderer.triangles_ebo);
-    glNamedBufferSubData(GRenderer.vertices_vbo, 0, GRenderer.vertices_count * sizeof(Vertex), GRenderer.vertices_data);
-    glNamedBufferSubData(GRenderer.triangles_ebo, 0, GRenderer.triangles_indices_count * sizeof(u32), GRenderer.triangles_indices_data);
     glDrawElements(GL_TRIANGLES, GRenderer.triangles_indices_count, GL_UNSIGNED_INT, NULL);
+    
+    // Draw list
+    if (GRenderer.draw_commands_count > 0) {
+      glVertexArrayElementBuffer(GRenderer.vertices_vao, GRenderer.meshes_ebo);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, GRenderer.draw_commands.buffer);
+      glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)GRenderer.draw_commands_offset, GRenderer.draw_commands_count, 0);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
 
     // Lines
     glVertexArrayElementBuffer(GRenderer.vertices_vao, GRenderer.lines_ebo);
-    glNamedBufferSubData(GRenderer.vertices_vbo, 0, GRenderer.vertices_count * sizeof(Vertex), GRenderer.vertices_data);
-    glNamedBufferSubData(GRenderer.lines_ebo, 0, GRenderer.lines_indices_count * sizeof(u32), GRenderer.lines_indices_data);
     glDrawElements(GL_LINES, GRenderer.lines_indices_count, GL_UNSIGNED_INT, NULL);
 
+    // Streamed lines, read straight from the mapped region written this frame
+    if (GRenderer.stream_lines_count > 0) {
+      glVertexArrayVertexBuffer(GRenderer.vertices_vao, 0, GRenderer.stream_lines.buffer, 0, sizeof(Vertex_Packed));
+      glDrawArrays(GL_LINES, GRenderer.stream_lines_first, GRenderer.stream_lines_count);
+      glVertexArrayVertexBuffer(GRenderer.vertices_vao, 0, GRenderer.vertices_vbo, 0, sizeof(Vertex_Packed));
+    }
+
     glDisable(GL_CULL_FACE);
     glBindVertexArray(0);
   }
@@ -290,17 +805,21 @@ internal void renderer_draw(Matrix4 view, Matrix4 projection, s32 window_width,
   glBindVertexArray(GRenderer.screen_vao);
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, GRenderer.screen_texture);
-  
-  renderer_set_uniform_s32(GRenderer.screen_shader, "u_window_width", window_width);
-  renderer_set_uniform_s32(GRenderer.screen_shader, "u_window_height", window_height);
   glDrawArrays(GL_TRIANGLES, 0, 6);
   
   glUseProgram(0);
   glBindVertexArray(0);
   glBindTexture(GL_TEXTURE_2D, 0);
+  
+  _renderer_end_frame();
 }
 
 internal void renderer_on_resize(s32 window_width, s32 window_height) {
+  if (GRenderer.backend == RendererBackend_Software) {
+    renderer_software_resize(window_width, window_height);
+    return;
+  }
+  
   // Delete and recreate MSAA framebuffer
   glBindFramebuffer(GL_FRAMEBUFFER, GRenderer.msaa_fbo);
   glDeleteTextures(1, &GRenderer.msaa_texture_color_buffer_multisampled);
@@ -354,175 +873,2245 @@ internal void renderer_on_resize(s32 window_width, s32 window_height) {
 }
 
 internal f32 renderer_load_color_texture(f32 r, f32 g, f32 b, f32 a) {
-  u8 texture_data[4] = {
+  u8 texel[4] = {
     (u8)(255.0*r),
     (u8)(255.0*g),
     (u8)(255.0*b),
     (u8)(255.0*a)
   };
+  u32 color;
+  MemoryCopy(&color, texel, sizeof(color));
+  
+  for (u32 i = 0; i < GRenderer.palette_count; i += 1) {
+    if (GRenderer.palette_data[i] == color) {
+      return (f32)i;
+    }
+  }
   
-  u32 texture_id;
-  glGenTextures(1, &texture_id);
-  glBindTexture(GL_TEXTURE_2D, texture_id);
+  if (GRenderer.palette_count >= Palette_Size) {
+    printf("Palette is full");
+    Assert(0);
+    return 0.0f;
+  }
+  u32 index = GRenderer.palette_count;
+  GRenderer.palette_data[index] = color;
+  GRenderer.palette_count += 1;
+  if (GRenderer.backend == RendererBackend_OpenGL) {
+    glTextureSubImage2D(GRenderer.palette_texture, 0, index, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+  }
   
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture_data);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return (f32)index;
+}
+
+internal f32 renderer_load_texture(u8* rgba, s32 width, s32 height) {
+  Renderer_Texture_Page* page = NULL;
+  u32 page_index = 0;
+  for (u32 i = 0; i < GRenderer.texture_pages_count; i += 1) {
+    Renderer_Texture_Page* it = &GRenderer.texture_pages[i];
+    if (it->width == width && it->height == height && it->layers_count < Texture_Page_Layers) {
+      page       = it;
+      page_index = i;
+      break;
+    }
+  }
   
-  glBindTexture(GL_TEXTURE_2D, 0);
+  if (page == NULL) {
+    if (GRenderer.texture_pages_count >= Max_Texture_Pages) {
+      printf("Too many texture pages, no room for a %dx%d texture", width, height);
+      Assert(0);
+      return 0.0f;
+    }
+    page_index = GRenderer.texture_pages_count;
+    page       = &GRenderer.texture_pages[page_index];
+    GRenderer.texture_pages_count += 1;
+    
+    s32 mipmaps = 1;
+    while ((Max(width, height) >> mipmaps) > 0) {
+      mipmaps += 1;
+    }
+    
+    MemoryZeroStruct(page);
+    page->width  = width;
+    page->height = height;
+    if (GRenderer.backend == RendererBackend_OpenGL) {
+      glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &page->id);
+      glTextureStorage3D(page->id, mipmaps, GL_RGBA8, width, height, Texture_Page_Layers);
+      glTextureParameteri(page->id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+      glTextureParameteri(page->id, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTextureParameteri(page->id, GL_TEXTURE_WRAP_S, GL_REPEAT);
+      glTextureParameteri(page->id, GL_TEXTURE_WRAP_T, GL_REPEAT);
+      glBindTextureUnit(Texture_Pages_Unit + page_index, page->id);
+    }
+  }
   
-  u32 texture_index = GRenderer.textures_count;
-  GRenderer.textures_data[texture_index] = texture_id;
-  GRenderer.textures_count += 1;
+  u32 layer = page->layers_count;
+  page->layers_count += 1;
+  if (GRenderer.backend == RendererBackend_OpenGL) {
+    glTextureSubImage3D(page->id, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glGenerateTextureMipmap(page->id);
+  } else {
+    // NOTE(fz): The software backend samples the top level only, the texels live with the rest of the renderer data.
+    page->texels[layer] = ArenaPushNoZero(GRenderer.arena, u32, width*height);
+    MemoryCopy(page->texels[layer], rgba, sizeof(u32)*width*height);
+  }
   
-  return (f32)texture_index;
+  return (f32)(Palette_Size + page_index*Texture_Page_Layers + layer);
 }
 
-internal Model renderer_load_obj(String path) {
-  Model result = { 0 };
-
-  tinyobj_attrib_t attrib = { 0 };
+internal u64 _renderer_hash_cell(s64 x, s64 y, s64 z) {
+  u64 result = (u64)x*0x9e3779b97f4a7c15ull ^ (u64)y*0xc2b2ae3d27d4eb4full ^ (u64)z*0x165667b19e3779f9ull;
+  result ^= result >> 33;
+  result *= 0xff51afd7ed558ccdull;
+  result ^= result >> 33;
+  return result;
+}
 
-  u32 mesh_count          = 0;
-  tinyobj_shape_t *meshes = NULL;
-  u32 material_count           = 0;
-  tinyobj_material_t *materials = NULL;
+/* remap[i] is the first position within epsilon of position i, in a grid of epsilon sized cells */
+internal void _obj_weld_positions(f32* positions, u32 count, f32 epsilon, u32* remap) {
+  typedef struct Weld_Slot {
+    s64 x, y, z;
+    u32 index; // Position index + 1, 0 is empty
+  } Weld_Slot;
   
   Arena_Temp scratch = scratch_begin(0, 0);
-  OS_File file = os_file_load_entire_file(scratch.arena, path);
-  if (file.size == 0) {
-    printf("Error loading file %s.", path.str);
-    Assert(0);
-  }
-
-  s32 tinyobj_result = tinyobj_parse_obj(&attrib, &meshes, &mesh_count, &materials, &material_count, file.data, file.size, TINYOBJ_FLAG_TRIANGULATE);
-  if (tinyobj_result != TINYOBJ_SUCCESS) {
-    printf("Error on tinyobj_parse_obj.");
-    Assert(0);
+  u32 capacity = 1;
+  while (capacity < count*2) {
+    capacity *= 2;
   }
-
-  result.mesh_count     = mesh_count;
-  result.material_count = material_count;
-  if (result.material_count == 0) {
-      printf("No materials provided, setting one default material for all meshes.\n");
-      result.material_count = 1;
+  u32 mask = capacity - 1;
+  Weld_Slot* slots = ArenaPush(scratch.arena, Weld_Slot, capacity);
+  
+  f32 inverse_cell = 1.0f / epsilon;
+  f32 epsilon_squared = epsilon*epsilon;
+  for (u32 i = 0; i < count; i += 1) {
+    f32* p = positions + i*3;
+    s64 cx = (s64)floorf(p[0] * inverse_cell);
+    s64 cy = (s64)floorf(p[1] * inverse_cell);
+    s64 cz = (s64)floorf(p[2] * inverse_cell);
+    
+    // NOTE(fz): A match can only sit in the same cell or one of the 26 around it.
+    u32 match = U32_MAX;
+    for (s64 dz = -1; dz <= 1 && match == U32_MAX; dz += 1)
+    for (s64 dy = -1; dy <= 1 && match == U32_MAX; dy += 1)
+    for (s64 dx = -1; dx <= 1 && match == U32_MAX; dx += 1) {
+      s64 x = cx + dx, y = cy + dy, z = cz + dz;
+      u32 slot = (u32)_renderer_hash_cell(x, y, z) & mask;
+      for (; slots[slot].index != 0; slot = (slot + 1) & mask) {
+        Weld_Slot* it = &slots[slot];
+        if (it->x != x || it->y != y || it->z != z) {
+          continue;
+        }
+        f32* q = positions + (it->index - 1)*3;
+        f32 ex = p[0] - q[0], ey = p[1] - q[1], ez = p[2] - q[2];
+        if (ex*ex + ey*ey + ez*ez <= epsilon_squared) {
+          match = it->index - 1;
+          break;
+        }
+      }
+    }
+    
+    if (match != U32_MAX) {
+      remap[i] = match;
+    } else {
+      remap[i] = i;
+      u32 slot = (u32)_renderer_hash_cell(cx, cy, cz) & mask;
+      while (slots[slot].index != 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot].x     = cx;
+      slots[slot].y     = cy;
+      slots[slot].z     = cz;
+      slots[slot].index = i + 1;
+    }
   }
-
-  result.arena  = arena_init();
-
   scratch_end(&scratch);
-  return result;
 }
 
-internal void renderer_push_triangle(Vertex a, Vertex b, Vertex c) {
-  if (GRenderer.triangles_indices_count + 3 > GRenderer.triangles_indices_capacity) {
-    printf("Too many triangles indices");
-    Assert(0);
+/* Splits off the next line, without its line ending */
+internal String _obj_next_line(u8** at, u8* end) {
+  u8* first = *at;
+  u8* last  = first;
+  while (last < end && *last != '\n') {
+    last += 1;
   }
-  if (GRenderer.vertices_count + 3 > GRenderer.vertices_capacity) {
-    printf("Too many vertices");
-    Assert(0);
+  *at = last < end ? last + 1 : end;
+  if (last > first && last[-1] == '\r') {
+    last -= 1;
   }
+  return string_range(first, last);
+}
 
-  // TODO(fz): Should try making this a hashtable lookup
+/* Splits off the next run of non blank characters, empty at the end of the line */
+internal String _obj_next_token(String* line) {
+  u8* at  = line->str;
+  u8* end = line->str + line->size;
+  while (at < end && (*at == ' ' || *at == '\t')) {
+    at += 1;
+  }
+  u8* first = at;
+  while (at < end && *at != ' ' && *at != '\t') {
+    at += 1;
+  }
+  *line = string_range(at, end);
+  return string_range(first, at);
+}
 
-  b32 a_exists = false;
-  b32 b_exists = false;
-  b32 c_exists = false;
-  for (u32 i = 0; i < GRenderer.vertices_count; i += 1) {
-    Vertex it = GRenderer.vertices_data[i];
+internal String _obj_trim(String str) {
+  while (str.size > 0 && (str.str[0] == ' ' || str.str[0] == '\t')) {
+    str.str  += 1;
+    str.size -= 1;
+  }
+  while (str.size > 0 && (str.str[str.size - 1] == ' ' || str.str[str.size - 1] == '\t')) {
+    str.size -= 1;
+  }
+  return str;
+}
 
-    if (!a_exists && MemoryMatch(&it, &a, sizeof(Vertex))) {
-      GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = i;
-      GRenderer.triangles_indices_count += 1;
-      a_exists = true;
+/* [+-]digits[.digits][(e|E)[+-]digits], 0 on anything else */
+internal f32 _obj_parse_f32(String token) {
+  local_persist f64 powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  u8* at  = token.str;
+  u8* end = token.str + token.size;
+  
+  f64 sign = 1.0;
+  if (at < end && (*at == '-' || *at == '+')) {
+    sign = *at == '-' ? -1.0 : 1.0;
+    at += 1;
+  }
+  
+  // NOTE(fz): 19 significant digits fit a u64, the ones past that only move the exponent.
+  u64 mantissa = 0;
+  u32 digits   = 0;
+  s32 exponent = 0;
+  for (; at < end && *at >= '0' && *at <= '9'; at += 1) {
+    if (digits < 19) {
+      mantissa = mantissa*10 + (*at - '0');
+      digits  += (mantissa != 0);
+    } else {
+      exponent += 1;
     }
-    if (!b_exists && MemoryMatch(&it, &b, sizeof(Vertex))) {
-      GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = i;
-      GRenderer.triangles_indices_count += 1;
-      b_exists = true;
+  }
+  if (at < end && *at == '.') {
+    for (at += 1; at < end && *at >= '0' && *at <= '9'; at += 1) {
+      if (digits < 19) {
+        mantissa  = mantissa*10 + (*at - '0');
+        digits   += (mantissa != 0);
+        exponent -= 1;
+      }
     }
-    if (!c_exists && MemoryMatch(&it, &c, sizeof(Vertex))) {
-      GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = i;
-      GRenderer.triangles_indices_count += 1;
-      c_exists = true;
+  }
+  if (at < end && (*at == 'e' || *at == 'E')) {
+    at += 1;
+    s32 exponent_sign = 1;
+    if (at < end && (*at == '-' || *at == '+')) {
+      exponent_sign = *at == '-' ? -1 : 1;
+      at += 1;
     }
-    if (a_exists && b_exists && c_exists) {
-      break;
+    s32 value = 0;
+    for (; at < end && *at >= '0' && *at <= '9'; at += 1) {
+      value = Min(value*10 + (*at - '0'), 100000);
     }
+    exponent += exponent_sign*value;
   }
+  
+  f64 result = (f64)mantissa;
+  for (; exponent > 22; exponent -= 22)  result *= powers_of_ten[22];
+  for (; exponent < -22; exponent += 22) result /= powers_of_ten[22];
+  result = exponent >= 0 ? result*powers_of_ten[exponent] : result/powers_of_ten[-exponent];
+  return (f32)(sign*result);
+}
 
-  if (!a_exists) {
-    GRenderer.vertices_data[GRenderer.vertices_count] = a;
-    GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = GRenderer.vertices_count;
-    GRenderer.vertices_count          += 1;
-    GRenderer.triangles_indices_count += 1;
+/* One based, or negative from the end of the count elements read so far. Returns the zero based index, -1 when missing */
+internal s32 _obj_parse_index(String token, u32 count) {
+  u8* at  = token.str;
+  u8* end = token.str + token.size;
+  b32 negative = at < end && *at == '-';
+  at += negative;
+  s64 value = 0;
+  for (; at < end && *at >= '0' && *at <= '9'; at += 1) {
+    value = Min(value*10 + (*at - '0'), (s64)S32_MAX);
   }
-  if (!b_exists) {
-    GRenderer.vertices_data[GRenderer.vertices_count] = b;
-    GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = GRenderer.vertices_count;
-    GRenderer.vertices_count          += 1;
-    GRenderer.triangles_indices_count += 1;
+  s64 result = negative ? (s64)count - value : value - 1;
+  return (value == 0 || result < 0) ? -1 : (s32)result;
+}
+
+typedef struct Obj_Material_Event {
+  u32    triangle; // Chunk local, first one drawn with it
+  s32    material;
+  String name;
+} Obj_Material_Event;
+
+typedef struct Obj_Chunk {
+  u8* first;
+  u8* one_past_last;
+  
+  // Counted by the first pass, the prefix sum then turns them into where the chunk starts in the Obj_Data arrays
+  u32 position_count, texcoord_count, normal_count, triangle_count;
+  u32 position_first, texcoord_first, normal_first, triangle_first;
+  
+  Arena*              events_arena;
+  Obj_Material_Event* events;
+  u32                 events_count;
+  s32                 first_material; // In effect at the chunk start, set by an earlier chunk
+  String              mtllib;
+} Obj_Chunk;
+
+typedef struct Obj_Parse_Context {
+  Obj_Chunk* chunks;
+  Obj_Data*  obj;
+} Obj_Parse_Context;
+
+internal void _obj_count_chunks(void* context, u64 first, u64 one_past_last) {
+  Obj_Parse_Context* parse = (Obj_Parse_Context*)context;
+  for (u64 c = first; c < one_past_last; c += 1) {
+    Obj_Chunk* chunk = &parse->chunks[c];
+    u8* at = chunk->first;
+    while (at < chunk->one_past_last) {
+      String line    = _obj_next_line(&at, chunk->one_past_last);
+      String keyword = _obj_next_token(&line);
+      if (keyword.size == 0 || keyword.str[0] == '#') {
+        continue;
+      }
+      if (strings_match(keyword, StringLiteral("v"))) {
+        chunk->position_count += 1;
+      } else if (strings_match(keyword, StringLiteral("vt"))) {
+        chunk->texcoord_count += 1;
+      } else if (strings_match(keyword, StringLiteral("vn"))) {
+        chunk->normal_count += 1;
+      } else if (strings_match(keyword, StringLiteral("f"))) {
+        u32 corners = 0;
+        while (_obj_next_token(&line).size > 0) {
+          corners += 1;
+        }
+        chunk->triangle_count += corners >= 3 ? corners - 2 : 0;
+      } else if (strings_match(keyword, StringLiteral("usemtl"))) {
+        if (chunk->events_arena == NULL) {
+          chunk->events_arena = arena_init();
+          chunk->events       = ArenaPushNoZero(chunk->events_arena, Obj_Material_Event, 0);
+        }
+        Obj_Material_Event* event = ArenaPushNoZero(chunk->events_arena, Obj_Material_Event, 1);
+        event->triangle = chunk->triangle_count;
+        event->material = -1;
+        event->name     = _obj_trim(line);
+        chunk->events_count += 1;
+      } else if (strings_match(keyword, StringLiteral("mtllib")) && chunk->mtllib.size == 0) {
+        chunk->mtllib = _obj_trim(line);
+      }
+    }
   }
-  if (!c_exists) {
-    GRenderer.vertices_data[GRenderer.vertices_count] = c;
-    GRenderer.triangles_indices_data[GRenderer.triangles_indices_count] = GRenderer.vertices_count;
-    GRenderer.vertices_count          += 1;
-    GRenderer.triangles_indices_count += 1;
+}
+
+internal void _obj_parse_chunks(void* context, u64 first, u64 one_past_last) {
+  Obj_Parse_Context* parse = (Obj_Parse_Context*)context;
+  Obj_Data* obj = parse->obj;
+  for (u64 c = first; c < one_past_last; c += 1) {
+    Obj_Chunk* chunk = &parse->chunks[c];
+    f32* positions = obj->positions + (u64)chunk->position_first*3;
+    f32* texcoords = obj->texcoords + (u64)chunk->texcoord_first*2;
+    f32* normals   = obj->normals   + (u64)chunk->normal_first*3;
+    Obj_Corner* corners = obj->corners + (u64)chunk->triangle_first*3;
+    s32* materials      = obj->triangle_materials + chunk->triangle_first;
+    u32 position_count = chunk->position_first;
+    u32 texcoord_count = chunk->texcoord_first;
+    u32 normal_count   = chunk->normal_first;
+    u32 events_index   = 0;
+    s32 material       = chunk->first_material;
+    
+    u8* at = chunk->first;
+    while (at < chunk->one_past_last) {
+      String line    = _obj_next_line(&at, chunk->one_past_last);
+      String keyword = _obj_next_token(&line);
+      if (keyword.size == 0 || keyword.str[0] == '#') {
+        continue;
+      }
+      if (strings_match(keyword, StringLiteral("v"))) {
+        positions[0] = _obj_parse_f32(_obj_next_token(&line));
+        positions[1] = _obj_parse_f32(_obj_next_token(&line));
+        positions[2] = _obj_parse_f32(_obj_next_token(&line));
+        positions += 3;
+        position_count += 1;
+      } else if (strings_match(keyword, StringLiteral("vt"))) {
+        texcoords[0] = _obj_parse_f32(_obj_next_token(&line));
+        texcoords[1] = _obj_parse_f32(_obj_next_token(&line));
+        texcoords += 2;
+        texcoord_count += 1;
+      } else if (strings_match(keyword, StringLiteral("vn"))) {
+        normals[0] = _obj_parse_f32(_obj_next_token(&line));
+        normals[1] = _obj_parse_f32(_obj_next_token(&line));
+        normals[2] = _obj_parse_f32(_obj_next_token(&line));
+        normals += 3;
+        normal_count += 1;
+      } else if (strings_match(keyword, StringLiteral("f"))) {
+        // NOTE(fz): Polygons are fanned around their first corner.
+        Obj_Corner fan[2];
+        u32 corner_index = 0;
+        for (String token = _obj_next_token(&line); token.size > 0; token = _obj_next_token(&line), corner_index += 1) {
+          Obj_Corner corner = { -1, -1, -1 };
+          String v  = token;
+          String vt = { 0 };
+          String vn = { 0 };
+          for (u64 i = 0; i < v.size; i += 1) {
+            if (v.str[i] == '/') {
+              vt = string_range(v.str + i + 1, token.str + token.size);
+              v.size = i;
+              break;
+            }
+          }
+          for (u64 i = 0; i < vt.size; i += 1) {
+            if (vt.str[i] == '/') {
+              vn = string_range(vt.str + i + 1, token.str + token.size);
+              vt.size = i;
+              break;
+            }
+          }
+          corner.v  = _obj_parse_index(v,  position_count);
+          corner.vt = _obj_parse_index(vt, texcoord_count);
+          corner.vn = _obj_parse_index(vn, normal_count);
+          
+          if (corner_index < 2) {
+            fan[corner_index] = corner;
+            continue;
+          }
+          corners[0] = fan[0];
+          corners[1] = fan[1];
+          corners[2] = corner;
+          corners   += 3;
+          *materials = material;
+          materials += 1;
+          fan[1] = corner;
+        }
+      } else if (strings_match(keyword, StringLiteral("usemtl"))) {
+        material = chunk->events[events_index].material;
+        events_index += 1;
+      }
+    }
   }
 }
 
-internal void renderer_push_line(Vector3 a_position, Vector3 b_position, u32 texture) {
-  if (GRenderer.lines_indices_count + 3 > GRenderer.lines_indices_capacity) {
-    printf("Too many lines indices");
-    Assert(0);
+/* Two passes over newline aligned chunks of the file, one thread each: count the records, then parse them in
+ * place once a prefix sum over the counts gave every chunk its range of the output arrays. */
+internal Obj_Data _obj_parse(u8* data, u64 size, String path) {
+  Obj_Data result = { 0 };
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  u32 chunk_count = parallel_for_thread_count(size, Obj_Min_Chunk_Size);
+  Obj_Chunk* chunks = ArenaPush(scratch.arena, Obj_Chunk, chunk_count);
+  u8* end = data + size;
+  for (u32 i = 0; i < chunk_count; i += 1) {
+    u8* first = data + size*i/chunk_count;
+    if (i > 0) {
+      first = Max(first, chunks[i - 1].first);
+      while (first < end && first[-1] != '\n') {
+        first += 1;
+      }
+      chunks[i - 1].one_past_last = first;
+    }
+    chunks[i].first = first;
   }
-  if (GRenderer.vertices_count + 3 > GRenderer.vertices_capacity) {
-    printf("Too many vertices");
+  chunks[chunk_count - 1].one_past_last = end;
+  
+  Obj_Parse_Context context = { chunks, &result };
+  parallel_for(chunk_count, 1, _obj_count_chunks, &context);
+  
+  String mtllib = { 0 };
+  u64 totals[4] = { 0 };
+  for (u32 i = 0; i < chunk_count; i += 1) {
+    Obj_Chunk* chunk = &chunks[i];
+    chunk->position_first = (u32)totals[0]; totals[0] += chunk->position_count;
+    chunk->texcoord_first = (u32)totals[1]; totals[1] += chunk->texcoord_count;
+    chunk->normal_first   = (u32)totals[2]; totals[2] += chunk->normal_count;
+    chunk->triangle_first = (u32)totals[3]; totals[3] += chunk->triangle_count;
+    if (mtllib.size == 0) {
+      mtllib = chunk->mtllib;
+    }
+  }
+  if (totals[0] > U32_MAX || totals[1] > U32_MAX || totals[2] > U32_MAX || totals[3]*3 > U32_MAX) {
+    printf("Error: %s has more elements than 32 bit indices can address.\n", path.str);
     Assert(0);
+    for (u32 i = 0; i < chunk_count; i += 1) {
+      if (chunks[i].events_arena) arena_free(chunks[i].events_arena);
+    }
+    scratch_end(&scratch);
+    return result;
   }
-
-  Vertex a = vertex(a_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture);
-  Vertex b = vertex(b_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture);
   
-  b32 a_exists = false;
-  b32 b_exists = false;
-  for (u32 i = 0; i < GRenderer.vertices_count; i += 1) {
-    Vertex it = GRenderer.vertices_data[i];
-
-    if (!a_exists && MemoryMatch(&it, &a, sizeof(Vertex))) {
-      GRenderer.lines_indices_data[GRenderer.lines_indices_count] = i;
-      GRenderer.lines_indices_count += 1;
-      a_exists = true;
+  // Materials, the library path is relative to the OBJ
+  if (mtllib.size > 0) {
+    u64 directory = path.size;
+    while (directory > 0 && path.str[directory - 1] != '/' && path.str[directory - 1] != '\\') {
+      directory -= 1;
     }
-    if (!b_exists && MemoryMatch(&it, &b, sizeof(Vertex))) {
-      GRenderer.lines_indices_data[GRenderer.lines_indices_count] = i;
-      GRenderer.lines_indices_count += 1;
-      b_exists = true;
+    u8* mtl_path = ArenaPush(scratch.arena, u8, directory + mtllib.size + 1);
+    MemoryCopy(mtl_path, path.str, directory);
+    MemoryCopy(mtl_path + directory, mtllib.str, mtllib.size);
+    if (tinyobj_parse_mtl_file(&result.materials, &result.material_count, (char*)mtl_path) != TINYOBJ_SUCCESS) {
+      printf("Failed to parse material library %s.\n", mtl_path);
     }
-    if (a_exists && b_exists) {
-      break;
+  }
+  s32 material = -1;
+  for (u32 i = 0; i < chunk_count; i += 1) {
+    Obj_Chunk* chunk = &chunks[i];
+    chunk->first_material = material;
+    for (u32 j = 0; j < chunk->events_count; j += 1) {
+      Obj_Material_Event* event = &chunk->events[j];
+      for (u32 k = 0; k < result.material_count && event->material < 0; k += 1) {
+        char* name = result.materials[k].name;
+        if (name && strlen(name) == event->name.size && MemoryMatch(name, event->name.str, event->name.size)) {
+          event->material = (s32)k;
+        }
+      }
+      material = event->material;
     }
   }
+  
+  result.position_count = (u32)totals[0];
+  result.texcoord_count = (u32)totals[1];
+  result.normal_count   = (u32)totals[2];
+  result.triangle_count = (u32)totals[3];
+  u64 bytes = sizeof(f32)*(totals[0]*3 + totals[1]*2 + totals[2]*3) + (sizeof(Obj_Corner)*3 + sizeof(s32))*totals[3];
+  result.arena              = arena_init_sized(AlignPow2(bytes + Megabytes(1), Megabytes(1)), Megabytes(1));
+  result.positions          = ArenaPushNoZero(result.arena, f32, totals[0]*3);
+  result.texcoords          = ArenaPushNoZero(result.arena, f32, totals[1]*2);
+  result.normals            = ArenaPushNoZero(result.arena, f32, totals[2]*3);
+  result.corners            = ArenaPushNoZero(result.arena, Obj_Corner, totals[3]*3);
+  result.triangle_materials = ArenaPushNoZero(result.arena, s32, totals[3]);
+  parallel_for(chunk_count, 1, _obj_parse_chunks, &context);
+  
+  for (u32 i = 0; i < chunk_count; i += 1) {
+    if (chunks[i].events_arena) arena_free(chunks[i].events_arena);
+  }
+  scratch_end(&scratch);
+  return result;
+}
+
+/* Turns the parsed attributes into one indexed, deduplicated mesh per material */
+internal void _renderer_import_obj(Model* model, Obj_Data* obj) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  // NOTE(fz): Meshes are split per material, the default one goes last.
+  u32 material_count   = obj->material_count;
+  u32 default_material = material_count;
+  model->material_count = material_count + 1;
+  model->materials_data = ArenaPush(model->arena, Material, model->material_count);
+  for (u32 i = 0; i < model->material_count; i += 1) {
+    Material* material = &model->materials_data[i];
+    material->shader = GRenderer.main_shader;
+    material->maps   = ArenaPush(model->arena, MaterialMap, 1);
+    if (i < material_count) {
+      tinyobj_material_t* source = &obj->materials[i];
+      material->maps[0].color = vector4(source->diffuse[0], source->diffuse[1], source->diffuse[2], source->dissolve);
+      material->maps[0].value = source->shininess;
+    } else {
+      material->maps[0].color = vector4(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+  }
+  
+  // Triangles, bucketed by material with a counting sort. The ones with a missing position are dropped.
+  u32  face_count         = obj->triangle_count;
+  u32* face_material      = ArenaPushNoZero(scratch.arena, u32, face_count);
+  u32* material_triangles = ArenaPush(scratch.arena, u32, model->material_count + 1);
+  u32  triangle_count     = 0;
+  {
+    for (u32 i = 0; i < face_count; i += 1) {
+      Obj_Corner* corners = obj->corners + i*3;
+      b32 valid = 1;
+      for (u32 j = 0; j < 3; j += 1) {
+        valid &= corners[j].v >= 0 && (u32)corners[j].v < obj->position_count;
+      }
+      if (!valid) {
+        face_material[i] = U32_MAX;
+        continue;
+      }
+      s32 material_id = obj->triangle_materials[i];
+      face_material[i] = (material_id >= 0 && (u32)material_id < material_count) ? (u32)material_id : default_material;
+      material_triangles[face_material[i] + 1] += 1;
+      triangle_count += 1;
+    }
+  }
+  for (u32 i = 0; i < model->material_count; i += 1) {
+    material_triangles[i + 1] += material_triangles[i];
+  }
+  u32* sorted_faces = ArenaPushNoZero(scratch.arena, u32, triangle_count);
+  {
+    u32* cursor = ArenaPushNoZero(scratch.arena, u32, model->material_count);
+    MemoryCopy(cursor, material_triangles, model->material_count * sizeof(u32));
+    for (u32 i = 0; i < face_count; i += 1) {
+      if (face_material[i] != U32_MAX) {
+        sorted_faces[cursor[face_material[i]]++] = i;
+      }
+    }
+  }
+  
+  // Welding, then area weighted normals on the welded positions for corners that come without one
+  u32* weld = ArenaPushNoZero(scratch.arena, u32, obj->position_count);
+  _obj_weld_positions(obj->positions, obj->position_count, Obj_Weld_Epsilon, weld);
+  
+  Vector3* positions = (Vector3*)obj->positions;
+  Vector3* generated_normals = NULL;
+  for (u32 i = 0; i < triangle_count && generated_normals == NULL; i += 1) {
+    Obj_Corner* corners = obj->corners + sorted_faces[i]*3;
+    for (u32 j = 0; j < 3; j += 1) {
+      if (corners[j].vn < 0 || (u32)corners[j].vn >= obj->normal_count) {
+        generated_normals = ArenaPush(scratch.arena, Vector3, obj->position_count);
+        break;
+      }
+    }
+  }
+  if (generated_normals) {
+    for (u32 i = 0; i < triangle_count; i += 1) {
+      Obj_Corner* corners = obj->corners + sorted_faces[i]*3;
+      u32 a = weld[corners[0].v], b = weld[corners[1].v], c = weld[corners[2].v];
+      Vector3 normal = vector3_cross(sub(positions[b], positions[a]), sub(positions[c], positions[a]));
+      generated_normals[a] = vector3_add(generated_normals[a], normal);
+      generated_normals[b] = vector3_add(generated_normals[b], normal);
+      generated_normals[c] = vector3_add(generated_normals[c], normal);
+    }
+  }
+  
+  model->mesh_count = 0;
+  for (u32 i = 0; i < model->material_count; i += 1) {
+    model->mesh_count += (material_triangles[i + 1] > material_triangles[i]);
+  }
+  model->meshes_data   = ArenaPush(model->arena, Mesh, model->mesh_count);
+  model->mesh_material = ArenaPush(model->arena, u32, model->mesh_count);
+  
+  u32 mesh_index = 0;
+  for (u32 material = 0; material < model->material_count; material += 1) {
+    u32 first = material_triangles[material];
+    u32 count = material_triangles[material + 1] - first;
+    if (count == 0) {
+      continue;
+    }
+    
+    Arena_Temp mesh_scratch = arena_temp_begin(scratch.arena);
+    u32 corner_count = count*3;
+    
+    // Dedup on (welded position, uv, normal) with an open addressed table of vertex index + 1
+    u32 capacity = 1;
+    while (capacity < corner_count*2) {
+      capacity *= 2;
+    }
+    u32  mask  = capacity - 1;
+    u32* slots = ArenaPush(mesh_scratch.arena, u32, capacity);
+    u32* keys  = ArenaPushNoZero(mesh_scratch.arena, u32, corner_count*3);
+    u32* indices = ArenaPushNoZero(model->arena, u32, corner_count);
+    u32  vertex_count = 0;
+    
+    for (u32 i = 0; i < count; i += 1) {
+      Obj_Corner* corners = obj->corners + sorted_faces[first + i]*3;
+      for (u32 j = 0; j < 3; j += 1) {
+        Obj_Corner corner = corners[j];
+        u32 key[3];
+        key[0] = weld[corner.v];
+        key[1] = (corner.vt >= 0 && (u32)corner.vt < obj->texcoord_count) ? (u32)corner.vt : U32_MAX;
+        key[2] = (corner.vn >= 0 && (u32)corner.vn < obj->normal_count)   ? (u32)corner.vn : U32_MAX;
+        
+        u64 hash = _renderer_hash_cell(key[0], key[1], key[2]);
+        u32 slot = (u32)hash & mask;
+        for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+          if (MemoryMatch(keys + (slots[slot] - 1)*3, key, sizeof(key))) {
+            break;
+          }
+        }
+        if (slots[slot] == 0) {
+          MemoryCopy(keys + vertex_count*3, key, sizeof(key));
+          vertex_count += 1;
+          slots[slot] = vertex_count;
+        }
+        indices[i*3 + j] = slots[slot] - 1;
+      }
+    }
+    
+    Mesh* mesh = &model->meshes_data[mesh_index];
+    mesh->vertex_count   = vertex_count;
+    mesh->triangle_count = count;
+    mesh->indices        = indices;
+    mesh->vertices       = ArenaPushNoZero(model->arena, Vector3, vertex_count);
+    mesh->uv             = ArenaPushNoZero(model->arena, Vector2, vertex_count);
+    mesh->normals        = ArenaPushNoZero(model->arena, Vector3, vertex_count);
+    for (u32 i = 0; i < vertex_count; i += 1) {
+      u32* key = keys + i*3;
+      mesh->vertices[i] = positions[key[0]];
+      mesh->uv[i]       = key[1] != U32_MAX ? vector2(obj->texcoords[key[1]*2], obj->texcoords[key[1]*2 + 1]) : vector2(0.0f, 0.0f);
+      mesh->normals[i]  = key[2] != U32_MAX ? vector3(obj->normals[(u64)key[2]*3], obj->normals[(u64)key[2]*3 + 1], obj->normals[(u64)key[2]*3 + 2]) : vector3_normalize(generated_normals[key[0]]);
+    }
+    model->mesh_material[mesh_index] = material;
+    mesh_index += 1;
+    
+    arena_temp_end(&mesh_scratch);
+  }
+  
+  scratch_end(&scratch);
+}
+
+/* FIFO post-transform cache of cache_size entries. A vertex hits while fewer than cache_size misses happened since it was loaded. */
+internal u32 _mesh_fifo_misses(u32* indices, u32 triangle_count, u32 cache_size, u32* timestamps, u32* time) {
+  u32 result = 0;
+  for (u32 i = 0; i < triangle_count*3; i += 1) {
+    u32 v = indices[i];
+    if (*time - timestamps[v] > cache_size) {
+      timestamps[v] = *time;
+      *time   += 1;
+      result  += 1;
+    }
+  }
+  return result;
+}
+
+internal Mesh_Cache_Stats mesh_analyze_vertex_cache(Mesh* mesh, u32 cache_size) {
+  Mesh_Cache_Stats result = { 0 };
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32* timestamps = ArenaPush(scratch.arena, u32, mesh->vertex_count);
+  u32  time       = cache_size + 1;
+  result.misses    = _mesh_fifo_misses(mesh->indices, mesh->triangle_count, cache_size, timestamps, &time);
+  result.triangles = mesh->triangle_count;
+  result.vertices  = mesh->vertex_count;
+  result.acmr      = mesh->triangle_count ? (f32)result.misses / (f32)mesh->triangle_count : 0.0f;
+  result.atvr      = mesh->vertex_count   ? (f32)result.misses / (f32)mesh->vertex_count   : 0.0f;
+  scratch_end(&scratch);
+  return result;
+}
+
+/* Tipsify (Sander, Nehab, Barczak 2007). Fans around the vertex that will stay in cache the longest.
+ * Writes the new order to out and the triangle index of every cache restart to boundaries. */
+internal u32 _mesh_tipsify(u32* indices, u32 triangle_count, u32 vertex_count, u32 cache_size, u32* out, u32* boundaries) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32 index_count = triangle_count*3;
+  
+  // Vertex -> triangles adjacency
+  u32* live    = ArenaPush(scratch.arena, u32, vertex_count);
+  u32* offsets = ArenaPushNoZero(scratch.arena, u32, vertex_count + 1);
+  u32* adjacency = ArenaPushNoZero(scratch.arena, u32, index_count);
+  for (u32 i = 0; i < index_count; i += 1) {
+    live[indices[i]] += 1;
+  }
+  offsets[0] = 0;
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    offsets[i + 1] = offsets[i] + live[i];
+  }
+  {
+    u32* cursor = ArenaPushNoZero(scratch.arena, u32, vertex_count);
+    MemoryCopy(cursor, offsets, sizeof(u32)*vertex_count);
+    for (u32 i = 0; i < index_count; i += 1) {
+      adjacency[cursor[indices[i]]++] = i / 3;
+    }
+  }
+  
+  u32* cache_time = ArenaPush(scratch.arena, u32, vertex_count);
+  u8*  emitted    = ArenaPush(scratch.arena, u8, triangle_count);
+  u32* dead_end   = ArenaPushNoZero(scratch.arena, u32, index_count);
+  u32* candidates = ArenaPushNoZero(scratch.arena, u32, index_count);
+  u32  dead_end_count = 0;
+  u32  time           = cache_size + 1;
+  u32  scan           = 0;
+  u32  out_count      = 0;
+  u32  result         = 0;
+  
+  u32 fan = U32_MAX;
+  for (; scan < vertex_count && fan == U32_MAX; scan += 1) {
+    if (live[scan] > 0) fan = scan;
+  }
+  
+  while (fan != U32_MAX) {
+    u32 candidates_count = 0;
+    for (u32 k = offsets[fan]; k < offsets[fan + 1]; k += 1) {
+      u32 t = adjacency[k];
+      if (emitted[t]) {
+        continue;
+      }
+      emitted[t] = 1;
+      for (u32 c = 0; c < 3; c += 1) {
+        u32 v = indices[t*3 + c];
+        out[out_count++]               = v;
+        dead_end[dead_end_count++]     = v;
+        candidates[candidates_count++] = v;
+        live[v] -= 1;
+        if (time - cache_time[v] > cache_size) {
+          cache_time[v] = time;
+          time += 1;
+        }
+      }
+    }
+    
+    // NOTE(fz): Prefer the oldest candidate that is still in cache once its remaining triangles are emitted.
+    fan = U32_MAX;
+    s64 best_priority = -1;
+    for (u32 i = 0; i < candidates_count; i += 1) {
+      u32 v = candidates[i];
+      if (live[v] == 0) {
+        continue;
+      }
+      s64 priority = 0;
+      if (time - cache_time[v] + 2*live[v] <= cache_size) {
+        priority = time - cache_time[v];
+      }
+      if (priority > best_priority) {
+        best_priority = priority;
+        fan           = v;
+      }
+    }
+    
+    if (fan == U32_MAX) {
+      while (dead_end_count > 0 && fan == U32_MAX) {
+        u32 v = dead_end[--dead_end_count];
+        if (live[v] > 0) fan = v;
+      }
+      for (; scan < vertex_count && fan == U32_MAX; scan += 1) {
+        if (live[scan] > 0) fan = scan;
+      }
+      if (fan != U32_MAX) {
+        boundaries[result++] = out_count / 3;
+      }
+    }
+  }
+  
+  scratch_end(&scratch);
+  return result;
+}
+
+/* Sander et al. 2007, the Tipsify clusters are split further where their cache efficiency allows it,
+ * then drawn outermost first so triangles facing away from the mesh centre tend to occlude the rest. */
+internal void _mesh_sort_clusters(Mesh* mesh, u32* indices, u32* boundaries, u32 boundary_count, u32 cache_size, f32 threshold, u32* out) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32  triangle_count = mesh->triangle_count;
+  u32* clusters       = ArenaPushNoZero(scratch.arena, u32, triangle_count + 1); // First triangle of each, plus the end
+  u32  cluster_count  = 0;
+  u32* timestamps     = ArenaPush(scratch.arena, u32, mesh->vertex_count);
+  u32  time           = cache_size + 1;
+  
+  // Soft boundaries: start a new cluster once the current one is already about as cache friendly as its hard cluster
+  for (u32 hard = 0; hard <= boundary_count; hard += 1) {
+    u32 first = hard == 0 ? 0 : boundaries[hard - 1];
+    u32 last  = hard == boundary_count ? triangle_count : boundaries[hard];
+    if (first == last) {
+      continue;
+    }
+    time += cache_size + 1;
+    f32 hard_acmr = (f32)_mesh_fifo_misses(indices + first*3, last - first, cache_size, timestamps, &time) / (f32)(last - first);
+    
+    time += cache_size + 1;
+    u32 start  = first;
+    u32 misses = 0;
+    clusters[cluster_count++] = first;
+    for (u32 t = first; t < last; t += 1) {
+      misses += _mesh_fifo_misses(indices + t*3, 1, cache_size, timestamps, &time);
+      u32 size = t + 1 - start;
+      if (t + 1 < last && (f32)misses <= threshold*hard_acmr*(f32)size) {
+        clusters[cluster_count++] = t + 1;
+        start  = t + 1;
+        misses = 0;
+        time  += cache_size + 1;
+      }
+    }
+  }
+  clusters[cluster_count] = triangle_count;
+  
+  // Area weighted centroid and normal, per cluster and for the whole mesh
+  Vector3* cluster_centroid = ArenaPushNoZero(scratch.arena, Vector3, cluster_count);
+  Vector3* cluster_normal   = ArenaPushNoZero(scratch.arena, Vector3, cluster_count);
+  Vector3  mesh_centroid    = vector3(0.0f, 0.0f, 0.0f);
+  f32      mesh_area        = 0.0f;
+  for (u32 c = 0; c < cluster_count; c += 1) {
+    Vector3 centroid = vector3(0.0f, 0.0f, 0.0f);
+    Vector3 normal   = vector3(0.0f, 0.0f, 0.0f);
+    f32     area     = 0.0f;
+    for (u32 t = clusters[c]; t < clusters[c + 1]; t += 1) {
+      Vector3 a = mesh->vertices[indices[t*3 + 0]];
+      Vector3 b = mesh->vertices[indices[t*3 + 1]];
+      Vector3 d = mesh->vertices[indices[t*3 + 2]];
+      Vector3 n = vector3_cross(sub(b, a), sub(d, a));
+      f32 w     = vector3_length(n);
+      centroid  = vector3_add(centroid, vector3_scale(vector3_add(vector3_add(a, b), d), w / 3.0f));
+      normal    = vector3_add(normal, n);
+      area     += w;
+    }
+    mesh_centroid = vector3_add(mesh_centroid, centroid);
+    mesh_area    += area;
+    cluster_centroid[c] = area > 0.0f ? vector3_scale(centroid, 1.0f / area) : mesh->vertices[indices[clusters[c]*3]];
+    cluster_normal[c]   = normal;
+  }
+  if (mesh_area > 0.0f) {
+    mesh_centroid = vector3_scale(mesh_centroid, 1.0f / mesh_area);
+  }
+  
+  u32* order = ArenaPushNoZero(scratch.arena, u32, cluster_count);
+  f32* keys  = ArenaPushNoZero(scratch.arena, f32, cluster_count);
+  for (u32 c = 0; c < cluster_count; c += 1) {
+    f32 length = vector3_length(cluster_normal[c]);
+    order[c] = c;
+    keys[c]  = length > 0.0f ? vector3_dot(sub(cluster_centroid[c], mesh_centroid), cluster_normal[c]) / length : 0.0f;
+  }
+  _renderer_sort_descending(order, keys, cluster_count, ArenaPushNoZero(scratch.arena, u32, cluster_count));
+  
+  u32 out_count = 0;
+  for (u32 i = 0; i < cluster_count; i += 1) {
+    u32 c = order[i];
+    u32 count = (clusters[c + 1] - clusters[c])*3;
+    MemoryCopy(out + out_count, indices + clusters[c]*3, sizeof(u32)*count);
+    out_count += count;
+  }
+  scratch_end(&scratch);
+}
+
+internal void mesh_optimize_vertex_cache(Mesh* mesh, u32 cache_size, f32 overdraw_threshold) {
+  if (mesh->triangle_count == 0) {
+    return;
+  }
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32* tipsified  = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count*3);
+  u32* boundaries = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count);
+  u32 boundary_count = _mesh_tipsify(mesh->indices, mesh->triangle_count, mesh->vertex_count, cache_size, tipsified, boundaries);
+  _mesh_sort_clusters(mesh, tipsified, boundaries, boundary_count, cache_size, overdraw_threshold, mesh->indices);
+  scratch_end(&scratch);
+}
+
+internal void mesh_optimize_vertex_fetch(Mesh* mesh) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32* remap = ArenaPushNoZero(scratch.arena, u32, mesh->vertex_count);
+  MemorySet(remap, 0xFF, sizeof(u32)*mesh->vertex_count);
+  
+  u32 count = 0;
+  for (u32 i = 0; i < mesh->triangle_count*3; i += 1) {
+    u32 v = mesh->indices[i];
+    if (remap[v] == U32_MAX) {
+      remap[v] = count++;
+    }
+    mesh->indices[i] = remap[v];
+  }
+  
+  // NOTE(fz): Vertices no triangle references are dropped.
+  Vector3* vertices = ArenaPushNoZero(scratch.arena, Vector3, count);
+  Vector2* uv       = ArenaPushNoZero(scratch.arena, Vector2, count);
+  Vector3* normals  = ArenaPushNoZero(scratch.arena, Vector3, count);
+  for (u32 i = 0; i < mesh->vertex_count; i += 1) {
+    if (remap[i] == U32_MAX) continue;
+    vertices[remap[i]] = mesh->vertices[i];
+    uv[remap[i]]       = mesh->uv[i];
+    normals[remap[i]]  = mesh->normals[i];
+  }
+  MemoryCopy(mesh->vertices, vertices, sizeof(Vector3)*count);
+  MemoryCopy(mesh->uv,       uv,       sizeof(Vector2)*count);
+  MemoryCopy(mesh->normals,  normals,  sizeof(Vector3)*count);
+  mesh->vertex_count = count;
+  scratch_end(&scratch);
+}
+
+/* Sum of squared distances to a set of planes, as the symmetric A, b, c of v.A.v + 2 b.v + c */
+typedef struct Mesh_Quadric {
+  f32 a00, a11, a22, a01, a02, a12;
+  f32 b0, b1, b2;
+  f32 c;
+} Mesh_Quadric;
+
+internal void _mesh_quadric_add_plane(Mesh_Quadric* q, Vector3 n, f32 d, f32 weight) {
+  q->a00 += weight*n.x*n.x; q->a11 += weight*n.y*n.y; q->a22 += weight*n.z*n.z;
+  q->a01 += weight*n.x*n.y; q->a02 += weight*n.x*n.z; q->a12 += weight*n.y*n.z;
+  q->b0  += weight*n.x*d;   q->b1  += weight*n.y*d;   q->b2  += weight*n.z*d;
+  q->c   += weight*d*d;
+}
+
+internal void _mesh_quadric_add(Mesh_Quadric* q, Mesh_Quadric* other) {
+  f32* a = (f32*)q;
+  f32* b = (f32*)other;
+  for (u32 i = 0; i < sizeof(Mesh_Quadric)/sizeof(f32); i += 1) {
+    a[i] += b[i];
+  }
+}
+
+internal f32 _mesh_quadric_error(Mesh_Quadric* q, Vector3 v) {
+  f32 result = v.x*(q->a00*v.x + 2.0f*(q->a01*v.y + q->a02*v.z + q->b0)) +
+               v.y*(q->a11*v.y + 2.0f*(q->a12*v.z + q->b1)) +
+               v.z*(q->a22*v.z + 2.0f*q->b2) + q->c;
+  return Max(result, 0.0f);
+}
+
+internal Vector3 _mesh_triangle_normal(Vector3 a, Vector3 b, Vector3 c) {
+  return vector3_cross(sub(b, a), sub(c, a));
+}
+
+/* Quadric error metric edge collapses (Garland, Heckbert 1997), each vertex collapsing onto a neighbour so the
+ * vertex arrays stay shared with the full mesh. Vertices on borders and attribute seams never move.
+ * Writes at most mesh->triangle_count triangles to out and returns their count, error is the largest distance
+ * to the original surface in mesh space. */
+internal u32 mesh_simplify(Mesh* mesh, u32 target_triangle_count, u32* out, f32* error) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32 vertex_count = mesh->vertex_count;
+  u32 count        = mesh->triangle_count;
+  MemoryCopy(out, mesh->indices, sizeof(u32)*3*(u64)count);
+  *error = 0.0f;
+  
+  // NOTE(fz): Work in the unit cube so the f32 quadrics keep their precision whatever the mesh scale.
+  AABB bounds = aabb_from_points(mesh->vertices, vertex_count);
+  Vector3 size = sub(bounds.max, bounds.min);
+  f32 extent = Max(Max(size.x, size.y), Max(size.z, 1e-20f));
+  Vector3* positions = ArenaPushNoZero(scratch.arena, Vector3, vertex_count);
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    positions[i] = vector3_scale(sub(mesh->vertices[i], bounds.min), 1.0f / extent);
+  }
+  
+  // Locks: vertices sharing their position with another one (uv or normal seams), and open borders
+  u8* locked = ArenaPush(scratch.arena, u8, vertex_count);
+  {
+    u32 capacity = 1;
+    while (capacity < Max(vertex_count, count*3)*2) {
+      capacity *= 2;
+    }
+    u32  mask  = capacity - 1;
+    u32* slots = ArenaPush(scratch.arena, u32, capacity);
+    for (u32 i = 0; i < vertex_count; i += 1) {
+      u32* bits = (u32*)&positions[i];
+      u32 slot = (u32)_renderer_hash_cell(bits[0], bits[1], bits[2]) & mask;
+      for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (MemoryMatch(&positions[slots[slot] - 1], &positions[i], sizeof(Vector3))) {
+          locked[slots[slot] - 1] = 1;
+          locked[i] = 1;
+          break;
+        }
+      }
+      if (slots[slot] == 0) {
+        slots[slot] = i + 1;
+      }
+    }
+    
+    // NOTE(fz): An edge is a border when no triangle walks it the other way round.
+    MemoryZero(slots, sizeof(u32)*capacity);
+    u32* edges = out;
+    for (u32 i = 0; i < count*3; i += 1) {
+      u32 a = edges[i], b = edges[i - i%3 + (i + 1)%3];
+      u32 slot = (u32)_renderer_hash_cell(a, b, 0) & mask;
+      while (slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = i + 1;
+    }
+    for (u32 i = 0; i < count*3; i += 1) {
+      u32 a = edges[i], b = edges[i - i%3 + (i + 1)%3];
+      b32 found = 0;
+      for (u32 slot = (u32)_renderer_hash_cell(b, a, 0) & mask; slots[slot] != 0 && !found; slot = (slot + 1) & mask) {
+        u32 j = slots[slot] - 1;
+        found = edges[j] == b && edges[j - j%3 + (j + 1)%3] == a;
+      }
+      if (!found) {
+        locked[a] = 1;
+        locked[b] = 1;
+      }
+    }
+  }
+  
+  Mesh_Quadric* quadrics = ArenaPush(scratch.arena, Mesh_Quadric, vertex_count);
+  for (u32 t = 0; t < count; t += 1) {
+    u32* tri = out + t*3;
+    Vector3 n = _mesh_triangle_normal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+    f32 area = vector3_length(n);
+    if (area == 0.0f) {
+      continue;
+    }
+    n = vector3_scale(n, 1.0f / area);
+    f32 d = -vector3_dot(n, positions[tri[0]]);
+    for (u32 j = 0; j < 3; j += 1) {
+      _mesh_quadric_add_plane(&quadrics[tri[j]], n, d, area);
+    }
+  }
+  
+  u32* remap     = ArenaPushNoZero(scratch.arena, u32, vertex_count);
+  u8*  touched   = ArenaPushNoZero(scratch.arena, u8, vertex_count);
+  u32* live      = ArenaPushNoZero(scratch.arena, u32, vertex_count);
+  u32* offsets   = ArenaPushNoZero(scratch.arena, u32, vertex_count + 1);
+  u32* adjacency = ArenaPushNoZero(scratch.arena, u32, count*3);
+  u32* candidates      = ArenaPushNoZero(scratch.arena, u32, count*12); // src, dst pairs, both ways of every corner's edge
+  f32* candidate_costs = ArenaPushNoZero(scratch.arena, f32, count*6);
+  u32* order           = ArenaPushNoZero(scratch.arena, u32, count*6);
+  u32* order_temp      = ArenaPushNoZero(scratch.arena, u32, count*6);
+  f32  max_cost        = 0.0f;
+  
+  // NOTE(fz): Passes of independent collapses, cheapest first. A collapse freezes the one ring of its source
+  // for the rest of the pass, so the flip tests below never see stale neighbours.
+  while (count > target_triangle_count) {
+    MemoryZero(live, sizeof(u32)*vertex_count);
+    for (u32 i = 0; i < count*3; i += 1) {
+      live[out[i]] += 1;
+    }
+    offsets[0] = 0;
+    for (u32 i = 0; i < vertex_count; i += 1) {
+      offsets[i + 1] = offsets[i] + live[i];
+      live[i] = offsets[i];
+    }
+    for (u32 i = 0; i < count*3; i += 1) {
+      adjacency[live[out[i]]++] = i / 3;
+    }
+    
+    u32 candidate_count = 0;
+    for (u32 i = 0; i < count*3; i += 1) {
+      u32 a = out[i], b = out[i - i%3 + (i + 1)%3];
+      for (u32 k = 0; k < 2; k += 1) {
+        u32 src = k ? b : a;
+        u32 dst = k ? a : b;
+        if (locked[src]) {
+          continue;
+        }
+        // NOTE(fz): The planes are area weighted, dividing by the total weight turns the error into a mean squared distance.
+        Mesh_Quadric q = quadrics[src];
+        _mesh_quadric_add(&q, &quadrics[dst]);
+        f32 weight = Max(q.a00 + q.a11 + q.a22, 1e-20f);
+        candidates[candidate_count*2 + 0] = src;
+        candidates[candidate_count*2 + 1] = dst;
+        candidate_costs[candidate_count]  = -_mesh_quadric_error(&q, positions[dst]) / weight; // Negated, the sort is descending
+        order[candidate_count] = candidate_count;
+        candidate_count += 1;
+      }
+    }
+    if (candidate_count == 0) {
+      break;
+    }
+    _renderer_sort_descending(order, candidate_costs, candidate_count, order_temp);
+    
+    for (u32 i = 0; i < vertex_count; i += 1) {
+      remap[i] = i;
+    }
+    MemoryZero(touched, vertex_count);
+    u32 budget    = (count - target_triangle_count)/2 + 1; // A collapse removes about two triangles
+    u32 collapses = 0;
+    for (u32 i = 0; i < candidate_count && collapses < budget; i += 1) {
+      u32 src = candidates[order[i]*2 + 0];
+      u32 dst = candidates[order[i]*2 + 1];
+      if (touched[src] || touched[dst]) {
+        continue;
+      }
+      
+      b32 flips = 0;
+      for (u32 k = offsets[src]; k < offsets[src + 1] && !flips; k += 1) {
+        u32* tri = out + adjacency[k]*3;
+        if (tri[0] == dst || tri[1] == dst || tri[2] == dst) {
+          continue;
+        }
+        Vector3 p[3], q[3];
+        for (u32 j = 0; j < 3; j += 1) {
+          p[j] = positions[tri[j]];
+          q[j] = tri[j] == src ? positions[dst] : p[j];
+        }
+        Vector3 before = _mesh_triangle_normal(p[0], p[1], p[2]);
+        Vector3 after  = _mesh_triangle_normal(q[0], q[1], q[2]);
+        flips = vector3_dot(before, after) <= 0.0f;
+      }
+      if (flips) {
+        continue;
+      }
+      
+      remap[src] = dst;
+      _mesh_quadric_add(&quadrics[dst], &quadrics[src]);
+      max_cost = Max(max_cost, -candidate_costs[order[i]]);
+      for (u32 k = offsets[src]; k < offsets[src + 1]; k += 1) {
+        u32* tri = out + adjacency[k]*3;
+        touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+      }
+      touched[dst] = 1;
+      collapses += 1;
+    }
+    if (collapses == 0) {
+      break;
+    }
+    
+    u32 kept = 0;
+    for (u32 t = 0; t < count; t += 1) {
+      u32 a = remap[out[t*3 + 0]], b = remap[out[t*3 + 1]], c = remap[out[t*3 + 2]];
+      if (a != b && b != c && a != c) {
+        out[kept*3 + 0] = a;
+        out[kept*3 + 1] = b;
+        out[kept*3 + 2] = c;
+        kept += 1;
+      }
+    }
+    count = kept;
+  }
+  
+  *error = sqrtf(max_cost) * extent;
+  scratch_end(&scratch);
+  return count;
+}
+
+internal void renderer_generate_model_lods(Model* model) {
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh = &model->meshes_data[i];
+    mesh->lod_count = 0;
+    Arena_Temp scratch = scratch_begin(0, 0);
+    u32* indices = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count*3);
+    
+    // NOTE(fz): Each level is simplified from the one before it, so the import does one full size pass and then
+    // ever smaller ones. The errors add up, which bounds each level's distance to the full mesh.
+    Mesh source = *mesh;
+    f32  total_error = 0.0f;
+    while (mesh->lod_count < Max_Mesh_Lods && source.triangle_count/2 >= Lod_Min_Triangles) {
+      f32 error = 0.0f;
+      u32 count = mesh_simplify(&source, (u32)(source.triangle_count*Lod_Reduction), indices, &error);
+      if (count > source.triangle_count*Lod_Min_Reduction) {
+        break; // Mostly locked, coarser levels wouldn't be any smaller
+      }
+      
+      // Each level gets the same cache and overdraw pass as the full mesh, the vertex order stays the full mesh's
+      Mesh level = *mesh;
+      level.indices        = indices;
+      level.triangle_count = count;
+      mesh_optimize_vertex_cache(&level, Mesh_Cache_Size, Mesh_Overdraw_Threshold);
+      
+      total_error += error;
+      Mesh_Lod* lod = &mesh->lods[mesh->lod_count];
+      lod->indices        = ArenaPushNoZero(model->arena, u32, count*3);
+      lod->triangle_count = count;
+      lod->error          = total_error;
+      MemoryCopy(lod->indices, indices, sizeof(u32)*3*count);
+      mesh->lod_count += 1;
+      
+      source.indices        = lod->indices;
+      source.triangle_count = count;
+    }
+    scratch_end(&scratch);
+  }
+}
+
+// Triangle centroids split at the mean of the axis they spread the most along
+typedef struct Mesh_Kd_Node {
+  f32 split;
+  u32 axis; // 3 for a leaf
+  u32 first; // Leaf: into the items, inner: the right child, the left one is the next node
+  u32 count; // Leaf items
+} Mesh_Kd_Node;
+
+internal u32 _mesh_kd_build(Mesh_Kd_Node* nodes, u32* node_count, u32* items, u32 first, u32 count, Vector3* centroids) {
+  u32 index = (*node_count)++;
+  Mesh_Kd_Node* node = &nodes[index];
+  node->axis  = 3;
+  node->first = first;
+  node->count = count;
+  if (count <= Meshlet_Kd_Leaf_Size) {
+    return index;
+  }
+  
+  Vector3 mean = vector3(0.0f, 0.0f, 0.0f);
+  for (u32 i = first; i < first + count; i += 1) {
+    mean = vector3_add(mean, centroids[items[i]]);
+  }
+  mean = vector3_scale(mean, 1.0f / (f32)count);
+  Vector3 variance = vector3(0.0f, 0.0f, 0.0f);
+  for (u32 i = first; i < first + count; i += 1) {
+    Vector3 d = sub(centroids[items[i]], mean);
+    variance = vector3_add(variance, vector3(d.x*d.x, d.y*d.y, d.z*d.z));
+  }
+  u32 axis = variance.x >= variance.y ? (variance.x >= variance.z ? 0 : 2) : (variance.y >= variance.z ? 1 : 2);
+  
+  u32 middle = first;
+  for (u32 i = first; i < first + count; i += 1) {
+    if (centroids[items[i]].data[axis] < mean.data[axis]) {
+      u32 item      = items[i];
+      items[i]      = items[middle];
+      items[middle] = item;
+      middle += 1;
+    }
+  }
+  if (middle == first || middle == first + count) {
+    return index; // Every centroid on the mean, stays a leaf
+  }
+  
+  node->axis  = axis;
+  node->split = mean.data[axis];
+  _mesh_kd_build(nodes, node_count, items, first, middle - first, centroids);
+  node->first = _mesh_kd_build(nodes, node_count, items, middle, first + count - middle, centroids);
+  return index;
+}
+
+/* Nearest triangle to point that isn't emitted yet, best stays U32_MAX when there's none */
+internal void _mesh_kd_nearest(Mesh_Kd_Node* nodes, u32 index, u32* items, Vector3* centroids, b8* emitted, Vector3 point, u32* best, f32* best_distance) {
+  Mesh_Kd_Node* node = &nodes[index];
+  if (node->axis == 3) {
+    for (u32 i = node->first; i < node->first + node->count; i += 1) {
+      if (emitted[items[i]]) {
+        continue;
+      }
+      Vector3 d = sub(centroids[items[i]], point);
+      f32 distance = vector3_dot(d, d);
+      if (distance < *best_distance) {
+        *best          = items[i];
+        *best_distance = distance;
+      }
+    }
+    return;
+  }
+  
+  f32 delta = point.data[node->axis] - node->split;
+  u32 near  = delta < 0.0f ? index + 1 : node->first;
+  u32 far   = delta < 0.0f ? node->first : index + 1;
+  _mesh_kd_nearest(nodes, near, items, centroids, emitted, point, best, best_distance);
+  if (delta*delta < *best_distance) {
+    _mesh_kd_nearest(nodes, far, items, centroids, emitted, point, best, best_distance);
+  }
+}
+
+/* Greedy clusters in the spirit of meshoptimizer's meshlet builder: seeded in the current triangle order, then grown
+ * through shared vertices preferring the triangles that add the fewest new ones, nearest the seed on ties.
+ * Once no neighbour is left the nearest remaining triangle by centroid carries on, until a limit is reached.
+ * The triangles are rewritten in meshlet order so every meshlet is a contiguous range of the index buffer. */
+internal void mesh_build_meshlets(Mesh* mesh, Arena* arena) {
+  Arena_Temp scratch = scratch_begin(&arena, 1);
+  
+  // Vertex to triangle adjacency
+  u32* offsets = ArenaPush(scratch.arena, u32, mesh->vertex_count + 1);
+  u32* adjacency = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count*3);
+  for (u32 i = 0; i < mesh->triangle_count*3; i += 1) {
+    offsets[mesh->indices[i] + 1] += 1;
+  }
+  for (u32 i = 0; i < mesh->vertex_count; i += 1) {
+    offsets[i + 1] += offsets[i];
+  }
+  u32* fill = ArenaPushNoZero(scratch.arena, u32, mesh->vertex_count);
+  MemoryCopy(fill, offsets, sizeof(u32)*mesh->vertex_count);
+  for (u32 i = 0; i < mesh->triangle_count*3; i += 1) {
+    adjacency[fill[mesh->indices[i]]++] = i/3;
+  }
+  
+  Vector3* centroids = ArenaPushNoZero(scratch.arena, Vector3, mesh->triangle_count);
+  u32*     items     = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count);
+  for (u32 i = 0; i < mesh->triangle_count; i += 1) {
+    u32* c = mesh->indices + i*3;
+    centroids[i] = vector3_scale(vector3_add(vector3_add(mesh->vertices[c[0]], mesh->vertices[c[1]]), mesh->vertices[c[2]]), 1.0f/3.0f);
+    items[i]     = i;
+  }
+  Mesh_Kd_Node* nodes = ArenaPushNoZero(scratch.arena, Mesh_Kd_Node, mesh->triangle_count*2 + 1);
+  u32 node_count = 0;
+  _mesh_kd_build(nodes, &node_count, items, 0, mesh->triangle_count, centroids);
+  
+  u32* stamp      = ArenaPush(scratch.arena, u32, mesh->vertex_count); // Meshlet index + 1 that holds the vertex
+  b8*  emitted    = ArenaPush(scratch.arena, b8, mesh->triangle_count);
+  u32* order      = ArenaPushNoZero(scratch.arena, u32, mesh->triangle_count*3);
+  u32* local      = ArenaPushNoZero(scratch.arena, u32, mesh->vertex_count); // Position in vertices while it holds the vertex
+  u32* vertices   = ArenaPushNoZero(scratch.arena, u32, Meshlet_Max_Vertices);
+  u32* tipsified  = ArenaPushNoZero(scratch.arena, u32, Meshlet_Max_Triangles*3);
+  u32* boundaries = ArenaPushNoZero(scratch.arena, u32, Meshlet_Max_Triangles);
+  Meshlet* meshlets = ArenaPushNoZero(scratch.arena, Meshlet, mesh->triangle_count);
+  u32 count  = 0;
+  u32 seed   = 0;
+  u32 cursor = 0;
+  while (cursor < mesh->triangle_count) {
+    while (emitted[seed]) {
+      seed += 1;
+    }
+    Meshlet* meshlet = &meshlets[count++];
+    MemoryZeroStruct(meshlet);
+    meshlet->first_triangle = cursor;
+    u32 vertex_count = 0;
+    Vector3 origin = centroids[seed];
+    Vector3 centroid_sum = vector3(0.0f, 0.0f, 0.0f);
+    
+    for (u32 next = seed; next != U32_MAX;) {
+      u32* tri = mesh->indices + next*3;
+      for (u32 j = 0; j < 3; j += 1) {
+        if (stamp[tri[j]] != count) {
+          stamp[tri[j]] = count;
+          local[tri[j]] = vertex_count;
+          vertices[vertex_count++] = tri[j];
+        }
+        order[cursor*3 + j] = local[tri[j]];
+      }
+      emitted[next] = true;
+      centroid_sum  = vector3_add(centroid_sum, centroids[next]);
+      cursor += 1;
+      meshlet->triangle_count += 1;
+      if (meshlet->triangle_count == Meshlet_Max_Triangles) {
+        break;
+      }
+      
+      next = U32_MAX;
+      u32 best_added = 3;
+      f32 best_distance = F32_MAX;
+      for (u32 v = 0; v < vertex_count; v += 1) {
+        for (u32 k = offsets[vertices[v]]; k < offsets[vertices[v] + 1]; k += 1) {
+          u32 candidate = adjacency[k];
+          if (emitted[candidate]) {
+            continue;
+          }
+          u32* c = mesh->indices + candidate*3;
+          u32 added = (stamp[c[0]] != count) + (stamp[c[1]] != count) + (stamp[c[2]] != count);
+          if (vertex_count + added > Meshlet_Max_Vertices || added > best_added) {
+            continue;
+          }
+          Vector3 d = sub(centroids[candidate], origin);
+          f32 distance = vector3_dot(d, d);
+          if (added < best_added || distance < best_distance) {
+            next          = candidate;
+            best_added    = added;
+            best_distance = distance;
+          }
+        }
+      }
+      
+      // NOTE(fz): Disconnected pieces would otherwise each start a meshlet of their own.
+      if (next == U32_MAX) {
+        best_distance = F32_MAX;
+        _mesh_kd_nearest(nodes, 0, items, centroids, emitted, vector3_scale(centroid_sum, 1.0f / (f32)meshlet->triangle_count), &next, &best_distance);
+        if (next != U32_MAX) {
+          u32* c = mesh->indices + next*3;
+          u32 added = (stamp[c[0]] != count) + (stamp[c[1]] != count) + (stamp[c[2]] != count);
+          if (vertex_count + added > Meshlet_Max_Vertices) {
+            next = U32_MAX;
+          }
+        }
+      }
+    }
+    
+    // NOTE(fz): The growth order is local but not cache friendly, Tipsify it again on the meshlet's own vertices.
+    u32* meshlet_indices = order + meshlet->first_triangle*3;
+    _mesh_tipsify(meshlet_indices, meshlet->triangle_count, vertex_count, Mesh_Cache_Size, tipsified, boundaries);
+    for (u32 j = 0; j < meshlet->triangle_count*3; j += 1) {
+      meshlet_indices[j] = vertices[tipsified[j]];
+    }
+  }
+  MemoryCopy(mesh->indices, order, sizeof(u32)*mesh->triangle_count*3);
+  
+  for (u32 i = 0; i < count; i += 1) {
+    Meshlet* meshlet = &meshlets[i];
+    u32* indices = mesh->indices + meshlet->first_triangle*3;
+    u32  corners = meshlet->triangle_count*3;
+    
+    Vector3 min = mesh->vertices[indices[0]];
+    Vector3 max = min;
+    for (u32 j = 1; j < corners; j += 1) {
+      Vector3 p = mesh->vertices[indices[j]];
+      min = vector3(Min(min.x, p.x), Min(min.y, p.y), Min(min.z, p.z));
+      max = vector3(Max(max.x, p.x), Max(max.y, p.y), Max(max.z, p.z));
+    }
+    meshlet->center = vector3_scale(vector3_add(min, max), 0.5f);
+    for (u32 j = 0; j < corners; j += 1) {
+      meshlet->radius = Max(meshlet->radius, vector3_length(sub(mesh->vertices[indices[j]], meshlet->center)));
+    }
+    
+    // Normal cone, the axis is the mean unit normal and the half angle reaches the furthest one
+    Vector3 normal = vector3(0.0f, 0.0f, 0.0f);
+    for (u32 j = 0; j < corners; j += 3) {
+      Vector3 n = _mesh_triangle_normal(mesh->vertices[indices[j]], mesh->vertices[indices[j + 1]], mesh->vertices[indices[j + 2]]);
+      f32 length = vector3_length(n);
+      if (length > 0.0f) {
+        normal = vector3_add(normal, vector3_scale(n, 1.0f / length));
+      }
+    }
+    f32 axis_length = vector3_length(normal);
+    meshlet->cone_cutoff = 1.0f;
+    if (axis_length > 0.0f) {
+      meshlet->cone_axis = vector3_scale(normal, 1.0f / axis_length);
+      f32 min_dot = 1.0f;
+      for (u32 j = 0; j < corners; j += 3) {
+        Vector3 n = _mesh_triangle_normal(mesh->vertices[indices[j]], mesh->vertices[indices[j + 1]], mesh->vertices[indices[j + 2]]);
+        f32 length = vector3_length(n);
+        if (length > 0.0f) {
+          min_dot = Min(min_dot, vector3_dot(n, meshlet->cone_axis) / length);
+        }
+      }
+      if (min_dot > 0.0f) {
+        meshlet->cone_cutoff = sqrtf(1.0f - min_dot*min_dot);
+      }
+    }
+  }
+  
+  mesh->meshlet_count = count;
+  mesh->meshlets      = ArenaPushNoZero(arena, Meshlet, count);
+  MemoryCopy(mesh->meshlets, meshlets, sizeof(Meshlet)*count);
+  scratch_end(&scratch);
+}
+
+internal void renderer_optimize_model(Model* model, String name) {
+  Mesh_Cache_Stats before = { 0 };
+  Mesh_Cache_Stats after  = { 0 };
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh = &model->meshes_data[i];
+    Mesh_Cache_Stats stats = mesh_analyze_vertex_cache(mesh, Mesh_Cache_Size);
+    before.misses    += stats.misses;
+    before.triangles += stats.triangles;
+    before.vertices  += stats.vertices;
+    
+    mesh_optimize_vertex_cache(mesh, Mesh_Cache_Size, Mesh_Overdraw_Threshold);
+    mesh_optimize_vertex_fetch(mesh);
+    
+    // NOTE(fz): Meshlets rewrite the triangle order again, the after figures are for the order that gets uploaded.
+    mesh_build_meshlets(mesh, model->arena);
+    stats = mesh_analyze_vertex_cache(mesh, Mesh_Cache_Size);
+    after.misses    += stats.misses;
+    after.triangles += stats.triangles;
+    after.vertices  += stats.vertices;
+  }
+  
+  if (before.triangles > 0) {
+    printf("%.*s: %u triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (FIFO %u)\n", (s32)name.size, name.str, before.triangles,
+           (f32)before.misses / (f32)before.triangles, (f32)after.misses / (f32)after.triangles,
+           (f32)before.misses / (f32)before.vertices,  (f32)after.misses / (f32)after.vertices, Mesh_Cache_Size);
+  }
+}
+
+/* path + Mesh_Cache_Extension, null terminated for the OS layer */
+internal String _renderer_mesh_cache_path(Arena* arena, String path) {
+  String extension = StringLiteral(Mesh_Cache_Extension);
+  String result = { 0 };
+  result.size = path.size + extension.size;
+  result.str  = ArenaPush(arena, u8, result.size + 1);
+  MemoryCopy(result.str, path.str, path.size);
+  MemoryCopy(result.str + path.size, extension.str, extension.size);
+  return result;
+}
+
+internal Model renderer_load_obj(String path) {
+  Model result = { 0 };
+  
+  Arena_Temp scratch = scratch_begin(0, 0);
+  String cache_path = _renderer_mesh_cache_path(scratch.arena, path);
+  u64    source_hash = _renderer_hash_cell(os_file_size(path), os_file_get_last_modified_time(path), Mesh_Cache_Version);
+  result.arena     = arena_init();
+  result.transform = matrix4(1.0f);
+  if (renderer_load_mesh_cache(&result, cache_path, source_hash)) {
+    scratch_end(&scratch);
+    return result;
+  }
+  
+  OS_File file = os_file_map(path);
+  if (file.size == 0) {
+    printf("Error loading file %s.", path.str);
+    Assert(0);
+    scratch_end(&scratch);
+    return result;
+  }
+  
+  Obj_Data obj = _obj_parse(file.data, file.size, path);
+  os_file_unmap(&file);
+  if (obj.arena == NULL) {
+    scratch_end(&scratch);
+    return result;
+  }
+  
+  if (obj.material_count == 0) {
+    printf("No materials provided, setting one default material for all meshes.\n");
+  }
+  
+  _renderer_import_obj(&result, &obj);
+  renderer_optimize_model(&result, path);
+  renderer_generate_model_lods(&result);
+  renderer_compute_model_bounds(&result);
+  renderer_upload_model(&result);
+  renderer_write_mesh_cache(&result, cache_path, source_hash);
+  
+  // NOTE(fz): Everything the parser made is copied into the model by now.
+  tinyobj_materials_free(obj.materials, obj.material_count);
+  arena_free(obj.arena);
+
+  scratch_end(&scratch);
+  return result;
+}
+
+internal void renderer_compute_model_bounds(Model* model) {
+  model->bounds = aabb_from_points(NULL, 0);
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh    = &model->meshes_data[i];
+    mesh->bounds  = aabb_from_points(mesh->vertices, mesh->vertex_count);
+    model->bounds = aabb_union(model->bounds, mesh->bounds);
+  }
+}
+
+internal u32 renderer_cull_models(Frustum* frustum, Model* models, u32 model_count, u32* visible) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  f32* centers_data = ArenaPushNoZero(scratch.arena, f32, model_count*6);
+  Vector3_SoA centers = { centers_data, centers_data + model_count,   centers_data + model_count*2 };
+  Vector3_SoA extents = { centers_data + model_count*3, centers_data + model_count*4, centers_data + model_count*5 };
+  
+  for (u32 i = 0; i < model_count; i += 1) {
+    AABB world = aabb_transform(models[i].bounds, models[i].transform);
+    Vector3 center = vector3_scale(vector3_add(world.min, world.max), 0.5f);
+    Vector3 extent = vector3_scale(sub(world.max, world.min), 0.5f);
+    if (aabb_is_empty(world)) {
+      // NOTE(fz): Nothing to draw, a hugely negative extent fails every plane.
+      center = vector3(0.0f, 0.0f, 0.0f);
+      extent = vector3(-F32_MAX, -F32_MAX, -F32_MAX);
+    }
+    centers.x[i] = center.x; centers.y[i] = center.y; centers.z[i] = center.z;
+    extents.x[i] = extent.x; extents.y[i] = extent.y; extents.z[i] = extent.z;
+  }
+  
+  u32 result = (u32)frustum_cull_aabbs(frustum, centers, extents, model_count, visible);
+  scratch_end(&scratch);
+  return result;
+}
+
+internal Ray_Hit renderer_intersect_ray_with_model(Model* model, Ray ray, u32* mesh_index) {
+  Ray_Hit result = { 0 };
+  result.t = F32_MAX;
+  
+  // NOTE(fz): Intersect in model space. The direction is not renormalized, so t stays a world space distance along the ray.
+  Matrix4 inverse = matrix4_inverse_affine(model->transform);
+  Ray local = { 0 };
+  local.point     = mul_vector3_matrix4(ray.point, inverse);
+  local.direction = vector3_from_vector4(mul_vector4_matrix4(vector4(ray.direction.x, ray.direction.y, ray.direction.z, 0.0f), inverse));
+  
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh  = &model->meshes_data[i];
+    Ray_Hit hit = intersect_ray_with_triangle_list(local, mesh->vertices, mesh->indices, mesh->triangle_count);
+    if (hit.hit && hit.t < result.t) {
+      result      = hit;
+      *mesh_index = i;
+    }
+  }
+  return result;
+}
+
+internal void _vertices_pack4(Vertex* v, Vertex_Packed* out) {
+  // Octahedral normals: project on the |x|+|y|+|z| = 1 octahedron, fold the lower half over the upper one.
+  f32x4 x  = f32x4_set(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x);
+  f32x4 y  = f32x4_set(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y);
+  f32x4 z  = f32x4_set(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z);
+  f32x4 l1 = f32x4_max(f32x4_add(f32x4_add(f32x4_abs(x), f32x4_abs(y)), f32x4_abs(z)), f32x4_splat(1e-20f));
+  f32x4 px = f32x4_div(x, l1);
+  f32x4 py = f32x4_div(y, l1);
+  f32x4 one    = f32x4_splat(1.0f);
+  f32x4 sign_x = f32x4_select(f32x4_cmp_ge(px, f32x4_zero()), one, f32x4_splat(-1.0f));
+  f32x4 sign_y = f32x4_select(f32x4_cmp_ge(py, f32x4_zero()), one, f32x4_splat(-1.0f));
+  f32x4 lower  = f32x4_cmp_lt(z, f32x4_zero());
+  f32x4 ox = f32x4_select(lower, f32x4_mul(f32x4_sub(one, f32x4_abs(py)), sign_x), px);
+  f32x4 oy = f32x4_select(lower, f32x4_mul(f32x4_sub(one, f32x4_abs(px)), sign_y), py);
+  u32 normal_x = f32x4_pack_snorm8(ox);
+  u32 normal_y = f32x4_pack_snorm8(oy);
+  
+  u16 uv[8];
+  f32x4_store_f16(uv,     f32x4_set(v[0].uv.x, v[0].uv.y, v[1].uv.x, v[1].uv.y));
+  f32x4_store_f16(uv + 4, f32x4_set(v[2].uv.x, v[2].uv.y, v[3].uv.x, v[3].uv.y));
+  
+  for (u32 i = 0; i < 4; i += 1) {
+    out[i].position  = v[i].position;
+    out[i].color     = f32x4_pack_unorm8(f32x4_load(v[i].color.data));
+    out[i].uv[0]     = uv[i*2 + 0];
+    out[i].uv[1]     = uv[i*2 + 1];
+    out[i].normal[0] = (s8)(normal_x >> (i*8));
+    out[i].normal[1] = (s8)(normal_y >> (i*8));
+    out[i].texture   = (u16)(v[i].texture + 0.5f);
+  }
+}
+
+internal void vertices_pack(Vertex* vertices, Vertex_Packed* packed, u64 count) {
+  u64 i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _vertices_pack4(vertices + i, packed + i);
+  }
+  if (i < count) {
+    Vertex        tail[4] = { 0 };
+    Vertex_Packed tail_packed[4];
+    MemoryCopy(tail, vertices + i, (count - i) * sizeof(Vertex));
+    _vertices_pack4(tail, tail_packed);
+    MemoryCopy(packed + i, tail_packed, (count - i) * sizeof(Vertex_Packed));
+  }
+}
+
+internal u64 _renderer_hash_vertex(Vertex_Packed* vertex) {
+  // NOTE(fz): FNV-1a over 32 bit words, then a final avalanche so the low bits used for the slot are mixed.
+  u32* words = (u32*)vertex;
+  u64 result = 14695981039346656037ull;
+  for (u32 i = 0; i < sizeof(Vertex_Packed)/sizeof(u32); i += 1) {
+    result ^= words[i];
+    result *= 1099511628211ull;
+  }
+  result ^= result >> 33;
+  result *= 0xff51afd7ed558ccdull;
+  result ^= result >> 33;
+  return result;
+}
+
+/* Index of an identical vertex if there is one, otherwise appends it */
+internal u32 _renderer_find_or_push_vertex(Vertex_Packed* vertex) {
+  u32 mask = GRenderer.vertices_hash_capacity - 1;
+  u32 slot = (u32)_renderer_hash_vertex(vertex) & mask;
+  for (;;) {
+    u32 entry = GRenderer.vertices_hash_slots[slot];
+    if (entry == 0) {
+      break;
+    }
+    if (MemoryMatch(&GRenderer.vertices_data[entry - 1], vertex, sizeof(Vertex_Packed))) {
+      return entry - 1;
+    }
+    slot = (slot + 1) & mask;
+  }
+  
+  if (GRenderer.vertices_count + 1 > GRenderer.vertices_capacity) {
+    printf("Too many vertices");
+    Assert(0);
+  }
+  u32 result = GRenderer.vertices_count;
+  GRenderer.vertices_data[result]      = *vertex;
+  GRenderer.vertices_hash_slots[slot]  = result + 1;
+  GRenderer.vertices_count            += 1;
+  _renderer_mark_dirty(&GRenderer.vertices_dirty, result, 1);
+  return result;
+}
+
+internal void renderer_push_triangle(Vertex a, Vertex b, Vertex c) {
+  if (GRenderer.triangles_indices_count + 3 > GRenderer.triangles_indices_capacity) {
+    printf("Too many triangles indices");
+    Assert(0);
+  }
+  
+  Vertex        vertices[3] = { a, b, c };
+  Vertex_Packed packed[3];
+  vertices_pack(vertices, packed, 3);
+  
+  u32* indices = GRenderer.triangles_indices_data + GRenderer.triangles_indices_count;
+  indices[0] = _renderer_find_or_push_vertex(&packed[0]);
+  indices[1] = _renderer_find_or_push_vertex(&packed[1]);
+  indices[2] = _renderer_find_or_push_vertex(&packed[2]);
+  _renderer_mark_dirty(&GRenderer.triangles_indices_dirty, GRenderer.triangles_indices_count, 3);
+  GRenderer.triangles_indices_count += 3;
+}
+
+internal void renderer_push_triangles(Vertex* vertices, u32 vertex_count) {
+  Assert(vertex_count % 3 == 0);
+  if (GRenderer.triangles_indices_count + vertex_count > GRenderer.triangles_indices_capacity) {
+    printf("Too many triangles indices");
+    Assert(0);
+  }
+  
+  Arena_Temp scratch = scratch_begin(0, 0);
+  Vertex_Packed* packed = ArenaPushNoZero(scratch.arena, Vertex_Packed, vertex_count);
+  vertices_pack(vertices, packed, vertex_count);
+  
+  u32* indices = GRenderer.triangles_indices_data + GRenderer.triangles_indices_count;
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    indices[i] = _renderer_find_or_push_vertex(&packed[i]);
+  }
+  _renderer_mark_dirty(&GRenderer.triangles_indices_dirty, GRenderer.triangles_indices_count, vertex_count);
+  GRenderer.triangles_indices_count += vertex_count;
+  scratch_end(&scratch);
+}
+
+internal void renderer_push_line(Vector3 a_position, Vector3 b_position, u32 texture) {
+  if (GRenderer.lines_indices_count + 2 > GRenderer.lines_indices_capacity) {
+    printf("Too many lines indices");
+    Assert(0);
+  }
+
+  Vertex vertices[2] = {
+    vertex(a_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture),
+    vertex(b_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture),
+  };
+  Vertex_Packed packed[2];
+  vertices_pack(vertices, packed, 2);
+  
+  u32* indices = GRenderer.lines_indices_data + GRenderer.lines_indices_count;
+  indices[0] = _renderer_find_or_push_vertex(&packed[0]);
+  indices[1] = _renderer_find_or_push_vertex(&packed[1]);
+  _renderer_mark_dirty(&GRenderer.lines_indices_dirty, GRenderer.lines_indices_count, 2);
+  GRenderer.lines_indices_count += 2;
+}
+
+internal Renderer_Mesh renderer_upload_mesh(Vertex* vertices, u32 vertex_count) {
+  Assert(vertex_count % 3 == 0);
+  if (GRenderer.meshes_indices_count + vertex_count > GRenderer.meshes_indices_capacity) {
+    printf("Too many mesh indices");
+    Assert(0);
+  }
+  
+  Renderer_Mesh result = { 0 };
+  result.first_index = GRenderer.meshes_indices_count;
+  result.index_count = vertex_count;
+  
+  Arena_Temp scratch = scratch_begin(0, 0);
+  Vertex_Packed* packed = ArenaPushNoZero(scratch.arena, Vertex_Packed, vertex_count);
+  vertices_pack(vertices, packed, vertex_count);
+  
+  u32* indices = GRenderer.meshes_indices_data + GRenderer.meshes_indices_count;
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    indices[i] = _renderer_find_or_push_vertex(&packed[i]);
+  }
+  _renderer_mark_dirty(&GRenderer.meshes_indices_dirty, GRenderer.meshes_indices_count, vertex_count);
+  GRenderer.meshes_indices_count += vertex_count;
+  scratch_end(&scratch);
+  return result;
+}
+
+/* Packs and dedups vertices into the vertex buffer, remap[i] is where vertices[i] ended up */
+internal void _renderer_push_vertices(Vertex* vertices, u32 vertex_count, u32* remap) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  Vertex_Packed* packed = ArenaPushNoZero(scratch.arena, Vertex_Packed, vertex_count);
+  vertices_pack(vertices, packed, vertex_count);
+  for (u32 i = 0; i < vertex_count; i += 1) {
+    remap[i] = _renderer_find_or_push_vertex(&packed[i]);
+  }
+  scratch_end(&scratch);
+}
+
+/* Appends indices to meshes_indices_data, through remap when given, else offset by base */
+internal Renderer_Mesh _renderer_push_mesh_indices(u32* indices, u32 index_count, u32* remap, u32 base) {
+  Assert(index_count % 3 == 0);
+  Renderer_Mesh result = { 0 };
+  if (GRenderer.meshes_indices_count + index_count > GRenderer.meshes_indices_capacity) {
+    printf("Too many mesh indices");
+    Assert(0);
+    return result;
+  }
+  
+  result.first_index = GRenderer.meshes_indices_count;
+  result.index_count = index_count;
+  u32* out = GRenderer.meshes_indices_data + GRenderer.meshes_indices_count;
+  for (u32 i = 0; i < index_count; i += 1) {
+    out[i] = remap ? remap[indices[i]] : base + indices[i];
+  }
+  _renderer_mark_dirty(&GRenderer.meshes_indices_dirty, GRenderer.meshes_indices_count, index_count);
+  GRenderer.meshes_indices_count += index_count;
+  return result;
+}
+
+internal Renderer_Mesh renderer_upload_mesh_indexed(Vertex* vertices, u32 vertex_count, u32* indices, u32 index_count) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  u32* remap = ArenaPushNoZero(scratch.arena, u32, vertex_count);
+  _renderer_push_vertices(vertices, vertex_count, remap);
+  Renderer_Mesh result = _renderer_push_mesh_indices(indices, index_count, remap, 0);
+  scratch_end(&scratch);
+  return result;
+}
+
+internal Renderer_Mesh renderer_upload_mesh_packed(Vertex_Packed* vertices, u32 vertex_count, u32* indices, u32 index_count) {
+  if (GRenderer.vertices_count + vertex_count > GRenderer.vertices_capacity) {
+    printf("Too many vertices");
+    Assert(0);
+  }
+  
+  // NOTE(fz): The vertices are already unique, so they go in as one block and stay out of the dedup table.
+  u32 base = GRenderer.vertices_count;
+  MemoryCopy(GRenderer.vertices_data + base, vertices, sizeof(Vertex_Packed)*vertex_count);
+  _renderer_mark_dirty(&GRenderer.vertices_dirty, base, vertex_count);
+  GRenderer.vertices_count += vertex_count;
+  return _renderer_push_mesh_indices(indices, index_count, NULL, base);
+}
+
+internal void renderer_push_draw(Renderer_Mesh mesh, Matrix4 transform, Vector4 color) {
+  _renderer_begin_draw_list();
+  
+  // NOTE(fz): Both streams are written in place and stay contiguous, since the alignment is the element size.
+  _renderer_push_draw_command(mesh.first_index, mesh.index_count, 1, GRenderer.draw_data_count);
+  
+  u64 offset;
+  Renderer_Draw_Data* data = (Renderer_Draw_Data*)renderer_stream_buffer_push(&GRenderer.draw_data, sizeof(Renderer_Draw_Data), sizeof(Renderer_Draw_Data), &offset);
+  data->transform = transform;
+  data->color     = color;
+  GRenderer.draw_data_count += 1;
+}
+
+/* The vertices renderer_upload_model sends for one mesh, coloured by its material */
+internal void _renderer_model_mesh_vertices(Model* model, u32 mesh_index, Vertex* vertices) {
+  Mesh* mesh = &model->meshes_data[mesh_index];
+  Vector4 color = model->mesh_material ? model->materials_data[model->mesh_material[mesh_index]].maps[0].color : vector4(1.0f, 1.0f, 1.0f, 1.0f);
+  for (u32 j = 0; j < mesh->vertex_count; j += 1) {
+    Vector2 uv     = mesh->uv      ? mesh->uv[j]      : vector2(0.0f, 0.0f);
+    Vector3 normal = mesh->normals ? mesh->normals[j] : vector3(0.0f, 0.0f, 0.0f);
+    vertices[j] = vertex(mesh->vertices[j], color, uv, normal, 0.0f);
+  }
+}
+
+internal void renderer_upload_model(Model* model) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh = &model->meshes_data[i];
+    Vertex* vertices = ArenaPushNoZero(scratch.arena, Vertex, mesh->vertex_count);
+    _renderer_model_mesh_vertices(model, i, vertices);
+    if (mesh->indices) {
+      u32* remap = ArenaPushNoZero(scratch.arena, u32, mesh->vertex_count);
+      _renderer_push_vertices(vertices, mesh->vertex_count, remap);
+      mesh->gpu = _renderer_push_mesh_indices(mesh->indices, mesh->triangle_count*3, remap, 0);
+      for (u32 j = 0; j < mesh->lod_count; j += 1) {
+        mesh->lods[j].gpu = _renderer_push_mesh_indices(mesh->lods[j].indices, mesh->lods[j].triangle_count*3, remap, 0);
+      }
+    } else {
+      mesh->gpu = renderer_upload_mesh(vertices, mesh->vertex_count);
+    }
+  }
+  scratch_end(&scratch);
+}
+
+internal void renderer_push_instance(Model* model, Matrix4 transform) {
+  if (GRenderer.instances_count >= Max_Instances_Per_Frame) {
+    printf("Too many instances");
+    Assert(0);
+    return;
+  }
+  
+  // NOTE(fz): Placements of the same model usually come in runs, so check the last batch before scanning.
+  u32 batch = GRenderer.instance_batches_count;
+  if (batch > 0 && GRenderer.instance_batches[batch - 1].model == model) {
+    batch -= 1;
+  } else {
+    for (u32 i = 0; i < GRenderer.instance_batches_count; i += 1) {
+      if (GRenderer.instance_batches[i].model == model) {
+        batch = i;
+        break;
+      }
+    }
+  }
+  if (batch == GRenderer.instance_batches_count) {
+    if (GRenderer.instance_batches_count >= Max_Instance_Models) {
+      printf("Too many instanced models");
+      Assert(0);
+      return;
+    }
+    u32 reserve = model->mesh_count * (Max_Mesh_Lods + 1);
+    if (GRenderer.instance_draws_reserved + reserve > Max_Instance_Draws_Per_Frame) {
+      printf("Too many instanced meshes");
+      Assert(0);
+      return;
+    }
+    GRenderer.instance_draws_reserved += reserve;
+    GRenderer.instance_batches[batch].model = model;
+    GRenderer.instance_batches[batch].count = 0;
+    GRenderer.instance_batches_count += 1;
+  }
+  
+  GRenderer.instance_batches[batch].count += 1;
+  GRenderer.instances_data[GRenderer.instances_count].batch     = batch;
+  GRenderer.instances_data[GRenderer.instances_count].transform = transform;
+  GRenderer.instances_count += 1;
+}
 
-  if (!a_exists) {
-    GRenderer.vertices_data[GRenderer.vertices_count] = a;
-    GRenderer.lines_indices_data[GRenderer.lines_indices_count] = GRenderer.vertices_count;
-    GRenderer.vertices_count      += 1;
-    GRenderer.lines_indices_count += 1;
+internal void renderer_push_occluder(Model* model, Matrix4 transform) {
+  if (GRenderer.occluders_count >= Max_Occluders_Per_Frame) {
+    printf("Too many occluders");
+    Assert(0);
+    return;
+  }
+  GRenderer.occluders[GRenderer.occluders_count].model     = model;
+  GRenderer.occluders[GRenderer.occluders_count].transform = transform;
+  GRenderer.occluders_count += 1;
+}
+
+/* True when every index addresses one of the vertex_count vertices */
+internal b32 _renderer_indices_in_range(u32* indices, u64 count, u32 vertex_count) {
+  u32 max_index = 0;
+  for (u64 i = 0; i < count; i += 1) {
+    max_index = Max(max_index, indices[i]);
+  }
+  return count == 0 || max_index < vertex_count;
+}
+
+/* True when count elements of stride bytes at offset fit in size bytes, without overflowing on hostile values */
+internal b32 _renderer_cache_blob_fits(u64 size, u64 offset, u64 count, u64 stride) {
+  return offset <= size && count <= (size - offset) / stride;
+}
+
+/* True when every meshlet's triangle range lies inside the mesh's triangle_count */
+internal b32 _renderer_meshlets_in_range(Meshlet* meshlets, u32 meshlet_count, u32 triangle_count) {
+  for (u32 i = 0; i < meshlet_count; i += 1) {
+    if ((u64)meshlets[i].first_triangle + meshlets[i].triangle_count > triangle_count) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+internal b32 renderer_load_mesh_cache(Model* model, String cache_path, u64 source_hash) {
+  if (!os_file_exists(cache_path)) {
+    return 0;
   }
-  if (!b_exists) {
-    GRenderer.vertices_data[GRenderer.vertices_count] = b;
-    GRenderer.lines_indices_data[GRenderer.lines_indices_count] = GRenderer.vertices_count;
-    GRenderer.vertices_count      += 1;
-    GRenderer.lines_indices_count += 1;
+  OS_File file = os_file_map(cache_path);
+  Mesh_Cache_Header* header = (Mesh_Cache_Header*)file.data;
+  if (file.size < sizeof(Mesh_Cache_Header) || header->magic != Mesh_Cache_Magic || header->version != Mesh_Cache_Version ||
+      header->source_hash != source_hash || header->size > file.size) {
+    printf("Mesh cache %s is stale, reimporting.\n", cache_path.str);
+    os_file_unmap(&file);
+    return 0;
+  }
+  
+  // NOTE(fz): Every offset and count comes from the file, so each blob is checked against what's left after its offset.
+  u64 size  = header->size;
+  b32 valid = size >= sizeof(Mesh_Cache_Header) &&
+              _renderer_cache_blob_fits(size, sizeof(Mesh_Cache_Header), header->material_count, sizeof(Mesh_Cache_Material)) &&
+              _renderer_cache_blob_fits(size, sizeof(Mesh_Cache_Header) + sizeof(Mesh_Cache_Material)*(u64)header->material_count, header->mesh_count, sizeof(Mesh_Cache_Mesh));
+  Mesh_Cache_Material* materials = (Mesh_Cache_Material*)(file.data + sizeof(Mesh_Cache_Header));
+  Mesh_Cache_Mesh*     meshes    = valid ? (Mesh_Cache_Mesh*)(materials + header->material_count) : NULL;
+  for (u32 i = 0; valid && i < header->mesh_count; i += 1) {
+    Mesh_Cache_Mesh* it = &meshes[i];
+    valid = it->material < header->material_count &&
+            _renderer_cache_blob_fits(size, it->vertices_offset, it->vertex_count,   sizeof(Vector3)) &&
+            _renderer_cache_blob_fits(size, it->uv_offset,       it->vertex_count,   sizeof(Vector2)) &&
+            _renderer_cache_blob_fits(size, it->normals_offset,  it->vertex_count,   sizeof(Vector3)) &&
+            _renderer_cache_blob_fits(size, it->packed_offset,   it->vertex_count,   sizeof(Vertex_Packed)) &&
+            _renderer_cache_blob_fits(size, it->indices_offset,  it->triangle_count, sizeof(u32)*3) &&
+            _renderer_cache_blob_fits(size, it->meshlets_offset, it->meshlet_count,  sizeof(Meshlet)) &&
+            it->lod_count <= Max_Mesh_Lods;
+    for (u32 j = 0; valid && j < it->lod_count; j += 1) {
+      valid = _renderer_cache_blob_fits(size, it->lod_indices_offset[j], it->lod_triangle_count[j], sizeof(u32)*3);
+    }
+    
+    // NOTE(fz): The indices go to the GPU and to picking as they are, an out of range one would read past the vertices.
+    // Meshlet draws index into the mesh's own range the same way.
+    valid = valid && _renderer_indices_in_range((u32*)(file.data + it->indices_offset), 3*(u64)it->triangle_count, it->vertex_count);
+    for (u32 j = 0; valid && j < it->lod_count; j += 1) {
+      valid = _renderer_indices_in_range((u32*)(file.data + it->lod_indices_offset[j]), 3*(u64)it->lod_triangle_count[j], it->vertex_count);
+    }
+    valid = valid && _renderer_meshlets_in_range((Meshlet*)(file.data + it->meshlets_offset), it->meshlet_count, it->triangle_count);
+  }
+  if (!valid) {
+    printf("Mesh cache %s is corrupt, reimporting.\n", cache_path.str);
+    os_file_unmap(&file);
+    return 0;
+  }
+  
+  model->cache          = file;
+  model->bounds         = header->bounds;
+  model->material_count = header->material_count;
+  model->materials_data = ArenaPush(model->arena, Material, model->material_count);
+  for (u32 i = 0; i < model->material_count; i += 1) {
+    Material* material = &model->materials_data[i];
+    material->shader = GRenderer.main_shader;
+    material->maps   = ArenaPush(model->arena, MaterialMap, 1);
+    material->maps[0].color = materials[i].color;
+    material->maps[0].value = materials[i].value;
+  }
+  
+  // NOTE(fz): The mesh arrays point straight into the mapping, only the packed vertices and indices are copied, into the GPU buffers.
+  model->mesh_count    = header->mesh_count;
+  model->meshes_data   = ArenaPush(model->arena, Mesh, model->mesh_count);
+  model->mesh_material = ArenaPush(model->arena, u32, model->mesh_count);
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh_Cache_Mesh* it = &meshes[i];
+    Mesh* mesh = &model->meshes_data[i];
+    mesh->vertex_count   = it->vertex_count;
+    mesh->triangle_count = it->triangle_count;
+    mesh->bounds         = it->bounds;
+    mesh->vertices       = (Vector3*)(file.data + it->vertices_offset);
+    mesh->uv             = (Vector2*)(file.data + it->uv_offset);
+    mesh->normals        = (Vector3*)(file.data + it->normals_offset);
+    mesh->indices        = (u32*)(file.data + it->indices_offset);
+    u32 base  = GRenderer.vertices_count;
+    mesh->gpu = renderer_upload_mesh_packed((Vertex_Packed*)(file.data + it->packed_offset), it->vertex_count, mesh->indices, it->triangle_count*3);
+    mesh->meshlet_count = it->meshlet_count;
+    mesh->meshlets      = (Meshlet*)(file.data + it->meshlets_offset);
+    mesh->lod_count = it->lod_count;
+    for (u32 j = 0; j < it->lod_count; j += 1) {
+      Mesh_Lod* lod = &mesh->lods[j];
+      lod->indices        = (u32*)(file.data + it->lod_indices_offset[j]);
+      lod->triangle_count = it->lod_triangle_count[j];
+      lod->error          = it->lod_error[j];
+      lod->gpu            = _renderer_push_mesh_indices(lod->indices, lod->triangle_count*3, NULL, base);
+    }
+    model->mesh_material[i] = it->material;
+  }
+  return 1;
+}
+
+internal void renderer_write_mesh_cache(Model* model, String cache_path, u64 source_hash) {
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  u64 size = sizeof(Mesh_Cache_Header) + sizeof(Mesh_Cache_Material)*model->material_count + sizeof(Mesh_Cache_Mesh)*model->mesh_count;
+  Mesh_Cache_Mesh* meshes = ArenaPush(scratch.arena, Mesh_Cache_Mesh, model->mesh_count);
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh = &model->meshes_data[i];
+    Mesh_Cache_Mesh* it = &meshes[i];
+    it->vertex_count    = mesh->vertex_count;
+    it->triangle_count  = mesh->triangle_count;
+    it->material        = model->mesh_material[i];
+    it->bounds          = mesh->bounds;
+    it->vertices_offset = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->vertices_offset + sizeof(Vector3)*mesh->vertex_count;
+    it->uv_offset       = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->uv_offset + sizeof(Vector2)*mesh->vertex_count;
+    it->normals_offset  = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->normals_offset + sizeof(Vector3)*mesh->vertex_count;
+    it->packed_offset   = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->packed_offset + sizeof(Vertex_Packed)*mesh->vertex_count;
+    it->indices_offset  = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->indices_offset + sizeof(u32)*3*(u64)mesh->triangle_count;
+    it->meshlet_count   = mesh->meshlet_count;
+    it->meshlets_offset = AlignPow2(size, Mesh_Cache_Alignment);
+    size = it->meshlets_offset + sizeof(Meshlet)*(u64)mesh->meshlet_count;
+    it->lod_count = mesh->lod_count;
+    for (u32 j = 0; j < mesh->lod_count; j += 1) {
+      it->lod_triangle_count[j] = mesh->lods[j].triangle_count;
+      it->lod_error[j]          = mesh->lods[j].error;
+      it->lod_indices_offset[j] = AlignPow2(size, Mesh_Cache_Alignment);
+      size = it->lod_indices_offset[j] + sizeof(u32)*3*(u64)mesh->lods[j].triangle_count;
+    }
+  }
+  
+  u8* data = ArenaPush(scratch.arena, u8, size);
+  Mesh_Cache_Header* header = (Mesh_Cache_Header*)data;
+  header->magic          = Mesh_Cache_Magic;
+  header->version        = Mesh_Cache_Version;
+  header->source_hash    = source_hash;
+  header->size           = size;
+  header->bounds         = model->bounds;
+  header->mesh_count     = model->mesh_count;
+  header->material_count = model->material_count;
+  
+  Mesh_Cache_Material* materials = (Mesh_Cache_Material*)(data + sizeof(Mesh_Cache_Header));
+  for (u32 i = 0; i < model->material_count; i += 1) {
+    materials[i].color = model->materials_data[i].maps[0].color;
+    materials[i].value = model->materials_data[i].maps[0].value;
+  }
+  MemoryCopy(materials + model->material_count, meshes, sizeof(Mesh_Cache_Mesh)*model->mesh_count);
+  
+  for (u32 i = 0; i < model->mesh_count; i += 1) {
+    Mesh* mesh = &model->meshes_data[i];
+    Mesh_Cache_Mesh* it = &meshes[i];
+    MemoryCopy(data + it->vertices_offset, mesh->vertices, sizeof(Vector3)*mesh->vertex_count);
+    MemoryCopy(data + it->uv_offset,       mesh->uv,       sizeof(Vector2)*mesh->vertex_count);
+    MemoryCopy(data + it->normals_offset,  mesh->normals,  sizeof(Vector3)*mesh->vertex_count);
+    MemoryCopy(data + it->indices_offset,  mesh->indices,  sizeof(u32)*3*(u64)mesh->triangle_count);
+    MemoryCopy(data + it->meshlets_offset, mesh->meshlets, sizeof(Meshlet)*(u64)mesh->meshlet_count);
+    for (u32 j = 0; j < mesh->lod_count; j += 1) {
+      MemoryCopy(data + it->lod_indices_offset[j], mesh->lods[j].indices, sizeof(u32)*3*(u64)mesh->lods[j].triangle_count);
+    }
+    
+    Arena_Temp vertices_scratch = arena_temp_begin(scratch.arena);
+    Vertex* vertices = ArenaPushNoZero(scratch.arena, Vertex, mesh->vertex_count);
+    _renderer_model_mesh_vertices(model, i, vertices);
+    vertices_pack(vertices, (Vertex_Packed*)(data + it->packed_offset), mesh->vertex_count);
+    arena_temp_end(&vertices_scratch);
+  }
+  
+  if (!os_file_create(cache_path) || os_file_write(cache_path, data, size) != size) {
+    printf("Failed to write mesh cache %s.\n", cache_path.str);
+  }
+  scratch_end(&scratch);
+}
+
+internal Vertex_Packed* renderer_push_stream_lines(u32 line_count) {
+  u64 offset;
+  Vertex_Packed* result = (Vertex_Packed*)renderer_stream_buffer_push(&GRenderer.stream_lines, line_count*2*sizeof(Vertex_Packed), sizeof(Vertex_Packed), &offset);
+  if (GRenderer.stream_lines_count == 0) {
+    GRenderer.stream_lines_first = (u32)(offset / sizeof(Vertex_Packed));
+  }
+  GRenderer.stream_lines_count += line_count*2;
+  return result;
+}
+
+internal void renderer_push_stream_line(Vector3 a_position, Vector3 b_position, u32 texture) {
+  Vertex vertices[2] = {
+    vertex(a_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture),
+    vertex(b_position, vector4(1.0f, 1.0f, 1.0f, 1.0f), vector2(0.0f, 0.0f), vector3(0.0, 0.0, 0.0), texture),
+  };
+  vertices_pack(vertices, renderer_push_stream_lines(1), 2);
+}
+
+internal Renderer_Stream_Buffer renderer_stream_buffer_init(u64 frame_size) {
+  Renderer_Stream_Buffer result = { 0 };
+  result.frame_size = frame_size;
+  
+  if (GRenderer.backend == RendererBackend_Software) {
+    result.data = ArenaPush(GRenderer.arena, u8, frame_size * Stream_Buffer_Frames);
+    return result;
+  }
+  
+  // NOTE(fz): Coherent, so writes through data are visible to the GPU without an explicit flush.
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glCreateBuffers(1, &result.buffer);
+  glNamedBufferStorage(result.buffer, frame_size * Stream_Buffer_Frames, NULL, flags);
+  result.data = (u8*)glMapNamedBufferRange(result.buffer, 0, frame_size * Stream_Buffer_Frames, flags);
+  if (result.data == NULL) {
+    printf("Error mapping stream buffer of %llu bytes.", frame_size * Stream_Buffer_Frames);
+    Assert(0);
+  }
+  return result;
+}
+
+internal void* renderer_stream_buffer_push(Renderer_Stream_Buffer* stream, u64 size, u64 alignment, u64* offset) {
+  // NOTE(fz): Alignment does not have to be a power of two, vertex strides usually aren't.
+  u64 frame_start = stream->frame_index * stream->frame_size;
+  u64 aligned     = ((frame_start + stream->frame_offset + alignment - 1) / alignment) * alignment;
+  if (aligned + size > frame_start + stream->frame_size) {
+    printf("Stream buffer frame is full");
+    Assert(0);
+  }
+  stream->frame_offset = aligned + size - frame_start;
+  *offset = aligned;
+  return stream->data + aligned;
+}
+
+internal void renderer_stream_buffer_next_frame(Renderer_Stream_Buffer* stream) {
+  if (GRenderer.backend == RendererBackend_OpenGL) {
+    stream->fences[stream->frame_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+  stream->frame_index  = (stream->frame_index + 1) % Stream_Buffer_Frames;
+  stream->frame_offset = 0;
+  
+  // NOTE(fz): With 3 regions this only blocks when the GPU is more than two frames behind.
+  GLsync fence = stream->fences[stream->frame_index];
+  if (fence) {
+    for (;;) {
+      GLenum wait = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+      if (wait == GL_ALREADY_SIGNALED || wait == GL_CONDITION_SATISFIED) {
+        break;
+      }
+      if (wait == GL_WAIT_FAILED) {
+        printf("Error waiting on stream buffer fence.");
+        Assert(0);
+        break;
+      }
+    }
+    glDeleteSync(fence);
+    stream->fences[stream->frame_index] = NULL;
+  }
+}
+
+internal u64 _renderer_hash_cstring(const char* str, u64 length) {
+  u64 result = 14695981039346656037ull;
+  for (u64 i = 0; i < length; i += 1) {
+    result ^= (u8)str[i];
+    result *= 1099511628211ull;
+  }
+  return result;
+}
+
+internal void renderer_cache_uniforms(u32 program) {
+  if (GRenderer.shader_uniforms_count >= Max_Shader_Programs) {
+    printf("Too many shader programs");
+    Assert(0);
+    return;
+  }
+  Renderer_Shader_Uniforms* cache = &GRenderer.shader_uniforms[GRenderer.shader_uniforms_count];
+  GRenderer.shader_uniforms_count += 1;
+  MemoryZeroStruct(cache);
+  cache->program = program;
+  
+  s32 uniform_count;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
+  for (s32 i = 0; i < uniform_count; i += 1) {
+    char name[256];
+    s32  length;
+    glGetActiveUniformName(program, (u32)i, sizeof(name), &length, name);
+    
+    // NOTE(fz): Block members report -1, they're fed through the uniform buffer instead.
+    s32 location = glGetUniformLocation(program, name);
+    if (location == -1) {
+      continue;
+    }
+    if (length > 3 && MemoryMatch(name + length - 3, "[0]", 3)) {
+      length -= 3;
+    }
+    if (cache->count >= Max_Shader_Uniforms) {
+      printf("Too many uniforms in program %u", program);
+      Assert(0);
+      break;
+    }
+    cache->uniforms[cache->count].name_hash = _renderer_hash_cstring(name, (u64)length);
+    cache->uniforms[cache->count].location  = location;
+    cache->count += 1;
+  }
+}
+
+internal s32 _renderer_uniform_location(u32 program, const char* uniform) {
+  u64 hash = _renderer_hash_cstring(uniform, strlen(uniform));
+  for (u32 i = 0; i < GRenderer.shader_uniforms_count; i += 1) {
+    Renderer_Shader_Uniforms* cache = &GRenderer.shader_uniforms[i];
+    if (cache->program != program) {
+      continue;
+    }
+    for (u32 j = 0; j < cache->count; j += 1) {
+      if (cache->uniforms[j].name_hash == hash) {
+        return cache->uniforms[j].location;
+      }
+    }
+    break;
   }
+  return -1;
 }
 
 internal void renderer_set_uniform_mat4fv(u32 program, const char* uniform, Matrix4 mat) {
-  s32 uniform_location = glGetUniformLocation(program, uniform);
+  s32 uniform_location = _renderer_uniform_location(program, uniform);
   if (uniform_location == -1) {
     printf("Matrix4 :: Uniform %s not found\n", uniform);
     return;
@@ -531,7 +3120,7 @@ internal void renderer_set_uniform_mat4fv(u32 program, const char* uniform, Matr
 }
 
 internal void renderer_set_array_s32(u32 program, const char* uniform, s32 count, s32* ptr) {
-  s32 uniform_location = glGetUniformLocation(program, uniform);
+  s32 uniform_location = _renderer_uniform_location(program, uniform);
   if (uniform_location == -1) {
     printf("Array[s32] :: Uniform %s not found\n", uniform);
     return;
@@ -540,7 +3129,7 @@ internal void renderer_set_array_s32(u32 program, const char* uniform, s32 count
 }
 
 internal void renderer_set_uniform_s32(u32 program, const char* uniform, s32 s) {
-  s32 uniform_location = glGetUniformLocation(program, uniform);
+  s32 uniform_location = _renderer_uniform_location(program, uniform);
   if (uniform_location == -1) {
     printf("s32 :: Uniform %s not found\n", uniform);
     return;
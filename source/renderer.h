@@ -13,10 +13,60 @@
 
 #define MSAA_SAMPLES 8
 
+#define Obj_Weld_Epsilon 0.00001f // Positions closer than this are merged on import
+#define Obj_Min_Chunk_Size Megabytes(1) // Smallest slice of the file worth a parser thread
+
+#define Mesh_Cache_Size         16    // FIFO entries assumed by the import time reordering and the ACMR/ATVR report
+#define Mesh_Overdraw_Threshold 1.05f // Clusters may cost this much more cache misses to get an outside-in draw order
+
+#define Meshlet_Max_Vertices  64
+#define Meshlet_Max_Triangles 124
+#define Meshlet_Kd_Leaf_Size  8   // Triangle centroids per leaf of the tree that restarts a meshlet's growth
+#define Meshlet_Cull_Batch    256 // Meshlets per parallel_for range when culling
+#define Meshlet_Cull_Min_Pixels 64.0f // Projected bounds radius under which an instance is cheaper drawn whole
+
+#define Max_Mesh_Lods     4     // Simplified levels per mesh, on top of the full one
+#define Lod_Reduction     0.5f  // Triangle count of each level against the one before
+#define Lod_Min_Reduction 0.8f  // Stop once a level keeps more than this of the one before
+#define Lod_Min_Triangles 64
+#define Lod_Pixel_Error   1.0f  // Largest on screen error, in pixels, a level may show
+#define Lod_Min_Distance  0.01f // Keeps the projected error finite with the camera inside the bounds
+
+// Binary mesh cache written next to the OBJ after the first import, see renderer_load_obj
+#define Mesh_Cache_Magic     0x48534d46 // "FMSH"
+#define Mesh_Cache_Version   5          // Bump whenever the layout, Vertex_Packed or the import changes
+#define Mesh_Cache_Alignment 64         // Every blob starts on a cache line
+#define Mesh_Cache_Extension ".cache"
+
 #define Initial_Vertices 1024
 #define Initial_Lines    3
 #define Initial_Indices  1024
-#define Initial_Textures 8
+
+// Texture handles (Vertex.texture): [0, Palette_Size) is a flat palette colour, 0 being white.
+// Above that, Palette_Size + page*Texture_Page_Layers + layer. Mirrored in fs_main.glsl.
+#define Palette_Size          256
+#define Max_Texture_Pages     4
+#define Texture_Page_Layers   64
+#define Palette_Texture_Unit  1 // Unit 0 is left to the screen pass
+#define Texture_Pages_Unit    2
+
+#define Max_Shader_Programs 8
+#define Max_Shader_Uniforms 32
+#define Frame_Uniforms_Binding 0 // layout(binding) of the Frame_Uniforms block in the shaders
+
+#define Stream_Buffer_Frames   3 // Regions in flight, the CPU writes one while the GPU reads the others
+#define Stream_Lines_Per_Frame  Kilobytes(4)
+#define Max_Draws_Per_Frame     4096
+#define Max_Meshlet_Draws_Per_Frame 4096 // Commands for visible meshlet runs, past that the rest of an instance run is drawn whole
+#define Max_Instances_Per_Frame Kilobytes(16)
+#define Max_Draw_Data_Per_Frame (1 + Max_Draws_Per_Frame + Max_Instances_Per_Frame) // The identity slot 0, then one per draw and instance
+#define Max_Instance_Models     64
+#define Max_Instance_Draws_Per_Frame 4096 // Instanced commands, reserved as one per mesh and LOD of every instanced model
+// NOTE(fz): Every plain draw takes a draw data slot, so together with the two capped lists this is the worst case.
+#define Max_Draw_Commands_Per_Frame (Max_Draw_Data_Per_Frame + Max_Instance_Draws_Per_Frame + Max_Meshlet_Draws_Per_Frame)
+#define Max_Occluders_Per_Frame 64
+#define Instance_Test_Batch     256 // Instances per parallel_for range when testing them against the occluders
+#define Draw_Data_Binding       1 // layout(binding) of the Draw_Data buffer in vs_main.glsl
 
 typedef struct Vertex {
   Vector3 position;
@@ -27,6 +77,15 @@ typedef struct Vertex {
 } Vertex;
 #define vertex(p,c,u,n,t) (Vertex){p,c,u,n,t}
 
+// What the GPU actually stores, 24 bytes against 52 for Vertex. Built with vertices_pack.
+typedef struct Vertex_Packed {
+  Vector3 position;
+  u32     color;     // RGBA8 unorm
+  u16     uv[2];     // Half floats
+  s8      normal[2]; // Octahedral encoding, snorm
+  u16     texture;
+} Vertex_Packed;
+
 typedef struct Texture {
   u32 id;
   s32 width;
@@ -47,19 +106,67 @@ typedef struct Material {
   f32 params[4];
 } Material;
 
+// Range of meshes_indices_data, drawn through the draw list with renderer_push_draw
+typedef struct Renderer_Mesh {
+  u32 first_index;
+  u32 index_count;
+} Renderer_Mesh;
+
+// Contiguous run of its mesh's triangles, culled on its own against the frustum and by its normal cone
+typedef struct Meshlet {
+  u32     first_triangle;
+  u32     triangle_count;
+  Vector3 center; // Bounding sphere, mesh space
+  f32     radius;
+  Vector3 cone_axis;   // Average facing of the triangles
+  f32     cone_cutoff; // Sine of the cone half angle, 1 when the cluster can't be backface culled
+} Meshlet;
+
+// Coarser index buffer over the vertices of its mesh
+typedef struct Mesh_Lod {
+  u32*          indices;
+  u32           triangle_count;
+  f32           error; // Mesh space distance to the full resolution surface
+  Renderer_Mesh gpu;
+} Mesh_Lod;
+
 typedef struct Mesh {
-  u32 vertex_count;
+  u32 vertex_count; // Unique vertices
   u32 triangle_count;
 
   Vector3* vertices;
   Vector2* uv;
   Vector3* normals;
+  u32*     indices; // triangle_count*3, into the arrays above
+
+  AABB bounds; // Mesh space
+  
+  Renderer_Mesh gpu; // Set by renderer_upload_model
+  
+  // Partition of the full mesh from mesh_build_meshlets, the coarser levels are drawn whole
+  u32      meshlet_count;
+  Meshlet* meshlets;
+  
+  // Simplified levels, coarsest last, from renderer_generate_model_lods. The full mesh above is level 0.
+  u32      lod_count;
+  Mesh_Lod lods[Max_Mesh_Lods];
 } Mesh;
 
+// Post-transform cache simulation, ACMR is misses per triangle (0.5 at best), ATVR misses per vertex (1 at best)
+typedef struct Mesh_Cache_Stats {
+  u32 misses;
+  u32 triangles;
+  u32 vertices;
+  f32 acmr;
+  f32 atvr;
+} Mesh_Cache_Stats;
+
 typedef struct Model {
   Arena* arena; // TODO(fz): This should be another arena, outside the struct.
+  OS_File cache; // Mapped mesh cache when the model came from one, the mesh arrays point into it
 
   Matrix4 transform;
+  AABB    bounds; // Model space, union of the mesh bounds
 
   u32   mesh_count;
   Mesh* meshes_data;
@@ -70,15 +177,166 @@ typedef struct Model {
   u32* mesh_material;
 } Model;
 
+typedef struct Obj_Corner {
+  s32 v, vt, vn; // Zero based, -1 when missing. Not range checked.
+} Obj_Corner;
+
+// Everything renderer_load_obj needs from an OBJ, polygons already fanned into triangles
+typedef struct Obj_Data {
+  Arena* arena;
+  
+  f32* positions; // xyz
+  f32* texcoords; // uv
+  f32* normals;   // xyz
+  u32  position_count;
+  u32  texcoord_count;
+  u32  normal_count;
+  
+  Obj_Corner* corners;            // triangle_count*3
+  s32*        triangle_materials; // Into materials, -1 for the default one
+  u32         triangle_count;
+  
+  tinyobj_material_t* materials; // From the mtllib, tinyobj only parses the MTL
+  u32                 material_count;
+} Obj_Data;
+
+// Mesh cache layout: header, materials, meshes, then the blobs. Offsets are from the start of the file.
+typedef struct Mesh_Cache_Header {
+  u32  magic;
+  u32  version;
+  u64  source_hash; // Size and last write time of the OBJ
+  u64  size;        // Whole file, anything shorter is a torn write
+  AABB bounds;
+  u32  mesh_count;
+  u32  material_count;
+} Mesh_Cache_Header;
+
+typedef struct Mesh_Cache_Material {
+  Vector4 color;
+  f32     value;
+} Mesh_Cache_Material;
+
+typedef struct Mesh_Cache_Mesh {
+  u32  vertex_count;
+  u32  triangle_count;
+  u32  material;
+  AABB bounds;
+  u64  vertices_offset;
+  u64  uv_offset;
+  u64  normals_offset;
+  u64  indices_offset;
+  u64  packed_offset; // Vertex_Packed, ready for the vertex buffer
+  u32  meshlet_count;
+  u64  meshlets_offset;
+  u32  lod_count;
+  u32  lod_triangle_count[Max_Mesh_Lods];
+  f32  lod_error[Max_Mesh_Lods];
+  u64  lod_indices_offset[Max_Mesh_Lods];
+} Mesh_Cache_Mesh;
+
+// Persistently mapped buffer split in Stream_Buffer_Frames regions. Each frame writes the next region
+// directly through data, and a fence per region keeps the CPU from overwriting what the GPU still reads.
+typedef struct Renderer_Stream_Buffer {
+  u32    buffer;
+  u8*    data;
+  u64    frame_size;
+  u64    frame_offset; // Write cursor inside the current region
+  u32    frame_index;
+  GLsync fences[Stream_Buffer_Frames];
+} Renderer_Stream_Buffer;
+
+// GL_TEXTURE_2D_ARRAY holding every texture of one size, bound once to its own unit
+typedef struct Renderer_Texture_Page {
+  u32 id;
+  s32 width;
+  s32 height;
+  u32 layers_count;
+  u32* texels[Texture_Page_Layers]; // RGBA8 copy of each layer, software backend only
+} Renderer_Texture_Page;
+
+// Locations of a program's default block uniforms, read once after linking. Arrays are stored without the [0].
+typedef struct Renderer_Uniform {
+  u64 name_hash;
+  s32 location;
+} Renderer_Uniform;
+
+typedef struct Renderer_Shader_Uniforms {
+  u32 program;
+  u32 count;
+  Renderer_Uniform uniforms[Max_Shader_Uniforms];
+} Renderer_Shader_Uniforms;
+
+// Mirrors the std140, row_major Frame_Uniforms block in the shaders, keep both in sync.
+typedef struct Renderer_Frame_Uniforms {
+  Matrix4 view;
+  Matrix4 projection;
+  Matrix4 view_projection;
+  Vector4 viewport; // x, y, width, height
+  f32     time;
+  f32     _pad[3];
+} Renderer_Frame_Uniforms;
+
+// Layout fixed by glMultiDrawElementsIndirect
+typedef struct Renderer_Draw_Command {
+  u32 count;
+  u32 instance_count;
+  u32 first_index;
+  s32 base_vertex;
+  u32 base_instance; // Index into the frame's Draw_Data
+} Renderer_Draw_Command;
+
+// Mirrors Draw in vs_main.glsl (std430, row_major), keep both in sync.
+typedef struct Renderer_Draw_Data {
+  Matrix4 transform;
+  Vector4 color;
+} Renderer_Draw_Data;
+
+// Placements of one model collected this frame. Each mesh becomes one command with count instances.
+typedef struct Renderer_Instance_Batch {
+  Model* model;
+  u32    count;
+  u32    visible; // Instances left by occlusion culling, packed before the hidden ones
+  u32    next; // Scatter cursor while packing the draw data
+} Renderer_Instance_Batch;
+
+typedef struct Renderer_Instance {
+  u32     batch;
+  Matrix4 transform;
+} Renderer_Instance;
+
+typedef struct Renderer_Occluder {
+  Model*  model;
+  Matrix4 transform;
+} Renderer_Occluder;
+
+// Span of a CPU side array that changed since the last upload, in elements. Empty when min >= max.
+typedef struct Renderer_Dirty_Range {
+  u32 min;
+  u32 max;
+} Renderer_Dirty_Range;
+
+typedef enum Renderer_Backend {
+  RendererBackend_OpenGL,
+  RendererBackend_Software, // No GL context, see renderer_init_software
+} Renderer_Backend;
+
 typedef struct Renderer {
+  Renderer_Backend backend;
   
   u32 main_shader;
   
   u32     vertices_vao;
   u32     vertices_vbo;
-  Vertex* vertices_data;
+  u32     vertices_vbo_capacity; // In vertices, grows to cover vertices_count on upload
+  Vertex_Packed* vertices_data;
   u32     vertices_count;
   u32     vertices_capacity;
+  
+  // Open addressed dedup table over vertices_data, keyed on the Vertex_Packed bytes.
+  // Slots hold vertex index + 1, 0 is empty. Twice vertices_capacity so probes stay short.
+  u32* vertices_hash_slots;
+  u32  vertices_hash_capacity; // Power of two
+  Renderer_Dirty_Range vertices_dirty;
 
   // Offscreen 
   u32 msaa_fbo;
@@ -96,32 +354,119 @@ typedef struct Renderer {
   Arena* arena;
   
   u32  triangles_ebo;
+  u32  triangles_ebo_capacity;
   u32* triangles_indices_data;
   u32  triangles_indices_count;
   u32  triangles_indices_capacity;
+  Renderer_Dirty_Range triangles_indices_dirty;
   
   u32  lines_ebo;
+  u32  lines_ebo_capacity;
   u32* lines_indices_data;
   u32  lines_indices_count;
   u32  lines_indices_capacity;
+  Renderer_Dirty_Range lines_indices_dirty;
+  
+  // Uploaded meshes, they share vertices_data and are only drawn through the draw list
+  u32  meshes_ebo;
+  u32  meshes_ebo_capacity;
+  u32* meshes_indices_data;
+  u32  meshes_indices_count;
+  u32  meshes_indices_capacity;
+  Renderer_Dirty_Range meshes_indices_dirty;
+  
+  u32 palette_texture;
+  u32 palette_data[Palette_Size]; // RGBA8
+  u32 palette_count;
+  
+  Renderer_Texture_Page texture_pages[Max_Texture_Pages];
+  u32                   texture_pages_count;
+
+  Renderer_Shader_Uniforms shader_uniforms[Max_Shader_Programs];
+  u32 shader_uniforms_count;
+  
+  // Frame_Uniforms, one aligned slot per frame region
+  Renderer_Stream_Buffer frame_uniforms;
+  u64 frame_uniforms_alignment;
+  
+  // Draw list, rebuilt every frame and submitted with one glMultiDrawElementsIndirect.
+  // Draw data 0 is the identity transform used by the immediate triangles and lines.
+  Renderer_Stream_Buffer draw_commands;
+  Renderer_Stream_Buffer draw_data;
+  u64 draw_commands_offset; // First of the frame, in bytes
+  u64 draw_data_offset;
+  u64 draw_data_alignment; // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, draw_data_offset is always a multiple of it
+  u32 draw_commands_count;
+  u32 draw_data_count;
+  u32 meshlet_draws_count;
+  u32 instance_draws_reserved; // Against Max_Instance_Draws_Per_Frame, taken when a model gets its batch
+  
+  // Instances, grouped per model in renderer_draw so the transforms stay contiguous in the draw data
+  Renderer_Instance*      instances_data;
+  u32                     instances_count;
+  Renderer_Instance_Batch instance_batches[Max_Instance_Models];
+  u32                     instance_batches_count;
   
-  u32* textures_data;
-  u32  textures_count;
-  u32  textures_capacity;
+  // Occluders of the frame, rasterized on the CPU before the instances and their meshlets are packed
+  Occlusion_Buffer  occlusion;
+  Renderer_Occluder occluders[Max_Occluders_Per_Frame];
+  u32               occluders_count;
+  
+  // Per frame debug lines, non indexed
+  Renderer_Stream_Buffer stream_lines;
+  u32 stream_lines_first; // In vertices, from the start of the buffer
+  u32 stream_lines_count;
+  
+  // Colour and depth targets of the software backend, everything GL above stays zero with it
+  Renderer_Software software;
 } Renderer;
 
 Renderer GRenderer;
 
 internal void renderer_init(s32 window_width, s32 window_height);
-internal void renderer_draw(Matrix4 view, Matrix4 projection, s32 window_width, s32 window_height);
+internal void renderer_init_software(s32 width, s32 height); /* Same API drawn on the CPU, frames land in GRenderer.software.color */
+internal void renderer_draw(Matrix4 view, Matrix4 projection, s32 window_width, s32 window_height, f32 time);
 internal void renderer_on_resize(s32 window_width, s32 window_height);
 
-internal f32   renderer_load_color_texture(f32 r, f32 g, f32 b, f32 a);
+internal f32   renderer_load_color_texture(f32 r, f32 g, f32 b, f32 a); /* Palette entry, identical colours share one */
+internal f32   renderer_load_texture(u8* rgba, s32 width, s32 height); /* Layer in the page of that size */
 internal Model renderer_load_obj(String path);
+internal void    renderer_generate_model_lods(Model* model); /* Quadric simplified chain for every mesh, uploaded by renderer_upload_model */
+internal void    renderer_optimize_model(Model* model, String name); /* Cache, overdraw and fetch order then meshlets for every mesh, prints ACMR/ATVR before and for the final order */
+internal b32     renderer_load_mesh_cache(Model* model, String cache_path, u64 source_hash); /* Maps and uploads, false when missing or stale */
+internal void    renderer_write_mesh_cache(Model* model, String cache_path, u64 source_hash);
+internal void    renderer_compute_model_bounds(Model* model);
+internal u32     renderer_cull_models(Frustum* frustum, Model* models, u32 model_count, u32* visible); /* Returns the visible count, visible needs model_count entries */
+internal Ray_Hit renderer_intersect_ray_with_model(Model* model, Ray ray, u32* mesh_index); /* Closest hit, mesh_index is only written on hit */
+
+internal Mesh_Cache_Stats mesh_analyze_vertex_cache(Mesh* mesh, u32 cache_size);
+internal void mesh_optimize_vertex_cache(Mesh* mesh, u32 cache_size, f32 overdraw_threshold); /* Reorders triangles only */
+internal void mesh_optimize_vertex_fetch(Mesh* mesh); /* Reorders vertices in first use order, call last */
+internal void mesh_build_meshlets(Mesh* mesh, Arena* arena); /* Reorders the triangles, run it after the other optimizations */
+internal u32  mesh_simplify(Mesh* mesh, u32 target_triangle_count, u32* out, f32* error); /* out needs triangle_count*3, returns the triangles written */
+
+internal void vertices_pack(Vertex* vertices, Vertex_Packed* packed, u64 count);
 
 internal void renderer_push_triangle(Vertex a, Vertex b, Vertex c);
+internal void renderer_push_triangles(Vertex* vertices, u32 vertex_count); /* vertex_count/3 triangles, deduped in one pass */
 internal void renderer_push_line(Vector3 a_position, Vector3 b_position, u32 texture);
 
+internal Renderer_Mesh renderer_upload_mesh(Vertex* vertices, u32 vertex_count); /* vertex_count/3 triangles, stays resident */
+internal Renderer_Mesh renderer_upload_mesh_indexed(Vertex* vertices, u32 vertex_count, u32* indices, u32 index_count);
+internal Renderer_Mesh renderer_upload_mesh_packed(Vertex_Packed* vertices, u32 vertex_count, u32* indices, u32 index_count); /* Unique vertices, appended without dedup */
+internal void          renderer_push_draw(Renderer_Mesh mesh, Matrix4 transform, Vector4 color); /* Drawn by the next renderer_draw only */
+internal void          renderer_upload_model(Model* model); /* Fills mesh->gpu for every mesh */
+internal void          renderer_push_instance(Model* model, Matrix4 transform); /* Drawn by the next renderer_draw only, one command per mesh for all placements */
+internal void          renderer_push_occluder(Model* model, Matrix4 transform); /* Hides the next renderer_draw's instances behind it, its full meshes are used */
+
+internal Vertex_Packed* renderer_push_stream_lines(u32 line_count); /* 2*line_count vertices to write this frame, gone after renderer_draw */
+internal void    renderer_push_stream_line(Vector3 a_position, Vector3 b_position, u32 texture);
+
+internal Renderer_Stream_Buffer renderer_stream_buffer_init(u64 frame_size);
+internal void* renderer_stream_buffer_push(Renderer_Stream_Buffer* stream, u64 size, u64 alignment, u64* offset); /* offset is from the start of the buffer */
+internal void  renderer_stream_buffer_next_frame(Renderer_Stream_Buffer* stream); /* Call once the frame's draws are submitted */
+
+internal void renderer_cache_uniforms(u32 program); /* Call after linking, the setters below only look in this cache */
 internal void renderer_set_uniform_mat4fv(u32 program, const char* uniform, Matrix4 mat);
 internal void renderer_set_array_s32(u32 program, const char* uniform, s32 count, s32* ptr);
 internal void renderer_set_uniform_s32(u32 program, const char* uniform, s32 s);
@@ -0,0 +1,644 @@
+// One GL draw call worth of primitives, with its Draw_Data already folded in
+typedef struct Software_Draw {
+  Vertex_Packed* vertices;
+  u32*           indices; // NULL for non indexed draws, vertices are then read in order
+  u32            first;   // Index, or vertex for non indexed draws
+  u32            count;
+  s32            base_vertex;
+  b32            lines;
+  Matrix4        model_view_projection;
+  Vector4        color;
+} Software_Draw;
+
+// Vertex on its way from clip space to the screen. Before projection values only holds the attributes,
+// after it every plane, divided by w but for the depth.
+typedef struct Software_Vertex {
+  Vector4 clip;
+  f32     x;
+  f32     y;
+  f32     values[SoftwarePlane_Count];
+} Software_Vertex;
+
+typedef struct Software_Batch {
+  Software_Draw* draws;
+  u32*           primitive_draws;  // capacity each
+  u32*           primitive_firsts; // First index of the primitive in its draw
+  u32            count;
+  u32            capacity;
+  
+  Software_Triangle* triangles; // Software_Max_Clipped per primitive
+  u8*                triangle_counts;
+  Software_Line*     lines;     // One per primitive
+  u8*                line_counts;
+  
+  u32* bin_offsets; // tiles_x*tiles_y + 1, into bin_entries
+  u32* bin_entries; // Index into triangles, or Software_Line_Bit | index into lines
+} Software_Batch;
+
+internal void renderer_software_resize(s32 width, s32 height) {
+  Renderer_Software* software = &GRenderer.software;
+  if (software->arena) {
+    arena_free(software->arena);
+  }
+  software->width   = Max(width, 1);
+  software->height  = Max(height, 1);
+  software->stride  = AlignPow2(software->width, 8);
+  software->tiles_x = (software->width  + Software_Tile_Size - 1) / Software_Tile_Size;
+  software->tiles_y = (software->height + Software_Tile_Size - 1) / Software_Tile_Size;
+  
+  u64 pixels = (u64)software->stride*software->height;
+  software->arena = arena_init_sized(pixels*(sizeof(u32) + sizeof(f32)) + Kilobytes(64), pixels*(sizeof(u32) + sizeof(f32)) + Kilobytes(64));
+  software->color = ArenaPushNoZero(software->arena, u32, pixels);
+  software->depth = ArenaPushNoZero(software->arena, f32, pixels);
+}
+
+/* IEEE half to float, the inverse of f32x4_store_f16 */
+internal f32 _software_f32_from_f16(u16 half) {
+  u32 sign     = (u32)(half & 0x8000) << 16;
+  u32 exponent = (half >> 10) & 0x1F;
+  u32 mantissa = half & 0x3FF;
+  u32 bits;
+  if (exponent == 0x1F) {
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else if (mantissa != 0) {
+    // Subnormal, renormalized
+    exponent = 113;
+    while ((mantissa & 0x400) == 0) {
+      mantissa <<= 1;
+      exponent  -= 1;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+  } else {
+    bits = sign;
+  }
+  f32 result;
+  MemoryCopy(&result, &bits, sizeof(result));
+  return result;
+}
+
+internal Vector4 _software_unpack_rgba8(u32 color) {
+  return vector4((f32)(color & 0xFF) / 255.0f, (f32)((color >> 8) & 0xFF) / 255.0f, (f32)((color >> 16) & 0xFF) / 255.0f, (f32)(color >> 24) / 255.0f);
+}
+
+/* sample_texture of fs_main.glsl: the palette texel, or a page layer filtered bilinearly with GL_REPEAT */
+internal Vector4 _software_sample_texture(u32 texture, f32 u, f32 v) {
+  if (texture < Palette_Size) {
+    return _software_unpack_rgba8(GRenderer.palette_data[texture]);
+  }
+  u32 index = texture - Palette_Size;
+  Renderer_Texture_Page* page = &GRenderer.texture_pages[Min(index / Texture_Page_Layers, Max_Texture_Pages - 1)];
+  u32* texels = page->texels[index % Texture_Page_Layers];
+  if (texels == NULL) {
+    return vector4(0.0f, 0.0f, 0.0f, 1.0f); // What GL returns for an incomplete texture
+  }
+  
+  f32 x  = u*(f32)page->width  - 0.5f;
+  f32 y  = v*(f32)page->height - 0.5f;
+  f32 fx = floorf(x);
+  f32 fy = floorf(y);
+  f32 tx = x - fx;
+  f32 ty = y - fy;
+  s32 x0 = (((s32)fx % page->width)  + page->width)  % page->width;
+  s32 y0 = (((s32)fy % page->height) + page->height) % page->height;
+  s32 x1 = (x0 + 1) % page->width;
+  s32 y1 = (y0 + 1) % page->height;
+  
+  Vector4 c00 = _software_unpack_rgba8(texels[y0*page->width + x0]);
+  Vector4 c10 = _software_unpack_rgba8(texels[y0*page->width + x1]);
+  Vector4 c01 = _software_unpack_rgba8(texels[y1*page->width + x0]);
+  Vector4 c11 = _software_unpack_rgba8(texels[y1*page->width + x1]);
+  f32 w00 = (1.0f - tx)*(1.0f - ty), w10 = tx*(1.0f - ty);
+  f32 w01 = (1.0f - tx)*ty,          w11 = tx*ty;
+  return vector4(c00.x*w00 + c10.x*w10 + c01.x*w01 + c11.x*w11,
+                 c00.y*w00 + c10.y*w10 + c01.y*w01 + c11.y*w11,
+                 c00.z*w00 + c10.z*w10 + c01.z*w01 + c11.z*w11,
+                 c00.w*w00 + c10.w*w10 + c01.w*w01 + c11.w*w11);
+}
+
+/* One fragment: the values are already divided back by 1/w. The target is GL_RGB, alpha always reads 1. */
+internal u32 _software_shade(u32 texture, f32* values) {
+  Vector4 texel = _software_sample_texture(texture, values[SoftwarePlane_U], values[SoftwarePlane_V]);
+  return f32x4_pack_unorm8(f32x4_set(values[SoftwarePlane_Red]*texel.x, values[SoftwarePlane_Green]*texel.y, values[SoftwarePlane_Blue]*texel.z, 1.0f));
+}
+
+internal void _software_clear_rows(void* context, u64 first, u64 one_past_last) {
+  Renderer_Software* software = (Renderer_Software*)context;
+  f32x8 far = f32x8_splat(1.0f);
+  for (u64 y = first; y < one_past_last; y += 1) {
+    u32* color = software->color + y*software->stride;
+    f32* depth = software->depth + y*software->stride;
+    for (s32 x = 0; x < software->stride; x += 8) {
+      f32x8_store(depth + x, far);
+    }
+    for (s32 x = 0; x < software->stride; x += 1) {
+      color[x] = 0xFF000000; // glClearColor(0, 0, 0, 1)
+    }
+  }
+}
+
+internal void _software_fetch_vertex(Software_Draw* draw, u32 index, Software_Vertex* out) {
+  Vertex_Packed* vertex = &draw->vertices[index];
+  out->clip = mul_vector4_matrix4(vector4(vertex->position.x, vertex->position.y, vertex->position.z, 1.0f), draw->model_view_projection);
+  Vector4 color = _software_unpack_rgba8(vertex->color);
+  out->values[SoftwarePlane_Red]   = color.x*draw->color.x;
+  out->values[SoftwarePlane_Green] = color.y*draw->color.y;
+  out->values[SoftwarePlane_Blue]  = color.z*draw->color.z;
+  out->values[SoftwarePlane_Alpha] = color.w*draw->color.w;
+  out->values[SoftwarePlane_U]     = _software_f32_from_f16(vertex->uv[0]);
+  out->values[SoftwarePlane_V]     = _software_f32_from_f16(vertex->uv[1]);
+}
+
+internal Software_Vertex _software_lerp_vertex(Software_Vertex* a, Software_Vertex* b, f32 t) {
+  Software_Vertex result;
+  result.clip = vector4(a->clip.x + (b->clip.x - a->clip.x)*t, a->clip.y + (b->clip.y - a->clip.y)*t,
+                        a->clip.z + (b->clip.z - a->clip.z)*t, a->clip.w + (b->clip.w - a->clip.w)*t);
+  for (u32 i = SoftwarePlane_Red; i < SoftwarePlane_Count; i += 1) {
+    result.values[i] = a->values[i] + (b->values[i] - a->values[i])*t;
+  }
+  return result;
+}
+
+// NOTE(fz): Clip planes as dot(plane, clip) >= 0: near, then the guard band. Nothing is clipped to the sides of the
+// viewport itself, the pixel bounds take care of that and the guard band only keeps the edge functions precise.
+global Vector4 Software_Clip_Planes[5] = {
+  { 0.0f,  0.0f, 1.0f, 1.0f },
+  { 1.0f,  0.0f, 0.0f, Software_Guard_Band },
+  {-1.0f,  0.0f, 0.0f, Software_Guard_Band },
+  { 0.0f,  1.0f, 0.0f, Software_Guard_Band },
+  { 0.0f, -1.0f, 0.0f, Software_Guard_Band },
+};
+
+internal f32 _software_clip_distance(Vector4 plane, Vector4 clip) {
+  return plane.x*clip.x + plane.y*clip.y + plane.z*clip.z + plane.w*clip.w;
+}
+
+/* Bits of the frustum planes (not the guard band) the point is outside of */
+internal u32 _software_outcode(Vector4 clip) {
+  return (clip.x >  clip.w) << 0 | (clip.x < -clip.w) << 1 |
+         (clip.y >  clip.w) << 2 | (clip.y < -clip.w) << 3 |
+         (clip.z >  clip.w) << 4 | (clip.z < -clip.w) << 5;
+}
+
+internal void _software_project(Software_Vertex* vertex) {
+  Renderer_Software* software = &GRenderer.software;
+  f32 inverse_w = 1.0f / vertex->clip.w;
+  vertex->x = (vertex->clip.x*inverse_w*0.5f + 0.5f) * (f32)software->width;
+  vertex->y = (vertex->clip.y*inverse_w*0.5f + 0.5f) * (f32)software->height;
+  vertex->values[SoftwarePlane_Depth]    = vertex->clip.z*inverse_w*0.5f + 0.5f;
+  vertex->values[SoftwarePlane_InverseW] = inverse_w;
+  for (u32 i = SoftwarePlane_Red; i < SoftwarePlane_Count; i += 1) {
+    vertex->values[i] *= inverse_w;
+  }
+}
+
+/* Returns false when the triangle is culled or covers no pixel centre */
+internal b32 _software_setup_triangle(Software_Vertex* p0, Software_Vertex* p1, Software_Vertex* p2, u32 texture, Software_Triangle* triangle) {
+  Renderer_Software* software = &GRenderer.software;
+  f32 area = raster_triangle_setup(&triangle->raster, vector2(p0->x, p0->y), vector2(p1->x, p1->y), vector2(p2->x, p2->y), software->width, software->height);
+  if (area == 0.0f) {
+    return false;
+  }
+  
+  f32 dx1 = p1->x - p0->x, dy1 = p1->y - p0->y;
+  f32 dx2 = p2->x - p0->x, dy2 = p2->y - p0->y;
+  for (u32 i = 0; i < SoftwarePlane_Count; i += 1) {
+    f32 dq1 = p1->values[i] - p0->values[i];
+    f32 dq2 = p2->values[i] - p0->values[i];
+    f32 dx  = (dq1*dy2 - dq2*dy1) / area;
+    f32 dy  = (dx1*dq2 - dx2*dq1) / area;
+    triangle->planes[i][0] = dx;
+    triangle->planes[i][1] = dy;
+    triangle->planes[i][2] = p0->values[i] - dx*(p0->x - 0.5f) - dy*(p0->y - 0.5f);
+  }
+  triangle->texture = texture;
+  return true;
+}
+
+/* Clips against the near plane and the guard band, then fans the polygon. Returns the triangles written to out. */
+internal u32 _software_setup_triangles(Software_Vertex* corners, u32 texture, Software_Triangle* out) {
+  u32 outside = _software_outcode(corners[0].clip) & _software_outcode(corners[1].clip) & _software_outcode(corners[2].clip);
+  if (outside) {
+    return 0;
+  }
+  
+  Software_Vertex polygons[2][8];
+  Software_Vertex* polygon = polygons[0];
+  u32 count = 3;
+  MemoryCopy(polygon, corners, sizeof(Software_Vertex)*3);
+  for (u32 p = 0; p < ArrayCount(Software_Clip_Planes); p += 1) {
+    Vector4 plane = Software_Clip_Planes[p];
+    b32 all_inside = true;
+    for (u32 i = 0; i < count; i += 1) {
+      all_inside &= _software_clip_distance(plane, polygon[i].clip) >= 0.0f;
+    }
+    if (all_inside) {
+      continue;
+    }
+    
+    // Sutherland-Hodgman, one plane at a time
+    Software_Vertex* clipped = (polygon == polygons[0]) ? polygons[1] : polygons[0];
+    u32 clipped_count = 0;
+    for (u32 i = 0; i < count; i += 1) {
+      Software_Vertex* a = &polygon[i];
+      Software_Vertex* b = &polygon[(i + 1) % count];
+      f32 da = _software_clip_distance(plane, a->clip);
+      f32 db = _software_clip_distance(plane, b->clip);
+      if (da >= 0.0f) {
+        clipped[clipped_count++] = *a;
+      }
+      if ((da >= 0.0f) != (db >= 0.0f)) {
+        clipped[clipped_count++] = _software_lerp_vertex(a, b, da / (da - db));
+      }
+    }
+    polygon = clipped;
+    count   = clipped_count;
+    if (count < 3) {
+      return 0;
+    }
+  }
+  
+  for (u32 i = 0; i < count; i += 1) {
+    if (!(polygon[i].clip.w > 0.0f)) {
+      return 0;
+    }
+    _software_project(&polygon[i]);
+  }
+  
+  u32 result = 0;
+  for (u32 i = 1; i + 1 < count; i += 1) {
+    result += _software_setup_triangle(&polygon[0], &polygon[i], &polygon[i + 1], texture, &out[result]);
+  }
+  return result;
+}
+
+/* Clips the segment against the same planes as the triangles. Returns false when nothing is left of it. */
+internal b32 _software_setup_line(Software_Vertex* ends, u32 texture, Software_Line* out) {
+  if (_software_outcode(ends[0].clip) & _software_outcode(ends[1].clip)) {
+    return false;
+  }
+  
+  // Liang-Barsky, the kept part is t in [t0, t1]
+  f32 t0 = 0.0f;
+  f32 t1 = 1.0f;
+  for (u32 p = 0; p < ArrayCount(Software_Clip_Planes); p += 1) {
+    f32 da = _software_clip_distance(Software_Clip_Planes[p], ends[0].clip);
+    f32 db = _software_clip_distance(Software_Clip_Planes[p], ends[1].clip);
+    if (da < 0.0f && db < 0.0f) {
+      return false;
+    }
+    if (da < 0.0f) {
+      t0 = Max(t0, da / (da - db));
+    } else if (db < 0.0f) {
+      t1 = Min(t1, da / (da - db));
+    }
+  }
+  if (t0 > t1) {
+    return false;
+  }
+  
+  Software_Vertex clipped[2] = {
+    _software_lerp_vertex(&ends[0], &ends[1], t0),
+    _software_lerp_vertex(&ends[0], &ends[1], t1),
+  };
+  for (u32 i = 0; i < 2; i += 1) {
+    if (!(clipped[i].clip.w > 0.0f)) {
+      return false;
+    }
+    _software_project(&clipped[i]);
+    out->x[i] = clipped[i].x;
+    out->y[i] = clipped[i].y;
+    MemoryCopy(out->values[i], clipped[i].values, sizeof(out->values[i]));
+  }
+  out->texture = texture;
+  return true;
+}
+
+/* Vertex fetch, transform, clipping and setup of a range of the batch's primitives */
+internal void _software_setup_primitives(void* context, u64 first, u64 one_past_last) {
+  Software_Batch* batch = (Software_Batch*)context;
+  for (u64 i = first; i < one_past_last; i += 1) {
+    Software_Draw* draw = &batch->draws[batch->primitive_draws[i]];
+    u32 at      = batch->primitive_firsts[i];
+    u32 corners = draw->lines ? 2 : 3;
+    
+    Software_Vertex vertices[3];
+    u32 last_index = 0;
+    for (u32 k = 0; k < corners; k += 1) {
+      last_index = draw->indices ? (u32)((s32)draw->indices[at + k] + draw->base_vertex) : at + k;
+      _software_fetch_vertex(draw, last_index, &vertices[k]);
+    }
+    
+    // vertex_texture is flat, GL takes it from the last vertex of the primitive
+    u32 texture = draw->vertices[last_index].texture;
+    if (draw->lines) {
+      batch->triangle_counts[i] = 0;
+      batch->line_counts[i]     = (u8)_software_setup_line(vertices, texture, &batch->lines[i]);
+    } else {
+      batch->triangle_counts[i] = (u8)_software_setup_triangles(vertices, texture, &batch->triangles[i*Software_Max_Clipped]);
+      batch->line_counts[i]     = 0;
+    }
+  }
+}
+
+internal void _software_line_bounds(Software_Line* line, s32* x0, s32* y0, s32* x1, s32* y1) {
+  Renderer_Software* software = &GRenderer.software;
+  *x0 = Clamp(0, (s32)floorf(Min(line->x[0], line->x[1])), software->width  - 1);
+  *x1 = Clamp(0, (s32)floorf(Max(line->x[0], line->x[1])), software->width  - 1);
+  *y0 = Clamp(0, (s32)floorf(Min(line->y[0], line->y[1])), software->height - 1);
+  *y1 = Clamp(0, (s32)floorf(Max(line->y[0], line->y[1])), software->height - 1);
+}
+
+/* Serial so every tile keeps its primitives in submission order, GL draws in that order and depth ties depend on it */
+internal void _software_bin_batch(Software_Batch* batch, Arena* arena) {
+  Renderer_Software* software = &GRenderer.software;
+  u32 tiles_count = software->tiles_x*software->tiles_y;
+  batch->bin_offsets = ArenaPush(arena, u32, tiles_count + 1);
+  
+  for (u32 pass = 0; pass < 2; pass += 1) {
+    for (u32 i = 0; i < batch->count; i += 1) {
+      for (u32 k = 0; k < batch->triangle_counts[i] + batch->line_counts[i]; k += 1) {
+        s32 x0, y0, x1, y1;
+        u32 entry;
+        if (batch->line_counts[i]) {
+          _software_line_bounds(&batch->lines[i], &x0, &y0, &x1, &y1);
+          entry = Software_Line_Bit | i;
+        } else {
+          Raster_Triangle* raster = &batch->triangles[i*Software_Max_Clipped + k].raster;
+          x0 = raster->min_x, y0 = raster->min_y;
+          x1 = raster->max_x, y1 = raster->max_y;
+          entry = i*Software_Max_Clipped + k;
+        }
+        for (s32 ty = y0 / Software_Tile_Size; ty <= y1 / Software_Tile_Size; ty += 1) {
+          for (s32 tx = x0 / Software_Tile_Size; tx <= x1 / Software_Tile_Size; tx += 1) {
+            u32 tile = ty*software->tiles_x + tx;
+            if (pass == 0) {
+              batch->bin_offsets[tile + 1] += 1;
+            } else {
+              batch->bin_entries[batch->bin_offsets[tile]++] = entry;
+            }
+          }
+        }
+      }
+    }
+    
+    if (pass == 0) {
+      for (u32 tile = 0; tile < tiles_count; tile += 1) {
+        batch->bin_offsets[tile + 1] += batch->bin_offsets[tile];
+      }
+      batch->bin_entries = ArenaPushNoZero(arena, u32, batch->bin_offsets[tiles_count]);
+    }
+  }
+  
+  // The fill pass moved every offset to the end of its bin, which is the start of the next one
+  for (u32 tile = tiles_count; tile > 0; tile -= 1) {
+    batch->bin_offsets[tile] = batch->bin_offsets[tile - 1];
+  }
+  batch->bin_offsets[0] = 0;
+}
+
+internal void _software_draw_triangle(Software_Triangle* triangle, s32 tile_x0, s32 tile_y0, s32 tile_x1, s32 tile_y1) {
+  Renderer_Software* software = &GRenderer.software;
+  Raster_Triangle*   raster   = &triangle->raster;
+  s32 y0 = Max(raster->min_y, tile_y0);
+  s32 y1 = Min(raster->max_y, tile_y1);
+  s32 x0 = Max(raster->min_x, tile_x0) & ~7;
+  s32 x1 = Min(raster->max_x, tile_x1);
+  if (y0 > y1 || x0 > x1) {
+    return;
+  }
+  
+  f32x8 zero  = f32x8_zero();
+  f32x8 one   = f32x8_splat(1.0f);
+  f32x8 lane  = f32x8_set(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+  f32x8 last  = f32x8_splat((f32)x1);
+  f32x8 a0 = f32x8_splat(raster->edge_a[0]), a1 = f32x8_splat(raster->edge_a[1]), a2 = f32x8_splat(raster->edge_a[2]);
+  f32x8 plane_dx[SoftwarePlane_Count];
+  for (u32 i = 0; i < SoftwarePlane_Count; i += 1) {
+    plane_dx[i] = f32x8_splat(triangle->planes[i][0]);
+  }
+  
+  for (s32 y = y0; y <= y1; y += 1) {
+    f32x8 c0 = f32x8_splat(raster->edge_b[0]*(f32)y + raster->edge_c[0]);
+    f32x8 c1 = f32x8_splat(raster->edge_b[1]*(f32)y + raster->edge_c[1]);
+    f32x8 c2 = f32x8_splat(raster->edge_b[2]*(f32)y + raster->edge_c[2]);
+    f32x8 plane_row[SoftwarePlane_Count];
+    for (u32 i = 0; i < SoftwarePlane_Count; i += 1) {
+      plane_row[i] = f32x8_splat(triangle->planes[i][1]*(f32)y + triangle->planes[i][2]);
+    }
+    u32* color_row = software->color + y*software->stride;
+    f32* depth_row = software->depth + y*software->stride;
+    
+    for (s32 x = x0; x <= x1; x += 8) {
+      f32x8 px = f32x8_add(f32x8_splat((f32)x), lane);
+      f32x8 inside = f32x8_and(f32x8_and(f32x8_cmp_ge(f32x8_madd(a0, px, c0), zero),
+                                         f32x8_cmp_ge(f32x8_madd(a1, px, c1), zero)),
+                               f32x8_and(f32x8_cmp_ge(f32x8_madd(a2, px, c2), zero),
+                                         f32x8_cmp_le(px, last)));
+      if (f32x8_mask_bits(inside) == 0) {
+        continue;
+      }
+      
+      // Depth test LESS, written for every lane that passes
+      f32x8 z    = f32x8_madd(plane_dx[SoftwarePlane_Depth], px, plane_row[SoftwarePlane_Depth]);
+      f32x8 old  = f32x8_load(depth_row + x);
+      f32x8 pass = f32x8_and(inside, f32x8_cmp_lt(z, old));
+      u32 bits = f32x8_mask_bits(pass);
+      if (bits == 0) {
+        continue;
+      }
+      f32x8_store(depth_row + x, f32x8_select(pass, z, old));
+      
+      // Perspective correct attributes, then the texture lookup one fragment at a time
+      f32x8 w = f32x8_div(one, f32x8_madd(plane_dx[SoftwarePlane_InverseW], px, plane_row[SoftwarePlane_InverseW]));
+      f32 values[SoftwarePlane_Count][8];
+      for (u32 i = SoftwarePlane_Red; i < SoftwarePlane_Count; i += 1) {
+        f32x8_store(values[i], f32x8_mul(f32x8_madd(plane_dx[i], px, plane_row[i]), w));
+      }
+      for (u32 k = 0; k < 8; k += 1) {
+        if (bits & (1u << k)) {
+          f32 fragment[SoftwarePlane_Count];
+          for (u32 i = SoftwarePlane_Red; i < SoftwarePlane_Count; i += 1) {
+            fragment[i] = values[i][k];
+          }
+          color_row[x + k] = _software_shade(triangle->texture, fragment);
+        }
+      }
+    }
+  }
+}
+
+/* One pixel per step along the major axis, at the centres of the pixels the segment spans */
+internal void _software_draw_line(Software_Line* line, s32 tile_x0, s32 tile_y0, s32 tile_x1, s32 tile_y1) {
+  Renderer_Software* software = &GRenderer.software;
+  f32 dx = line->x[1] - line->x[0];
+  f32 dy = line->y[1] - line->y[0];
+  b32 x_major = fabsf(dx) >= fabsf(dy);
+  f32 major_delta = x_major ? dx : dy;
+  if (major_delta == 0.0f) {
+    return;
+  }
+  f32 major_start = x_major ? line->x[0] : line->y[0];
+  f32 minor_start = x_major ? line->y[0] : line->x[0];
+  f32 minor_delta = x_major ? dy : dx;
+  
+  f32 major_end = major_start + major_delta;
+  s32 first = (s32)ceilf(Min(major_start, major_end) - 0.5f);
+  s32 last  = (s32)floorf(Max(major_start, major_end) - 0.5f);
+  first = Max(first, x_major ? tile_x0 : tile_y0);
+  last  = Min(last,  x_major ? tile_x1 : tile_y1);
+  
+  for (s32 i = first; i <= last; i += 1) {
+    f32 t = ((f32)i + 0.5f - major_start) / major_delta;
+    s32 j = (s32)floorf(minor_start + minor_delta*t);
+    s32 x = x_major ? i : j;
+    s32 y = x_major ? j : i;
+    if (x < tile_x0 || x > tile_x1 || y < tile_y0 || y > tile_y1) {
+      continue;
+    }
+    
+    f32 fragment[SoftwarePlane_Count];
+    for (u32 k = 0; k < SoftwarePlane_Count; k += 1) {
+      fragment[k] = line->values[0][k] + (line->values[1][k] - line->values[0][k])*t;
+    }
+    f32* depth = software->depth + y*software->stride + x;
+    if (!(fragment[SoftwarePlane_Depth] < *depth)) {
+      continue;
+    }
+    *depth = fragment[SoftwarePlane_Depth];
+    
+    f32 w = 1.0f / fragment[SoftwarePlane_InverseW];
+    for (u32 k = SoftwarePlane_Red; k < SoftwarePlane_Count; k += 1) {
+      fragment[k] *= w;
+    }
+    software->color[y*software->stride + x] = _software_shade(line->texture, fragment);
+  }
+}
+
+internal void _software_rasterize_tiles(void* context, u64 first, u64 one_past_last) {
+  Software_Batch*    batch    = (Software_Batch*)context;
+  Renderer_Software* software = &GRenderer.software;
+  for (u64 tile = first; tile < one_past_last; tile += 1) {
+    s32 x0 = (s32)(tile % software->tiles_x)*Software_Tile_Size;
+    s32 y0 = (s32)(tile / software->tiles_x)*Software_Tile_Size;
+    s32 x1 = Min(x0 + Software_Tile_Size, software->width)  - 1;
+    s32 y1 = Min(y0 + Software_Tile_Size, software->height) - 1;
+    for (u32 i = batch->bin_offsets[tile]; i < batch->bin_offsets[tile + 1]; i += 1) {
+      u32 entry = batch->bin_entries[i];
+      if (entry & Software_Line_Bit) {
+        _software_draw_line(&batch->lines[entry & ~Software_Line_Bit], x0, y0, x1, y1);
+      } else {
+        _software_draw_triangle(&batch->triangles[entry], x0, y0, x1, y1);
+      }
+    }
+  }
+}
+
+internal void _software_flush_batch(Software_Batch* batch, Arena* arena) {
+  if (batch->count == 0) {
+    return;
+  }
+  Renderer_Software* software = &GRenderer.software;
+  Arena_Temp temp = arena_temp_begin(arena);
+  
+  parallel_for(batch->count, 64, _software_setup_primitives, batch);
+  _software_bin_batch(batch, temp.arena);
+  parallel_for(software->tiles_x*software->tiles_y, 1, _software_rasterize_tiles, batch);
+  
+  arena_temp_end(&temp);
+  batch->count = 0;
+}
+
+internal void renderer_software_draw(Matrix4 view, Matrix4 projection, s32 window_height) {
+  Renderer_Software* software = &GRenderer.software;
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  _renderer_begin_draw_list();
+  _renderer_pack_instances(view, projection, window_height);
+  
+  Matrix4 view_projection = matrix4_mul(view, projection);
+  Renderer_Draw_Data*    draw_data = (Renderer_Draw_Data*)(GRenderer.draw_data.data + GRenderer.draw_data_offset);
+  Renderer_Draw_Command* commands  = (Renderer_Draw_Command*)(GRenderer.draw_commands.data + GRenderer.draw_commands_offset);
+  
+  // Every draw renderer_draw makes on the GPU, in the same order: triangles, draw list, lines, streamed lines
+  u32 draws_capacity = 3;
+  for (u32 i = 0; i < GRenderer.draw_commands_count; i += 1) {
+    draws_capacity += commands[i].instance_count;
+  }
+  Software_Draw* draws = ArenaPush(scratch.arena, Software_Draw, draws_capacity);
+  u32 draws_count = 0;
+  draws[draws_count++] = (Software_Draw){ GRenderer.vertices_data, GRenderer.triangles_indices_data, 0, GRenderer.triangles_indices_count, 0, false };
+  for (u32 i = 0; i < GRenderer.draw_commands_count; i += 1) {
+    Renderer_Draw_Command* command = &commands[i];
+    for (u32 k = 0; k < command->instance_count; k += 1) {
+      Software_Draw* draw = &draws[draws_count++];
+      *draw = (Software_Draw){ GRenderer.vertices_data, GRenderer.meshes_indices_data, command->first_index, command->count, command->base_vertex, false };
+      draw->model_view_projection = matrix4_mul(draw_data[command->base_instance + k].transform, view_projection);
+      draw->color                 = draw_data[command->base_instance + k].color;
+    }
+  }
+  draws[draws_count++] = (Software_Draw){ GRenderer.vertices_data, GRenderer.lines_indices_data, 0, GRenderer.lines_indices_count, 0, true };
+  draws[draws_count++] = (Software_Draw){ (Vertex_Packed*)GRenderer.stream_lines.data, NULL, GRenderer.stream_lines_first, GRenderer.stream_lines_count, 0, true };
+  
+  // The immediate triangles and both kinds of lines use draw data 0
+  u32 immediate[3] = { 0, draws_count - 2, draws_count - 1 };
+  for (u32 i = 0; i < ArrayCount(immediate); i += 1) {
+    draws[immediate[i]].model_view_projection = matrix4_mul(draw_data[0].transform, view_projection);
+    draws[immediate[i]].color                 = draw_data[0].color;
+  }
+  
+  parallel_for(software->height, 8, _software_clear_rows, software);
+  
+  // NOTE(fz): Every batch costs a setup and a rasterization parallel_for, so the whole frame goes in one when it fits.
+  u64 primitives_count = 0;
+  for (u32 d = 0; d < draws_count; d += 1) {
+    primitives_count += draws[d].count / (draws[d].lines ? 2 : 3);
+  }
+  u64 primitive_size = 2*sizeof(u32) + Software_Max_Clipped*sizeof(Software_Triangle) + sizeof(Software_Line) + 2*sizeof(u8);
+  
+  Software_Batch batch = { 0 };
+  batch.draws            = draws;
+  batch.capacity         = (u32)Max(1, Min(primitives_count, Software_Batch_Memory / primitive_size));
+  batch.primitive_draws  = ArenaPushNoZero(scratch.arena, u32, batch.capacity);
+  batch.primitive_firsts = ArenaPushNoZero(scratch.arena, u32, batch.capacity);
+  batch.triangles        = ArenaPushNoZero(scratch.arena, Software_Triangle, batch.capacity*Software_Max_Clipped);
+  batch.triangle_counts  = ArenaPushNoZero(scratch.arena, u8, batch.capacity);
+  batch.lines            = ArenaPushNoZero(scratch.arena, Software_Line, batch.capacity);
+  batch.line_counts      = ArenaPushNoZero(scratch.arena, u8, batch.capacity);
+  for (u32 d = 0; d < draws_count; d += 1) {
+    u32 corners = draws[d].lines ? 2 : 3;
+    for (u32 at = 0; at + corners <= draws[d].count; at += corners) {
+      batch.primitive_draws[batch.count]  = d;
+      batch.primitive_firsts[batch.count] = draws[d].first + at;
+      batch.count += 1;
+      if (batch.count == batch.capacity) {
+        _software_flush_batch(&batch, scratch.arena);
+      }
+    }
+  }
+  _software_flush_batch(&batch, scratch.arena);
+  
+  scratch_end(&scratch);
+}
+
+internal b32 renderer_software_write_ppm(String path) {
+  Renderer_Software* software = &GRenderer.software;
+  Arena_Temp scratch = scratch_begin(0, 0);
+  
+  u64 pixels_size = 3*(u64)software->width*software->height;
+  u8* data = ArenaPushNoZero(scratch.arena, u8, 32 + pixels_size);
+  u64 size = (u64)snprintf((char*)data, 32, "P6\n%d %d\n255\n", software->width, software->height);
+  for (s32 y = software->height - 1; y >= 0; y -= 1) {
+    u32* row = software->color + y*software->stride;
+    for (s32 x = 0; x < software->width; x += 1) {
+      data[size++] = (u8)(row[x]);
+      data[size++] = (u8)(row[x] >> 8);
+      data[size++] = (u8)(row[x] >> 16);
+    }
+  }
+  
+  b32 result = os_file_create(path) && os_file_write(path, data, size) == size;
+  scratch_end(&scratch);
+  return result;
+}
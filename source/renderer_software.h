@@ -0,0 +1,62 @@
+/* date = October 19th 2026 2:30 pm */
+
+#ifndef RENDERER_SOFTWARE_H
+#define RENDERER_SOFTWARE_H
+
+// NOTE(fz): CPU backend for machines without a GPU, selected with renderer_init_software. It draws the same vertices,
+// index buffers and draw list the GL path submits, in the same order and with the same state: GL_FRONT culled,
+// depth test LESS, colour = vertex colour * draw colour * the texture fs_main.glsl would sample.
+// Primitives are clipped and set up on every thread, binned into tiles in submission order, then every tile is
+// rasterized by a single thread with f32x8 edge functions, so no two threads ever write the same pixel.
+// Differences with the GPU: one sample per pixel instead of MSAA_SAMPLES, and textures are filtered bilinearly from
+// their top level only.
+
+#define Software_Tile_Size        64   // Pixels on a side, a multiple of 8
+#define Software_Batch_Memory     Megabytes(16) // Setup output of one batch, a frame with more primitives is drawn in several
+#define Software_Guard_Band       2.0f // Triangles are clipped to this many half viewports around the centre
+#define Software_Max_Clipped      6    // Triangles out of one, clipped against the near and guard band planes
+#define Software_Line_Bit         (1u << 31) // Set on tile bin entries that are lines
+
+// Values interpolated across primitives, all but the depth divided by w so they stay linear on screen
+typedef enum Software_Plane {
+  SoftwarePlane_Depth,
+  SoftwarePlane_InverseW,
+  SoftwarePlane_Red,
+  SoftwarePlane_Green,
+  SoftwarePlane_Blue,
+  SoftwarePlane_Alpha,
+  SoftwarePlane_U,
+  SoftwarePlane_V,
+
+  SoftwarePlane_Count
+} Software_Plane;
+
+typedef struct Software_Triangle {
+  Raster_Triangle raster;
+  f32 planes[SoftwarePlane_Count][3]; // a*x + b*y + c, at pixel centres
+  u32 texture;
+} Software_Triangle;
+
+typedef struct Software_Line {
+  f32 x[2]; // Window coordinates of the clipped end points
+  f32 y[2];
+  f32 values[2][SoftwarePlane_Count];
+  u32 texture;
+} Software_Line;
+
+typedef struct Renderer_Software {
+  Arena* arena; // Targets, remade by renderer_software_resize
+  s32 width;
+  s32 height;
+  s32 stride;   // Pixels per row, width rounded up to 8
+  s32 tiles_x;
+  s32 tiles_y;
+  u32* color; // RGBA8, rows bottom up like glReadPixels
+  f32* depth; // Window space, [0, 1]
+} Renderer_Software;
+
+internal void renderer_software_resize(s32 width, s32 height);
+internal void renderer_software_draw(Matrix4 view, Matrix4 projection, s32 window_height); /* Called by renderer_draw */
+internal b32  renderer_software_write_ppm(String path); /* Binary PPM of the last frame, top row first */
+
+#endif // RENDERER_SOFTWARE_H
@@ -7,12 +7,30 @@ in vec2 vertex_uv;
 in vec3 vertex_normal;
 flat in float vertex_texture;
 
-uniform sampler2D u_texture[8];
+// NOTE(fz): Keep in sync with renderer.h
+#define PALETTE_SIZE        256
+#define TEXTURE_PAGE_LAYERS 64
 
-void main() {
-  // NOTE(fz): Some hardware does not handle runtime variable indexing (u_texture[vertex_texture]) properly.
-  // My laptop was auto selecting the GPU and was picking the integrated graphics for my AMD processor and
-  // it was overlapping textures with this solution, but a switch statement worked fine. By making it use the nvidia GPU by default, the issue is fixed.
+uniform sampler2D      u_palette;
+uniform sampler2DArray u_texture_pages[4];
+
+vec4 sample_texture(int index, vec2 uv) {
+  if (index < PALETTE_SIZE) {
+    return texelFetch(u_palette, ivec2(index, 0), 0);
+  }
+  index -= PALETTE_SIZE;
+  vec3 coords = vec3(uv, float(index % TEXTURE_PAGE_LAYERS));
   
-  pixel_color = vertex_color * texture(u_texture[int(vertex_texture)], vertex_uv.xy);
-}
\ No newline at end of file
+  // NOTE(fz): Some hardware does not handle runtime variable indexing of sampler arrays properly
+  // (my laptop's integrated AMD GPU overlapped textures), a switch on the page works everywhere.
+  switch (index / TEXTURE_PAGE_LAYERS) {
+    case 0:  return texture(u_texture_pages[0], coords);
+    case 1:  return texture(u_texture_pages[1], coords);
+    case 2:  return texture(u_texture_pages[2], coords);
+    default: return texture(u_texture_pages[3], coords);
+  }
+}
+
+void main() {
+  pixel_color = vertex_color * sample_texture(int(vertex_texture), vertex_uv.xy);
+}
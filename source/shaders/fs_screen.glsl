@@ -3,11 +3,17 @@
 out vec4 FragColor;
 
 uniform sampler2D u_screen_texture;
-uniform int u_window_width;
-uniform int u_window_height;
+
+layout (std140, row_major, binding = 0) uniform Frame_Uniforms {
+  mat4  u_view;
+  mat4  u_projection;
+  mat4  u_view_projection;
+  vec4  u_viewport; // x, y, width, height
+  float u_time;
+};
 
 void main() {
-  vec2 tex_coords = gl_FragCoord.xy / vec2(u_window_width, u_window_height);
+  vec2 tex_coords = gl_FragCoord.xy / u_viewport.zw;
   FragColor = texture(u_screen_texture, tex_coords);
 }
 
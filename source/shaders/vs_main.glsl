@@ -3,7 +3,7 @@
 layout (location = 0) in vec3 pos; 
 layout (location = 1) in vec4 color;
 layout (location = 2) in vec2 uv;
-layout (location = 3) in vec3 normal;
+layout (location = 3) in vec2 normal; // Octahedral
 layout (location = 4) in float texture;
 
 out vec4 vertex_color;
@@ -11,15 +11,38 @@ out vec2 vertex_uv;
 out vec3 vertex_normal;
 flat out float vertex_texture;
 
-uniform mat4 u_model;
-uniform mat4 u_view;
-uniform mat4 u_projection;
+layout (std140, row_major, binding = 0) uniform Frame_Uniforms {
+  mat4  u_view;
+  mat4  u_projection;
+  mat4  u_view_projection;
+  vec4  u_viewport; // x, y, width, height
+  float u_time;
+};
+
+struct Draw {
+  mat4 transform;
+  vec4 color;
+};
+
+// NOTE(fz): Indexed with gl_BaseInstance + gl_InstanceID, which is 0 (identity) for the immediate draws.
+layout (std430, row_major, binding = 1) readonly buffer Draw_Data {
+  Draw u_draws[];
+};
+
+vec3 octahedral_decode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if (n.z < 0.0) {
+    n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return normalize(n);
+}
 
 void main() {
-  gl_Position = u_projection * u_view * u_model * vec4(pos, 1.0); 
+  Draw draw = u_draws[gl_BaseInstance + gl_InstanceID];
+  gl_Position = u_view_projection * draw.transform * vec4(pos, 1.0); 
   
-  vertex_color   = color;
+  vertex_color   = color * draw.color;
   vertex_uv      = uv;
-  vertex_normal  = normal;
+  vertex_normal  = octahedral_decode(normal);
   vertex_texture = texture;
 }
\ No newline at end of file